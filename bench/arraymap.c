@@ -0,0 +1,211 @@
+#define _POSIX_C_SOURCE 200809L /* for clock_gettime() */
+
+#include "array.h"
+#include "arraymap.h"
+#include "sortedarray.h"
+
+#include <stdio.h> /* for printf() */
+#include <stdlib.h> /* for malloc(), free(), EXIT_SUCCESS */
+#include <time.h> /* for clock_gettime(), struct timespec */
+
+
+
+static const size_t SIZES[] = {1000, 100000, 1000000};
+
+/* The number of lookups timed for each size */
+static const size_t QUERIES = 1000000;
+
+/* The number of keys looked up by each call to am_get_many */
+#define BATCH 256
+
+/* The largest size the insertions and removals in random order are timed for,
+   as they take quadratic time */
+static const size_t MAX_INSERTS = 100000;
+
+/* Keeps the results of the pure functions from being optimized away */
+static volatile size_t sink;
+
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_ints(const key_t *const k1, const key_t *const k2) {
+	const int i1 = *(const int*)k1, i2 = *(const int*)k2;
+	return (i1 > i2) - (i1 < i2);
+}
+
+/* Random keys in 0..m-1 */
+static key_t **queries(const int *const keys, const size_t count,
+                       const size_t m) {
+	key_t **const batch = malloc(count * sizeof(key_t*));
+	unsigned long seed = 42;
+	for(size_t i = 0; i < count; ++i) {
+		seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+		batch[i] = (key_t*)&keys[(seed >> 33) % m];
+	}
+	return batch;
+}
+
+static void report(const char *const map, const char *const op,
+                   const size_t n, const size_t count, const double elapsed) {
+	printf("%-8s %-8s n = %7zu: %8.1f ns/key\n", map, op, n,
+	       elapsed / count * 1e9);
+}
+
+
+/* The layout ArrayMap used to have, as a baseline: the keys in a SortedArray
+   and the values in a parallel Array */
+struct parallel {
+	SortedArray *keys;
+	Array *values;
+};
+
+static void p_put(struct parallel *const p, key_t *const key,
+                  value_t *const value) {
+	const ssize_t index = sa_add(p->keys, key);
+	if(index >= 0) {
+		a_add(p->values, (size_t)index, value);
+	}
+}
+
+static value_t *p_get(const struct parallel *const p, const key_t *const key) {
+	const ssize_t index = sa_indexof(p->keys, key);
+	return index < 0 ? NULL : a_get(p->values, index);
+}
+
+static value_t *p_remove(struct parallel *const p, const key_t *const key) {
+	const ssize_t index = sa_indexof(p->keys, key);
+	if(index < 0) {
+		return NULL;
+	}
+	sa_drop(p->keys, index);
+	return a_drop(p->values, index);
+}
+
+
+/* Adds the even keys in random order, then removes them in another order */
+static void bench_updates(int *const keys, const size_t n) {
+	key_t **const order = queries(keys, n, 2 * n);
+	ArrayMap *const am = am_new(1, cmp_ints);
+	struct parallel p = {sa_new(1, cmp_ints), a_new(1)};
+	for(size_t i = 0; i < n; ++i) {
+		order[i] = &keys[*(int*)order[i] & ~1];
+	}
+	double start = now();
+	for(size_t i = 0; i < n; ++i) {
+		am_put(am, order[i], order[i]);
+	}
+	report("ArrayMap", "put", n, n, now() - start);
+	start = now();
+	for(size_t i = 0; i < n; ++i) {
+		p_put(&p, order[i], order[i]);
+	}
+	report("Parallel", "put", n, n, now() - start);
+	start = now();
+	ArrayMap *const bulk = am_from_pairs(order, order, n, cmp_ints,
+	                                     AM_KEEP_LAST, NULL, NULL);
+	report("ArrayMap", "put_many", n, n, now() - start);
+	am_free(bulk);
+	start = now();
+	for(size_t i = n; i-- > 0;) {
+		sink += (size_t)am_remove(am, order[i]);
+	}
+	report("ArrayMap", "remove", n, n, now() - start);
+	start = now();
+	for(size_t i = n; i-- > 0;) {
+		sink += (size_t)p_remove(&p, order[i]);
+	}
+	report("Parallel", "remove", n, n, now() - start);
+	a_free(p.values);
+	sa_free(p.keys);
+	am_free(am);
+	free(order);
+}
+
+static void bench_get(const ArrayMap *const am, const struct parallel *const p,
+                      key_t *const batch[], const size_t n) {
+	double start = now();
+	for(size_t i = 0; i < QUERIES; ++i) {
+		sink += (size_t)am_get(am, batch[i]);
+	}
+	report("ArrayMap", "get", n, QUERIES, now() - start);
+	start = now();
+	for(size_t i = 0; i < QUERIES; ++i) {
+		sink += (size_t)p_get(p, batch[i]);
+	}
+	report("Parallel", "get", n, QUERIES, now() - start);
+}
+
+static void bench_get_many(const ArrayMap *const am, key_t *const batch[],
+                           const size_t n) {
+	value_t *values[BATCH];
+	const double start = now();
+	for(size_t i = 0; i < QUERIES; i += BATCH) {
+		const size_t count = QUERIES - i < BATCH ? QUERIES - i : BATCH;
+		sink += am_get_many(am, batch + i, count, values);
+	}
+	report("ArrayMap", "get_many", n, QUERIES, now() - start);
+}
+
+static void sum_values(key_t *const key, value_t *const value,
+                       void *const ctx) {
+	(void)key;
+	*(size_t*)ctx += (size_t)value;
+}
+
+/* Visits every pair in order: with am_foreach, with a cursor, and looking up
+   each key as was needed before the map could be iterated */
+static void bench_scan(const ArrayMap *const am, int *const keys,
+                       const size_t n) {
+	size_t sum = 0;
+	double start = now();
+	am_foreach(am, sum_values, &sum);
+	report("ArrayMap", "foreach", n, n, now() - start);
+	start = now();
+	for(AMCursor c = am_seek_first(am); am_cursor_valid(&c);
+	    am_cursor_next(&c)) {
+		sum += (size_t)am_cursor_value(&c);
+	}
+	report("ArrayMap", "cursor", n, n, now() - start);
+	start = now();
+	for(size_t i = 0; i < n; ++i) {
+		sum += (size_t)am_get(am, &keys[2 * i]);
+	}
+	report("ArrayMap", "get all", n, n, now() - start);
+	sink = sum;
+}
+
+
+int main(void) {
+	for(size_t i = 0; i < sizeof(SIZES) / sizeof(*SIZES); ++i) {
+		const size_t n = SIZES[i];
+		int *const keys = malloc(2 * n * sizeof(int));
+		ArrayMap *const am = am_new(n, cmp_ints);
+		struct parallel p = {sa_new(n, cmp_ints), a_new(n)};
+		for(size_t j = 0; j < 2 * n; ++j) {
+			keys[j] = (int)j;
+		}
+		if(n <= MAX_INSERTS) {
+			bench_updates(keys, n);
+		}
+		/* the even keys, put in order so that the maps are built fast */
+		for(size_t j = 0; j < n; ++j) {
+			am_put(am, &keys[2 * j], &keys[j]);
+			p_put(&p, &keys[2 * j], &keys[j]);
+		}
+		/* random keys in 0..2n-1, half of which are in the maps */
+		key_t **const batch = queries(keys, QUERIES, 2 * n);
+		bench_get(am, &p, batch, n);
+		bench_get_many(am, batch, n);
+		bench_scan(am, keys, n);
+		free(batch);
+		a_free(p.values);
+		sa_free(p.keys);
+		am_free(am);
+		free(keys);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+#define _POSIX_C_SOURCE 200809L /* for clock_gettime() */
+
+#include "arraymap.h"
+#include "cache.h"
+#include "linkedlist.h"
+#include "linkedlist_funcs.h"
+
+#include <stdio.h> /* for printf() */
+#include <stdlib.h> /* for malloc(), free(), EXIT_SUCCESS */
+#include <time.h> /* for clock_gettime(), struct timespec */
+
+
+
+static const size_t CAPACITIES[] = {1000, 10000, 100000};
+
+/* The number of accesses timed for each capacity */
+static const size_t ACCESSES = 1000000;
+
+/* The largest capacity the cache built from an ArrayMap and a LinkedList is
+   timed for, and the number of accesses timed: each of its hits scans the
+   list, in O(n^2) time as the list is walked by index */
+static const size_t MAX_BY_HAND = 1000;
+static const size_t BY_HAND_ACCESSES = 2000;
+
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_ints(const data_t *const k1, const data_t *const k2) {
+	const int i1 = *(const int*)k1, i2 = *(const int*)k2;
+	return (i1 > i2) - (i1 < i2);
+}
+
+static size_t hash_ints(const data_t *const k) {
+	return (size_t)*(const int*)k;
+}
+
+static bool equal_ints(const data_t *const k1, const data_t *const k2) {
+	return *(const int*)k1 == *(const int*)k2;
+}
+
+/* Keys among 4 times the capacity, 80 % of them among the first fifth: the
+   hot keys fit in the cache, the others do not */
+static size_t *accesses(const size_t capacity) {
+	size_t *const batch = malloc(ACCESSES * sizeof(size_t));
+	unsigned long seed = 42;
+	for(size_t i = 0; i < ACCESSES; ++i) {
+		seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+		const size_t r = seed >> 33;
+		batch[i] = r % 5 ? r / 5 % (capacity * 4 / 5) : r / 5 % (4 * capacity);
+	}
+	return batch;
+}
+
+static void report(const char *const cache, const size_t capacity,
+                   const size_t count, const size_t hits,
+                   const double elapsed) {
+	printf("%-8s n = %6zu: %10.1f ns/access, hit ratio %4.1f %%\n", cache,
+	       capacity, elapsed / count * 1e9, 100.0 * hits / count);
+}
+
+
+/* Reads each key through the cache, putting it on a miss */
+static void bench_cache(int *const keys, const size_t *const batch,
+                        const size_t capacity, const CachePolicy policy) {
+	Cache *const cache = ca_new(capacity, policy, hash_ints, equal_ints);
+	const double start = now();
+	for(size_t i = 0; i < ACCESSES; ++i) {
+		int *const key = &keys[batch[i]];
+		if(!ca_get(cache, key)) {
+			ca_put(cache, key, key);
+		}
+	}
+	const double elapsed = now() - start;
+	report(policy == CA_LRU ? "LRU" : "CLOCK", capacity, ACCESSES,
+	       ca_stats(cache).hits, elapsed);
+	ca_free(cache);
+}
+
+/* The same with the cache built by hand, on the first accesses only: an
+   ArrayMap, and a LinkedList of the keys from the most recently used */
+static void bench_by_hand(int *const keys, const size_t *const batch,
+                          const size_t capacity) {
+	ArrayMap *const map = am_new(capacity, cmp_ints);
+	LinkedList *const recency = ll_new();
+	size_t hits = 0;
+	const double start = now();
+	for(size_t i = 0; i < BY_HAND_ACCESSES; ++i) {
+		int *const key = &keys[batch[i]];
+		if(am_get(map, key)) {
+			++hits;
+			ll_remove(recency, key, NULL);
+		} else {
+			if(ll_len(recency) == capacity) {
+				am_remove(map, ll_drop(recency, capacity - 1));
+			}
+			am_put(map, key, key);
+		}
+		ll_add(recency, 0, key);
+	}
+	const double elapsed = now() - start;
+	report("by hand", capacity, BY_HAND_ACCESSES, hits, elapsed);
+	ll_free(recency);
+	am_free(map);
+}
+
+
+int main(void) {
+	for(size_t i = 0; i < sizeof(CAPACITIES) / sizeof(*CAPACITIES); ++i) {
+		const size_t capacity = CAPACITIES[i];
+		int *const keys = malloc(4 * capacity * sizeof(int));
+		for(size_t j = 0; j < 4 * capacity; ++j) {
+			keys[j] = (int)j;
+		}
+		size_t *const batch = accesses(capacity);
+		if(capacity <= MAX_BY_HAND) {
+			bench_by_hand(keys, batch, capacity);
+		}
+		bench_cache(keys, batch, capacity, CA_LRU);
+		bench_cache(keys, batch, capacity, CA_CLOCK);
+		free(batch);
+		free(keys);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+#define _POSIX_C_SOURCE 200809L /* for clock_gettime(), sysconf() */
+
+#include "arraymap.h"
+#include "concurrentmap.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h> /* for printf() */
+#include <stdlib.h> /* for malloc(), free(), EXIT_SUCCESS */
+#include <time.h> /* for clock_gettime(), nanosleep(), struct timespec */
+#include <unistd.h> /* for sysconf() */
+
+
+
+/* The number of keys in the map */
+static const size_t KEYS = 10000;
+
+/* The number of lookups of each reader thread */
+static const size_t QUERIES = 2000000;
+
+/* The pause of the writer thread between two puts, in nanoseconds */
+static const long WRITE_PERIOD = 1000000;
+
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_ints(const key_t *const k1, const key_t *const k2) {
+	const int i1 = *(const int*)k1, i2 = *(const int*)k2;
+	return (i1 > i2) - (i1 < i2);
+}
+
+
+/* The map shared by the threads: either a ConcurrentMap, or an ArrayMap
+   guarded by a mutex, as a baseline */
+struct shared {
+	ConcurrentMap *cm;
+	ArrayMap *am;
+	pthread_mutex_t lock;
+	int *keys;
+	atomic_size_t readers; /* the number of readers still running */
+};
+
+static void *read_keys(void *const arg) {
+	struct shared *const s = arg;
+	CMReader *const reader = s->cm ? cm_reader_new(s->cm) : NULL;
+	unsigned long seed = (unsigned long)pthread_self();
+	size_t found = 0;
+	for(size_t i = 0; i < QUERIES; ++i) {
+		seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+		const int *const key = &s->keys[(seed >> 33) % (2 * KEYS)];
+		if(reader) {
+			found += cm_get(reader, key) != NULL;
+		} else {
+			pthread_mutex_lock(&s->lock);
+			found += am_get(s->am, key) != NULL;
+			pthread_mutex_unlock(&s->lock);
+		}
+	}
+	if(reader) {
+		cm_reader_free(reader);
+	}
+	atomic_fetch_sub(&s->readers, 1);
+	return (void*)found;
+}
+
+/* Overrides the value of a key now and then, until the readers are done */
+static void *write_keys(void *const arg) {
+	struct shared *const s = arg;
+	const struct timespec pause = {0, WRITE_PERIOD};
+	for(size_t i = 0; atomic_load(&s->readers); ++i) {
+		int *const key = &s->keys[2 * (i % KEYS)];
+		if(s->cm) {
+			cm_put(s->cm, key, key);
+		} else {
+			pthread_mutex_lock(&s->lock);
+			am_put(s->am, key, key);
+			pthread_mutex_unlock(&s->lock);
+		}
+		nanosleep(&pause, NULL);
+	}
+	return NULL;
+}
+
+static void bench_readers(struct shared *const s, const size_t readers) {
+	pthread_t *const threads = malloc(readers * sizeof(pthread_t));
+	pthread_t writer;
+	atomic_store(&s->readers, readers);
+	pthread_create(&writer, NULL, write_keys, s);
+	const double start = now();
+	for(size_t i = 0; i < readers; ++i) {
+		pthread_create(&threads[i], NULL, read_keys, s);
+	}
+	for(size_t i = 0; i < readers; ++i) {
+		pthread_join(threads[i], NULL);
+	}
+	const double elapsed = now() - start;
+	pthread_join(writer, NULL);
+	printf("%-13s readers %3zu: %8.1f Mkeys/s\n",
+	       s->cm ? "ConcurrentMap" : "Mutex", readers,
+	       readers * QUERIES / elapsed * 1e-6);
+	free(threads);
+}
+
+
+int main(void) {
+	const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	struct shared s = {
+		cm_new(KEYS, cmp_ints), am_new(KEYS, cmp_ints),
+		PTHREAD_MUTEX_INITIALIZER, malloc(2 * KEYS * sizeof(int)), 0
+	};
+	for(size_t i = 0; i < 2 * KEYS; ++i) {
+		s.keys[i] = (int)i;
+	}
+	/* the even keys, so that half of the lookups find their key */
+	ArrayMap *const draft = cm_begin(s.cm);
+	for(size_t i = 0; i < KEYS; ++i) {
+		am_put(draft, &s.keys[2 * i], &s.keys[i]);
+		am_put(s.am, &s.keys[2 * i], &s.keys[i]);
+	}
+	cm_commit(s.cm, draft);
+	/* the powers of 2 up to the number of cores, then the number itself */
+	for(size_t readers = 1;; readers *= 2) {
+		const size_t n = readers < (size_t)cores ? readers : (size_t)cores;
+		ConcurrentMap *const cm = s.cm;
+		s.cm = NULL;
+		bench_readers(&s, n);
+		s.cm = cm;
+		bench_readers(&s, n);
+		if(n == (size_t)cores) {
+			break;
+		}
+	}
+	cm_free(s.cm);
+	am_free(s.am);
+	free(s.keys);
+	return EXIT_SUCCESS;
+}
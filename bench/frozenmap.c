@@ -0,0 +1,106 @@
+#define _POSIX_C_SOURCE 200809L /* for clock_gettime() */
+
+#include "arraymap.h"
+#include "frozenmap.h"
+#include "hashmap.h"
+
+#include <stdio.h> /* for printf() */
+#include <stdlib.h> /* for malloc(), free(), EXIT_SUCCESS */
+#include <time.h> /* for clock_gettime(), struct timespec */
+
+
+
+static const size_t SIZES[] = {1000, 100000, 1000000};
+
+/* The number of lookups timed for each size */
+static const size_t QUERIES = 1000000;
+
+/* Keeps the results of the pure functions from being optimized away */
+static volatile size_t sink;
+
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_ints(const data_t *const k1, const data_t *const k2) {
+	const int i1 = *(const int*)k1, i2 = *(const int*)k2;
+	return (i1 > i2) - (i1 < i2);
+}
+
+static size_t hash_ints(const data_t *const k) {
+	return (size_t)*(const int*)k;
+}
+
+static bool equal_ints(const data_t *const k1, const data_t *const k2) {
+	return *(const int*)k1 == *(const int*)k2;
+}
+
+/* Random keys among the n keys of the map, and as many not in it */
+static int *queries(const size_t n) {
+	int *const batch = malloc(QUERIES * sizeof(int));
+	unsigned long seed = 42;
+	for(size_t i = 0; i < QUERIES; ++i) {
+		seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+		batch[i] = (int)((seed >> 33) % (2 * n));
+	}
+	return batch;
+}
+
+static void report(const char *const map, const char *const op,
+                   const size_t n, const size_t count, const double elapsed) {
+	printf("%-9s %-6s n = %7zu: %8.1f ns/key\n", map, op, n,
+	       elapsed / count * 1e9);
+}
+
+
+int main(void) {
+	for(size_t i = 0; i < sizeof(SIZES) / sizeof(*SIZES); ++i) {
+		const size_t n = SIZES[i];
+		int *const keys = malloc(n * sizeof(int));
+		for(size_t j = 0; j < n; ++j) {
+			keys[j] = (int)j;
+		}
+		int *const batch = queries(n);
+		ArrayMap *const sorted = am_new(n, cmp_ints);
+		HashMap *const hashed = hm_new(n, hash_ints, equal_ints);
+		for(size_t j = 0; j < n; ++j) {
+			am_put(sorted, &keys[j], &keys[j]);
+			hm_put(hashed, &keys[j], &keys[j]);
+		}
+
+		double start = now();
+		FrozenMap *const frozen = am_freeze(sorted, hash_ints);
+		report("FrozenMap", "build", n, n, now() - start);
+		const size_t bytes = fm_save(frozen, NULL, 0);
+		printf("FrozenMap saved in %zu bytes, %.2f bytes/key\n", bytes,
+		       (double)bytes / n);
+
+		size_t found = 0;
+		start = now();
+		for(size_t j = 0; j < QUERIES; ++j) {
+			found += am_get(sorted, &batch[j]) != NULL;
+		}
+		report("ArrayMap", "get", n, QUERIES, now() - start);
+		start = now();
+		for(size_t j = 0; j < QUERIES; ++j) {
+			found += hm_get(hashed, &batch[j]) != NULL;
+		}
+		report("HashMap", "get", n, QUERIES, now() - start);
+		start = now();
+		for(size_t j = 0; j < QUERIES; ++j) {
+			found += fm_get(frozen, &batch[j]) != NULL;
+		}
+		report("FrozenMap", "get", n, QUERIES, now() - start);
+		sink = found;
+
+		fm_free(frozen);
+		hm_free(hashed);
+		am_free(sorted);
+		free(batch);
+		free(keys);
+	}
+	return EXIT_SUCCESS;
+}
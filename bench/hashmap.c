@@ -0,0 +1,156 @@
+#define _POSIX_C_SOURCE 200809L /* for clock_gettime() */
+
+#include "arraymap.h"
+#include "hashmap.h"
+
+#include <stdio.h> /* for printf() */
+#include <stdlib.h> /* for malloc(), free(), EXIT_SUCCESS */
+#include <time.h> /* for clock_gettime(), struct timespec */
+
+
+
+static const size_t SIZES[] = {1000, 100000, 1000000};
+
+/* The number of lookups timed for each size */
+static const size_t QUERIES = 1000000;
+
+/* The largest size the insertions in random order are timed for with an
+   ArrayMap, which takes quadratic time */
+static const size_t MAX_INSERTS = 100000;
+
+/* The number of keys of the table the load factors are measured on, its
+   maximal load (7/8 of a power of 2) */
+static const size_t LOAD_KEYS = 917504;
+
+/* The load factors measured, in eighths */
+static const size_t LOADS[] = {2, 4, 6, 7};
+
+/* Keeps the results of the pure functions from being optimized away */
+static volatile size_t sink;
+
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_ints(const data_t *const k1, const data_t *const k2) {
+	const int i1 = *(const int*)k1, i2 = *(const int*)k2;
+	return (i1 > i2) - (i1 < i2);
+}
+
+static size_t hash_ints(const data_t *const k) {
+	return (size_t)*(const int*)k;
+}
+
+static bool equal_ints(const data_t *const k1, const data_t *const k2) {
+	return *(const int*)k1 == *(const int*)k2;
+}
+
+/* Random indices in 0..m-1 */
+static size_t *queries(const size_t count, const size_t m) {
+	size_t *const batch = malloc(count * sizeof(size_t));
+	unsigned long seed = 42;
+	for(size_t i = 0; i < count; ++i) {
+		seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+		batch[i] = (seed >> 33) % m;
+	}
+	return batch;
+}
+
+static void report(const char *const map, const char *const op,
+                   const size_t n, const size_t count, const double elapsed) {
+	printf("%-8s %-9s n = %7zu: %8.1f ns/key\n", map, op, n,
+	       elapsed / count * 1e9);
+}
+
+
+/* Adds the keys in random order */
+static void bench_puts(int *const keys, const size_t n) {
+	size_t *const order = queries(n, n);
+	if(n <= MAX_INSERTS) {
+		ArrayMap *const am = am_new(n, cmp_ints);
+		const double start = now();
+		for(size_t i = 0; i < n; ++i) {
+			am_put(am, &keys[2 * order[i]], &keys[i]);
+		}
+		report("ArrayMap", "put", n, n, now() - start);
+		am_free(am);
+	}
+	HashMap *const hm = hm_new(1, hash_ints, equal_ints);
+	const double start = now();
+	for(size_t i = 0; i < n; ++i) {
+		hm_put(hm, &keys[2 * order[i]], &keys[i]);
+	}
+	report("HashMap", "put", n, n, now() - start);
+	hm_free(hm);
+	free(order);
+}
+
+/* Looks up random keys in 0..2n-1, half of which are in the maps */
+static void bench_gets(int *const keys, const size_t n) {
+	size_t *const batch = queries(QUERIES, 2 * n);
+	ArrayMap *const am = am_new(n, cmp_ints);
+	HashMap *const hm = hm_new(n, hash_ints, equal_ints);
+	/* the even keys, put in order so that the array map is built fast */
+	for(size_t i = 0; i < n; ++i) {
+		am_put(am, &keys[2 * i], &keys[i]);
+		hm_put(hm, &keys[2 * i], &keys[i]);
+	}
+	double start = now();
+	for(size_t i = 0; i < QUERIES; ++i) {
+		sink += (size_t)am_get(am, &keys[batch[i]]);
+	}
+	report("ArrayMap", "get", n, QUERIES, now() - start);
+	start = now();
+	for(size_t i = 0; i < QUERIES; ++i) {
+		sink += (size_t)hm_get(hm, &keys[batch[i]]);
+	}
+	report("HashMap", "get", n, QUERIES, now() - start);
+	hm_free(hm);
+	am_free(am);
+	free(batch);
+}
+
+/* Looks up present then missing keys in a table of fixed capacity, filled to
+   several load factors */
+static void bench_loads(int *const keys) {
+	size_t *const batch = queries(QUERIES, LOAD_KEYS);
+	for(size_t l = 0; l < sizeof(LOADS) / sizeof(*LOADS); ++l) {
+		const size_t n = LOAD_KEYS * LOADS[l] / 7;
+		HashMap *const hm = hm_new(LOAD_KEYS, hash_ints, equal_ints);
+		for(size_t i = 0; i < n; ++i) {
+			hm_put(hm, &keys[2 * i], &keys[i]);
+		}
+		char op[16];
+		for(int missing = 0; missing < 2; ++missing) {
+			const double start = now();
+			for(size_t i = 0; i < QUERIES; ++i) {
+				sink += (size_t)hm_get(hm, &keys[2 * (batch[i] % n) + missing]);
+			}
+			snprintf(op, sizeof(op), "%s@%zu/8", missing ? "miss" : "hit",
+			         LOADS[l]);
+			report("HashMap", op, n, QUERIES, now() - start);
+		}
+		hm_free(hm);
+	}
+	free(batch);
+}
+
+
+int main(void) {
+	const size_t m = 2 * LOAD_KEYS > 2 * SIZES[2] ? 2 * LOAD_KEYS
+	                                              : 2 * SIZES[2];
+	int *const keys = malloc(m * sizeof(int));
+	for(size_t j = 0; j < m; ++j) {
+		keys[j] = (int)j;
+	}
+	for(size_t i = 0; i < sizeof(SIZES) / sizeof(*SIZES); ++i) {
+		bench_puts(keys, SIZES[i]);
+		bench_gets(keys, SIZES[i]);
+	}
+	bench_loads(keys);
+	free(keys);
+	return EXIT_SUCCESS;
+}
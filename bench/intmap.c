@@ -0,0 +1,124 @@
+#define _POSIX_C_SOURCE 200809L /* for clock_gettime() */
+
+#include "arraymap.h"
+#include "intmap.h"
+
+#include <stdint.h> /* for int64_t */
+#include <stdio.h> /* for printf() */
+#include <stdlib.h> /* for malloc(), free(), EXIT_SUCCESS */
+#include <time.h> /* for clock_gettime(), struct timespec */
+
+
+
+static const size_t SIZES[] = {1000, 100000, 1000000, 4000000};
+
+/* The number of lookups timed for each size */
+static const size_t QUERIES = 2000000;
+
+/* The number of keys given to each call to im_put_sorted */
+#define BATCH 1024
+
+/* Keeps the results of the pure functions from being optimized away */
+static volatile size_t sink;
+
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_int64s(const key_t *const k1, const key_t *const k2) {
+	const int64_t i1 = *(const int64_t*)k1, i2 = *(const int64_t*)k2;
+	return (i1 > i2) - (i1 < i2);
+}
+
+/* Random keys in 0..2n-1, half of which are in the maps */
+static size_t *queries(const size_t n) {
+	size_t *const batch = malloc(QUERIES * sizeof(size_t));
+	unsigned long seed = 42;
+	for(size_t i = 0; i < QUERIES; ++i) {
+		seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+		batch[i] = (seed >> 33) % (2 * n);
+	}
+	return batch;
+}
+
+static void report(const char *const map, const char *const op,
+                   const size_t n, const size_t count, const double elapsed) {
+	printf("%-8s %-13s n = %7zu: %8.1f ns/key\n", map, op, n,
+	       elapsed / count * 1e9);
+}
+
+
+static void bench_am_get(const ArrayMap *const am, const int64_t *const keys,
+                         const size_t *const batch, const size_t n) {
+	const double start = now();
+	for(size_t i = 0; i < QUERIES; ++i) {
+		sink += (size_t)am_get(am, &keys[batch[i]]);
+	}
+	report("ArrayMap", "get", n, QUERIES, now() - start);
+}
+
+static void bench_im_get(IntMap *const im, const int64_t *const keys,
+                         const size_t *const batch, const size_t n,
+                         const bool interpolate) {
+	im_set_interpolation(im, interpolate);
+	const double start = now();
+	for(size_t i = 0; i < QUERIES; ++i) {
+		sink += (size_t)im_get(im, keys[batch[i]]);
+	}
+	report("IntMap", interpolate ? "get (interp.)" : "get", n, QUERIES,
+	       now() - start);
+	im_set_interpolation(im, false);
+}
+
+/* Puts the odd keys in a map holding the even ones, by sorted batches */
+static void bench_im_put_sorted(const IntMap *const im,
+                                const int64_t *const keys, const size_t n) {
+	IntMap *const copy = im_new(2 * n);
+	int64_t odd[BATCH];
+	data_t *values[BATCH];
+	for(size_t i = 0; i < n; ++i) {
+		im_put(copy, im_key(im, i), im_value(im, i));
+	}
+	const double start = now();
+	for(size_t i = 0; i < n; i += BATCH) {
+		const size_t count = n - i < BATCH ? n - i : BATCH;
+		for(size_t j = 0; j < count; ++j) {
+			odd[j] = keys[2 * (i + j) + 1];
+			values[j] = NULL;
+		}
+		im_put_sorted(copy, odd, values, count);
+	}
+	report("IntMap", "put_sorted", n, n, now() - start);
+	im_free(copy);
+}
+
+
+int main(void) {
+	for(size_t i = 0; i < sizeof(SIZES) / sizeof(*SIZES); ++i) {
+		const size_t n = SIZES[i];
+		int64_t *const keys = malloc(2 * n * sizeof(int64_t));
+		ArrayMap *const am = am_new(n, cmp_int64s);
+		IntMap *const im = im_new(n);
+		for(size_t j = 0; j < 2 * n; ++j) {
+			keys[j] = (int64_t)j;
+		}
+		/* the even keys, put in order so that the maps are built fast */
+		for(size_t j = 0; j < n; ++j) {
+			am_put(am, &keys[2 * j], &keys[j]);
+			im_put(im, keys[2 * j], &keys[j]);
+		}
+		size_t *const batch = queries(n);
+		bench_am_get(am, keys, batch, n);
+		bench_im_get(im, keys, batch, n, false);
+		bench_im_get(im, keys, batch, n, true);
+		bench_im_put_sorted(im, keys, n);
+		free(batch);
+		im_free(im);
+		am_free(am);
+		free(keys);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+#define _POSIX_C_SOURCE 200809L /* for clock_gettime() */
+
+#include "array.h"
+#include "persistentvector.h"
+
+#include <stdio.h> /* for printf() */
+#include <stdlib.h> /* for EXIT_SUCCESS */
+#include <time.h> /* for clock_gettime(), struct timespec */
+
+
+
+static const size_t SIZES[] = {1000, 100000, 1000000};
+
+/* The number of operations timed for each size */
+static const size_t OPERATIONS = 100000;
+
+/* The number of snapshots taken by copying a whole Array */
+static const size_t COPIES = 100;
+
+/* Keeps the results of the pure functions from being optimized away */
+static volatile size_t sink;
+
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report(const char *const type, const char *const op,
+                   const size_t n, const size_t count, const double elapsed) {
+	printf("%-16s %-14s n = %7zu: %10.1f ns/op\n", type, op, n,
+	       elapsed / count * 1e9);
+}
+
+/* Random indices below n */
+static size_t next_index(unsigned long *const seed, const size_t n) {
+	*seed = *seed * 6364136223846793005UL + 1442695040888963407UL;
+	return (size_t)(*seed >> 33) % n;
+}
+
+
+int main(void) {
+	for(size_t i = 0; i < sizeof(SIZES) / sizeof(*SIZES); ++i) {
+		const size_t n = SIZES[i];
+		Array *const array = a_new(n);
+		for(size_t j = 0; j < n; ++j) {
+			a_append(array, (data_t*)(j + 1));
+		}
+		PersistentVector *const vector = pv_from_array(array);
+
+		double start = now();
+		for(size_t j = 0; j < COPIES; ++j) {
+			Array *const copy = a_new(n);
+			for(size_t k = 0; k < n; ++k) {
+				a_append(copy, a_get(array, k));
+			}
+			sink = a_size(copy);
+			a_free(copy);
+		}
+		report("Array", "snapshot", n, COPIES, now() - start);
+		start = now();
+		for(size_t j = 0; j < OPERATIONS; ++j) {
+			PersistentVector *const copy = pv_copy(vector);
+			sink = pv_size(copy);
+			pv_free(copy);
+		}
+		report("PersistentVector", "snapshot", n, OPERATIONS, now() - start);
+
+		unsigned long seed = 42;
+		size_t sum = 0;
+		start = now();
+		for(size_t j = 0; j < OPERATIONS; ++j) {
+			sum += (size_t)a_get(array, next_index(&seed, n));
+		}
+		report("Array", "get", n, OPERATIONS, now() - start);
+		seed = 42;
+		start = now();
+		for(size_t j = 0; j < OPERATIONS; ++j) {
+			sum += (size_t)pv_get(vector, next_index(&seed, n));
+		}
+		report("PersistentVector", "get", n, OPERATIONS, now() - start);
+		sink = sum;
+
+		/* each version replaces the former one, which is freed */
+		PersistentVector *current = pv_copy(vector);
+		seed = 42;
+		start = now();
+		for(size_t j = 0; j < OPERATIONS; ++j) {
+			PersistentVector *const next =
+				pv_set(current, next_index(&seed, n), (data_t*)j);
+			pv_free(current);
+			current = next;
+		}
+		report("PersistentVector", "set", n, OPERATIONS, now() - start);
+		PVTransient *transient = pv_transient(current);
+		pv_free(current);
+		seed = 42;
+		start = now();
+		for(size_t j = 0; j < OPERATIONS; ++j) {
+			pv_transient_set(transient, next_index(&seed, n), (data_t*)j);
+		}
+		report("PVTransient", "set", n, OPERATIONS, now() - start);
+		pv_free(pv_persistent(transient));
+
+		current = pv_copy(vector);
+		start = now();
+		for(size_t j = 0; j < OPERATIONS; ++j) {
+			PersistentVector *const next = pv_push(current, (data_t*)j);
+			pv_free(current);
+			current = next;
+		}
+		report("PersistentVector", "push", n, OPERATIONS, now() - start);
+		pv_free(current);
+		transient = pv_transient(vector);
+		start = now();
+		for(size_t j = 0; j < OPERATIONS; ++j) {
+			pv_transient_push(transient, (data_t*)j);
+		}
+		report("PVTransient", "push", n, OPERATIONS, now() - start);
+		pv_transient_free(transient);
+
+		pv_free(vector);
+		a_free(array);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+#define _POSIX_C_SOURCE 200809L /* for clock_gettime() */
+
+#include "skiplist.h"
+#include "sortedarray.h"
+
+#include <stdio.h> /* for printf() */
+#include <stdlib.h> /* for malloc(), free(), EXIT_SUCCESS */
+#include <time.h> /* for clock_gettime(), struct timespec */
+
+
+
+static const size_t SIZES[] = {1000, 10000, 50000};
+
+/* Keeps the results of the pure functions from being optimized away */
+static volatile size_t sink;
+
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_ints(const data_t *const e1, const data_t *const e2) {
+	const int i1 = *(const int*)e1, i2 = *(const int*)e2;
+	return (i1 > i2) - (i1 < i2);
+}
+
+/* A permutation of 0..n-1, so that the insertions are in random positions */
+static int *shuffled(const size_t n) {
+	int *const values = malloc(n * sizeof(int));
+	unsigned long seed = 42;
+	for(size_t i = 0; i < n; ++i) {
+		values[i] = (int)i;
+	}
+	for(size_t i = n - 1; i > 0; --i) {
+		seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+		const size_t j = (seed >> 33) % (i + 1);
+		const int tmp = values[i];
+		values[i] = values[j];
+		values[j] = tmp;
+	}
+	return values;
+}
+
+static void report(const char *const type, const char *const op,
+                   const size_t n, const double elapsed) {
+	printf("%-11s %-8s n = %6zu: %8.1f ns/op\n", type, op, n,
+	       elapsed / n * 1e9);
+}
+
+
+static void bench_sortedarray(const int *const values, const size_t n) {
+	SortedArray *const sa = sa_new(n, cmp_ints);
+	double start = now();
+	for(size_t i = 0; i < n; ++i) {
+		sa_add(sa, (data_t*)&values[i]);
+	}
+	report("SortedArray", "add", n, now() - start);
+	start = now();
+	for(size_t i = 0; i < n; ++i) {
+		sink += (size_t)sa_indexof(sa, &values[i]);
+	}
+	report("SortedArray", "indexof", n, now() - start);
+	start = now();
+	for(size_t i = 0; i < n; ++i) {
+		sink += (size_t)sa_get(sa, (size_t)values[i]);
+	}
+	report("SortedArray", "get", n, now() - start);
+	start = now();
+	for(size_t i = 0; i < n; ++i) {
+		sa_remove(sa, &values[i]);
+	}
+	report("SortedArray", "remove", n, now() - start);
+	sa_free(sa);
+}
+
+static void bench_skiplist(const int *const values, const size_t n) {
+	SkipList *const sl = sl_new(n, cmp_ints);
+	double start = now();
+	for(size_t i = 0; i < n; ++i) {
+		sl_add(sl, (data_t*)&values[i]);
+	}
+	report("SkipList", "add", n, now() - start);
+	start = now();
+	for(size_t i = 0; i < n; ++i) {
+		sink += (size_t)sl_indexof(sl, &values[i]);
+	}
+	report("SkipList", "indexof", n, now() - start);
+	start = now();
+	for(size_t i = 0; i < n; ++i) {
+		sink += (size_t)sl_get(sl, (size_t)values[i]);
+	}
+	report("SkipList", "get", n, now() - start);
+	start = now();
+	for(size_t i = 0; i < n; ++i) {
+		sl_remove(sl, &values[i]);
+	}
+	report("SkipList", "remove", n, now() - start);
+	sl_free(sl);
+}
+
+
+int main(void) {
+	for(size_t i = 0; i < sizeof(SIZES) / sizeof(*SIZES); ++i) {
+		int *const values = shuffled(SIZES[i]);
+		bench_sortedarray(values, SIZES[i]);
+		bench_skiplist(values, SIZES[i]);
+		free(values);
+	}
+	return EXIT_SUCCESS;
+}
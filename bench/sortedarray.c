@@ -0,0 +1,184 @@
+#define _POSIX_C_SOURCE 200809L /* for clock_gettime() */
+
+#include "sortedarray.h"
+
+#include <stdint.h> /* for uint64_t */
+#include <stdio.h> /* for printf() */
+#include <stdlib.h> /* for malloc(), free(), EXIT_SUCCESS */
+#include <time.h> /* for clock_gettime(), struct timespec */
+
+
+
+static const size_t SIZES[] = {1000, 100000, 1000000, 4000000};
+
+/* The number of searches timed for each size */
+static const size_t QUERIES = 2000000;
+
+/* The number of values searched by each call to sa_indexof_many */
+#define BATCH 256
+
+/* The largest size the insertions and removals are timed for, since a
+   SortedArray without buffer nor lazy removals takes quadratic time to fill or
+   empty in random order */
+static const size_t MAX_INSERTS = 100000;
+
+/* The threshold of the insert buffer */
+static const size_t BUFFER = 512;
+
+/* The percentage of removed elements compacted by the lazy removals */
+static const unsigned LAZY = 25;
+
+/* Keeps the results of the pure functions from being optimized away */
+static volatile size_t sink;
+
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_ints(const data_t *const e1, const data_t *const e2) {
+	const int i1 = *(const int*)e1, i2 = *(const int*)e2;
+	return (i1 > i2) - (i1 < i2);
+}
+
+static uint64_t prefix_ints(const data_t *const e) {
+	return (uint64_t)*(const int*)e ^ (UINT64_C(1) << 63);
+}
+
+/* Random values in 0..2n-1, half of which are in the array */
+static int *queries(const size_t n) {
+	int *const values = malloc(QUERIES * sizeof(int));
+	unsigned long seed = 42;
+	for(size_t i = 0; i < QUERIES; ++i) {
+		seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+		values[i] = (int)((seed >> 33) % (2 * n));
+	}
+	return values;
+}
+
+static void report_adds(const char *const layout, const size_t n,
+                        const double elapsed) {
+	printf("SortedArray %-8s n = %7zu: %8.1f ns/add\n", layout, n,
+	       elapsed / n * 1e9);
+}
+
+static void report_removals(const char *const layout, const size_t n,
+                            const double elapsed) {
+	printf("SortedArray %-8s n = %7zu: %8.1f ns/remove\n", layout, n,
+	       elapsed / n * 1e9);
+}
+
+static void report(const char *const layout, const size_t n,
+                   const double elapsed) {
+	printf("SortedArray %-8s n = %7zu: %8.1f ns/indexof\n", layout, n,
+	       elapsed / QUERIES * 1e9);
+}
+
+static void bench_search(const SortedArray *const sa, const int *const values,
+                         const char *const layout, const size_t n) {
+	const double start = now();
+	for(size_t i = 0; i < QUERIES; ++i) {
+		sink += (size_t)sa_indexof(sa, &values[i]);
+	}
+	report(layout, n, now() - start);
+}
+
+static int cmp_ptrs(const void *const p1, const void *const p2) {
+	return cmp_ints(*(data_t *const*)p1, *(data_t *const*)p2);
+}
+
+/* Searches the values by batches, first in random order, then sorted */
+static void bench_batches(const SortedArray *const sa, const int *const values,
+                          const size_t n) {
+	data_t **const batch = malloc(QUERIES * sizeof(data_t*));
+	ssize_t indices[BATCH];
+	for(size_t i = 0; i < QUERIES; ++i) {
+		batch[i] = (data_t*)&values[i];
+	}
+	for(int sorted = 0; sorted < 2; ++sorted) {
+		if(sorted) {
+			for(size_t i = 0; i < QUERIES; i += BATCH) {
+				const size_t count = QUERIES - i < BATCH ? QUERIES - i : BATCH;
+				qsort(batch + i, count, sizeof(data_t*), cmp_ptrs);
+			}
+		}
+		const double start = now();
+		for(size_t i = 0; i < QUERIES; i += BATCH) {
+			const size_t count = QUERIES - i < BATCH ? QUERIES - i : BATCH;
+			sink += sa_indexof_many(sa, batch + i, count, indices);
+		}
+		report(sorted ? "sortbat" : "batch", n, now() - start);
+	}
+	free(batch);
+}
+
+/* Adds the values in random order, without then with an insert buffer */
+static void bench_inserts(const int *const values, const size_t n) {
+	for(int buffered = 0; buffered < 2; ++buffered) {
+		SortedArray *const sa = sa_new(n, cmp_ints);
+		if(buffered) {
+			sa_set_buffer(sa, BUFFER);
+		}
+		const double start = now();
+		for(size_t i = 0; i < n; ++i) {
+			sa_add(sa, (data_t*)&values[i]);
+		}
+		sa_flush(sa);
+		report_adds(buffered ? "buffered" : "sorted", n, now() - start);
+		sa_free(sa);
+	}
+}
+
+/* Removes random values from the even ones, with eager then lazy removals */
+static void bench_removals(int *const items, const int *const values,
+                           const size_t n) {
+	for(int lazy = 0; lazy < 2; ++lazy) {
+		SortedArray *const sa = sa_new(n, cmp_ints);
+		for(size_t i = 0; i < n; ++i) {
+			sa_add(sa, &items[i]);
+		}
+		if(lazy) {
+			sa_set_lazy_drop(sa, LAZY);
+		}
+		const double start = now();
+		for(size_t i = 0; i < n; ++i) {
+			sink += (size_t)sa_remove(sa, &values[i]);
+		}
+		sa_compact(sa);
+		report_removals(lazy ? "lazy" : "sorted", n, now() - start);
+		sa_free(sa);
+	}
+}
+
+
+int main(void) {
+	for(size_t i = 0; i < sizeof(SIZES) / sizeof(*SIZES); ++i) {
+		const size_t n = SIZES[i];
+		int *const items = malloc(n * sizeof(int));
+		int *const values = queries(n);
+		SortedArray *const sa = sa_new(n, cmp_ints);
+		SortedArray *const prefixed = sa_new_prefixed(n, cmp_ints, prefix_ints);
+		/* the even values, added in order so that the array is built fast */
+		for(size_t j = 0; j < n; ++j) {
+			items[j] = 2 * (int)j;
+			sa_add(sa, &items[j]);
+			sa_add(prefixed, &items[j]);
+		}
+		if(n <= MAX_INSERTS) {
+			bench_inserts(values, n);
+			bench_removals(items, values, n);
+		}
+		bench_search(sa, values, "sorted", n);
+		bench_batches(sa, values, n);
+		bench_search(prefixed, values, "prefixed", n);
+		sa_freeze(sa);
+		bench_search(sa, values, "frozen", n);
+		sa_free(prefixed);
+		sa_free(sa);
+		free(values);
+		free(items);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,105 @@
+#define _POSIX_C_SOURCE 200809L /* for clock_gettime() */
+
+#include "spscqueue.h"
+
+#include <pthread.h>
+#include <stdio.h> /* for printf() */
+#include <stdlib.h> /* for EXIT_SUCCESS */
+#include <time.h> /* for clock_gettime(), struct timespec */
+
+
+
+static const size_t ROUND_TRIPS = 1000000;
+static const size_t TRANSFERS = 50000000;
+static const size_t CAPACITY = 1024;
+static const size_t BATCH_SIZES[] = {1, 8, 64, 256};
+
+static int token;
+
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+struct pingpong {
+	SPSCQueue *ping;
+	SPSCQueue *pong;
+};
+
+static void *echo(void *const arg) {
+	const struct pingpong *const pp = arg;
+	for(size_t i = 0; i < ROUND_TRIPS; ++i) {
+		data_t *item;
+		while(!(item = spsc_pop(pp->ping)))
+			;
+		while(!spsc_push(pp->pong, item))
+			;
+	}
+	return NULL;
+}
+
+static void bench_latency(void) {
+	struct pingpong pp = {spsc_new(CAPACITY), spsc_new(CAPACITY)};
+	pthread_t thread;
+	pthread_create(&thread, NULL, echo, &pp);
+	const double start = now();
+	for(size_t i = 0; i < ROUND_TRIPS; ++i) {
+		while(!spsc_push(pp.ping, &token))
+			;
+		while(!spsc_pop(pp.pong))
+			;
+	}
+	const double elapsed = now() - start;
+	pthread_join(thread, NULL);
+	printf("round-trip latency: %8.1f ns\n", elapsed / ROUND_TRIPS * 1e9);
+	spsc_free(pp.ping);
+	spsc_free(pp.pong);
+}
+
+
+struct transfer {
+	SPSCQueue *queue;
+	size_t batch;
+};
+
+static void *consume(void *const arg) {
+	const struct transfer *const t = arg;
+	data_t *items[256];
+	for(size_t n = 0; n < TRANSFERS;) {
+		n += spsc_pop_n(t->queue, items, t->batch);
+	}
+	return NULL;
+}
+
+static void bench_throughput(const size_t batch) {
+	struct transfer t = {spsc_new(CAPACITY), batch};
+	data_t *items[256];
+	for(size_t i = 0; i < batch; ++i) {
+		items[i] = &token;
+	}
+	pthread_t thread;
+	pthread_create(&thread, NULL, consume, &t);
+	const double start = now();
+	for(size_t n = 0; n < TRANSFERS;) {
+		const size_t left = TRANSFERS - n;
+		n += spsc_push_n(t.queue, items, left < batch ? left : batch);
+	}
+	pthread_join(thread, NULL);
+	const double elapsed = now() - start;
+	printf("batch %3zu: %8.1f Mitems/s, %6.2f ns/item\n", batch,
+	       TRANSFERS / elapsed * 1e-6, elapsed / TRANSFERS * 1e9);
+	spsc_free(t.queue);
+}
+
+
+int main(void) {
+	printf("SPSCQueue, capacity %zu\n", CAPACITY);
+	bench_latency();
+	for(size_t i = 0; i < sizeof(BATCH_SIZES) / sizeof(*BATCH_SIZES); ++i) {
+		bench_throughput(BATCH_SIZES[i]);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+#define _POSIX_C_SOURCE 200809L /* for clock_gettime() */
+
+#include "hashmap.h"
+#include "stringmap.h"
+#include "stringpool.h"
+
+#include <stdio.h> /* for printf(), snprintf() */
+#include <stdlib.h> /* for malloc(), free(), EXIT_SUCCESS */
+#include <string.h> /* for strcmp(), strlen() */
+#include <time.h> /* for clock_gettime(), struct timespec */
+
+
+
+static const size_t SIZES[] = {1000, 100000, 1000000};
+
+/* The number of lookups timed for each size */
+static const size_t QUERIES = 1000000;
+
+/* The length of the keys, which share a long prefix as paths or URLs do */
+#define KEY_LENGTH 40
+
+/* Keeps the results of the pure functions from being optimized away */
+static volatile size_t sink;
+
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static size_t hash_strings(const data_t *const k) {
+	return (size_t)sp_hash_bytes(k, strlen(k));
+}
+
+static bool equal_strings(const data_t *const k1, const data_t *const k2) {
+	return strcmp(k1, k2) == 0;
+}
+
+/* Random keys among twice the n keys of the maps, each in its own buffer as a
+   key read from input would be */
+static char (*queries(const size_t n))[KEY_LENGTH] {
+	char (*const batch)[KEY_LENGTH] = malloc(QUERIES * KEY_LENGTH);
+	unsigned long seed = 42;
+	for(size_t i = 0; i < QUERIES; ++i) {
+		seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+		snprintf(batch[i], KEY_LENGTH, "/srv/data/objects/%010zu",
+		         (size_t)(seed >> 33) % (2 * n));
+	}
+	return batch;
+}
+
+static void report(const char *const map, const char *const op,
+                   const size_t n, const size_t count, const double elapsed) {
+	printf("%-9s %-12s n = %7zu: %8.1f ns/key\n", map, op, n,
+	       elapsed / count * 1e9);
+}
+
+
+int main(void) {
+	for(size_t i = 0; i < sizeof(SIZES) / sizeof(*SIZES); ++i) {
+		const size_t n = SIZES[i];
+		char (*const keys)[KEY_LENGTH] = malloc(n * KEY_LENGTH);
+		StringPool *const pool = sp_new(n);
+		StringMap *const sm = sm_new(n, pool);
+		HashMap *const hm = hm_new(n, hash_strings, equal_strings);
+		for(size_t j = 0; j < n; ++j) {
+			snprintf(keys[j], KEY_LENGTH, "/srv/data/objects/%010zu", 2 * j);
+			hm_put(hm, keys[j], keys[j]);
+			sm_put(sm, keys[j], keys[j]);
+		}
+		char (*const batch)[KEY_LENGTH] = queries(n);
+		const char **const interned = malloc(QUERIES * sizeof(char*));
+		for(size_t j = 0; j < QUERIES; ++j) {
+			interned[j] = sp_intern(pool, batch[j]);
+		}
+
+		size_t found = 0;
+		double start = now();
+		for(size_t j = 0; j < QUERIES; ++j) {
+			found += hm_get(hm, batch[j]) != NULL;
+		}
+		report("HashMap", "get", n, QUERIES, now() - start);
+		start = now();
+		for(size_t j = 0; j < QUERIES; ++j) {
+			found += sm_get(sm, batch[j]) != NULL;
+		}
+		report("StringMap", "get", n, QUERIES, now() - start);
+		start = now();
+		for(size_t j = 0; j < QUERIES; ++j) {
+			found += sm_get_interned(sm, interned[j]) != NULL;
+		}
+		report("StringMap", "get_interned", n, QUERIES, now() - start);
+		sink = found;
+
+		free(interned);
+		free(batch);
+		hm_free(hm);
+		sm_free(sm);
+		sp_free(pool);
+		free(keys);
+	}
+	return EXIT_SUCCESS;
+}
@@ -3,7 +3,7 @@
  * \author joH1
  * \version 0.1
  *
- * \brief Definition of a structure mapping keys to values in parallel arrays.
+ * \brief Definition of a structure mapping keys to values in a sorted array.
  *
  * The ArrayMap structure binds a \e key element type to a \e value one, in a
  * one-to-one relationship: each key binds to a value, and a key is unique.
@@ -16,11 +16,11 @@
  * possible, the provided comparison function must handle that value--and of
  * course, there can only be one NULL key in the map.
  *
- * This structure is implemented with two arrays: one that contains the keys,
- * and the other, the values. The arrays are parallel in that a key has the same
- * index in the array of keys as its value in the array of values. The keys are
- * sorted, to allow optimized resolution (\c O(log n) complexity using the
- * binary search algorithm).
+ * This structure is implemented with a single array of pairs, each holding a
+ * key next to its value, so that finding a key also brings its value in cache.
+ * The pairs are sorted by key, to allow optimized resolution (\c O(log n)
+ * complexity using the binary search algorithm). Inserting or removing a key
+ * shifts the following pairs in one block move.
  */
 
 #ifndef CODS_ARRAYMAP_H
@@ -30,8 +30,10 @@
 #include <stdbool.h>
 #include <stddef.h> /* for size_t */
 #include <stdlib.h> /* for NULL */
+#include <unistd.h> /* for ssize_t */
 
 #include "cods.h" /* for func attrs, data_t */
+#include "frozenmap.h" /* for FrozenMap */
 
 
 
@@ -43,6 +45,44 @@ typedef data_t key_t;
 /** Alias for the value type. */
 typedef data_t value_t;
 
+/**
+ * A handle on the place of a key in an array map, returned by \a am_entry.
+ *
+ * The fields are not to be used directly. A handle remains valid until the map
+ * is modified by any other mean than the handle itself.
+ */
+typedef struct amentry {
+	ArrayMap *map; /**< The array map */
+	key_t *key; /**< The key searched */
+	/** The index of the key if present, or \c -1 minus the index it is to be
+	    inserted at */
+	ssize_t index;
+} AMEntry;
+
+/**
+ * A position among the pairs of an array map, in the order of the keys,
+ * returned by \a am_seek, \a am_seek_first and \a am_seek_last.
+ *
+ * The fields are not to be used directly. A cursor remains valid until the map
+ * is modified.
+ */
+typedef struct amcursor {
+	const ArrayMap *map; /**< The array map */
+	ssize_t index; /**< The index of the current pair */
+	size_t size; /**< The number of pairs in the map */
+} AMCursor;
+
+/**
+ * The value kept for a key given several times to \a am_put_many, or given to
+ * it while present in the map. The values are ordered as met: the one in the
+ * map first, then those of the batch in their order.
+ */
+typedef enum amduplicates {
+	AM_KEEP_FIRST, /**< The first value is kept */
+	AM_KEEP_LAST,  /**< The last value is kept, as by successive \a am_put */
+	AM_MERGE       /**< The values are combined by a function, in order */
+} AMDuplicates;
+
 
 /**
  * \brief Creates a new array map.
@@ -62,6 +102,18 @@ CODS_NOTNULL(2);
  */
 CODS_MEMBER void am_free(ArrayMap *self);
 
+/**
+ * \brief Creates a copy of an array map.
+ *
+ * \note The keys and values themselves are not copied: both maps refer to the
+ *       same ones.
+ *
+ * \param[in] self The array map
+ *
+ * \return A newly-allocated ArrayMap, or \c NULL on error.
+ */
+CODS_MEMBER CODS_CTOR ArrayMap *am_copy(const ArrayMap *self);
+
 
 /**
  * \brief Places a key and its value in the array map.
@@ -78,6 +130,86 @@ CODS_MEMBER void am_free(ArrayMap *self);
  */
 CODS_MEMBER bool am_put(ArrayMap *self, key_t *key, value_t *value);
 
+/**
+ * \brief Places a key and its value in the array map, and gives the value it
+ *        replaces.
+ *
+ * The key is searched once, whether it is then inserted or its value replaced.
+ *
+ * \note Since a value may be \c NULL, the user is advised to check the value
+ *       of \e errno on \c NULL returned: it is \c ENOMEM if the key could not
+ *       be inserted.
+ *
+ * \param[in,out] self  The array map
+ * \param[in]     key   The key
+ * \param[in]     value The value
+ *
+ * \return The value formerly bound to the key, or \c NULL if the key was not
+ *         present.
+ */
+CODS_MEMBER value_t *am_upsert(ArrayMap *self, key_t *key, value_t *value);
+
+/**
+ * \brief Places a batch of keys and their values in the array map.
+ *
+ * The batch is sorted, then merged with the pairs of the map in a single
+ * linear pass, which costs \c O(m log m + n) for \a m pairs placed in a map of
+ * \a n pairs; placing them one by one would cost \c O(m n).
+ *
+ * A key given several times, or already present, keeps a single pair: its
+ * value is chosen by \a policy, and its key is the first met.
+ *
+ * \note This function sets \a errno to \c ENOMEM and returns \c -1 if a
+ *       memory allocation fails; in that case the map is left unchanged, and
+ *       \a merge is not called.
+ *
+ * \param[in,out] self   The array map
+ * \param[in]     keys   The keys
+ * \param[in]     values The value of each key
+ * \param[in]     n      The number of keys
+ * \param[in]     policy The value to keep for a key met several times
+ * \param[in]     merge  With \c AM_MERGE, the function combining two values of
+ *                       a key, given the key, the values in order and \a ctx;
+ *                       ignored otherwise
+ * \param[in]     ctx    A context passed to \a merge, may be \c NULL
+ *
+ * \return The number of keys added to the map, or \c -1 on error.
+ */
+CODS_MEMBER ssize_t am_put_many(ArrayMap *self, key_t *const keys[],
+                                value_t *const values[], size_t n,
+                                AMDuplicates policy,
+                                value_t *(*merge)(const key_t*, value_t*,
+                                                  value_t*, void*),
+                                void *ctx);
+
+/**
+ * \brief Constructs an array map from a set of keys and their values in any
+ *        order.
+ *
+ * The pairs are sorted at once, in \c O(n log n) time, instead of being placed
+ * one at a time; a key given several times keeps the value chosen by
+ * \a policy, see \a am_put_many.
+ *
+ * \param[in] keys   The keys
+ * \param[in] values The value of each key
+ * \param[in] n      The number of keys
+ * \param[in] cmp    The comparison function
+ * \param[in] policy The value to keep for a key met several times
+ * \param[in] merge  With \c AM_MERGE, the function combining two values of a
+ *                   key; ignored otherwise
+ * \param[in] ctx    A context passed to \a merge, may be \c NULL
+ *
+ * \return A newly-allocated ArrayMap, or \c NULL on error.
+ */
+CODS_CTOR ArrayMap *am_from_pairs(key_t *const keys[], value_t *const values[],
+                                  size_t n,
+                                  int (*cmp)(const key_t*, const key_t*),
+                                  AMDuplicates policy,
+                                  value_t *(*merge)(const key_t*, value_t*,
+                                                    value_t*, void*),
+                                  void *ctx)
+CODS_NOTNULL(4);
+
 /**
  * \brief Retrieves the value mapped to a key in the array map.
  *
@@ -89,6 +221,27 @@ CODS_MEMBER bool am_put(ArrayMap *self, key_t *key, value_t *value);
  */
 CODS_MEMBER value_t *am_get(const ArrayMap *self, const key_t *key)
 CODS_NOTNULL(2);
+
+/**
+ * \brief Retrieves the values mapped to a batch of keys in the array map.
+ *
+ * The keys are searched together, which is faster than calling \a am_get for
+ * each of them: the searches are interleaved so that their cache misses
+ * overlap, and a sorted batch is found in a single walk of the map when it is
+ * large enough. A sorted batch is the fastest.
+ *
+ * \param[in]  self   The array map
+ * \param[in]  keys   The keys
+ * \param[in]  n      The number of keys
+ * \param[out] values The value bound to each key, or \c NULL if the key is not
+ *                    present
+ *
+ * \return The number of keys found.
+ */
+CODS_MEMBER size_t am_get_many(const ArrayMap *self, key_t *const keys[],
+                               size_t n, value_t *values[])
+CODS_NOTNULL(2, 4);
+
 /**
  * \brief Convenience function to get a value from the array map or a default
  *        one if not present.
@@ -106,6 +259,29 @@ value_t *am_getd(const ArrayMap *const self, const key_t *const key,
 	return value == NULL ? d_val : value;
 }
 
+/**
+ * \brief Retrieves the value mapped to a key in the array map, or inserts the
+ *        key with a new value if not present.
+ *
+ * The key is searched once, and the value is only built if the key is missing.
+ *
+ * \note The room for the key is allocated before the value is built: if it
+ *       cannot be, \a factory is not called, \c NULL is returned and \e errno
+ *       is set to \c ENOMEM. A value built by \a factory is thus always
+ *       placed in the map, and never lost.
+ *
+ * \param[in,out] self    The array map
+ * \param[in]     key     The key
+ * \param[in]     factory The function building the value of a missing key
+ * \param[in]     ctx     The context given to \a factory
+ *
+ * \return The value bound to the key, either found or built.
+ */
+CODS_MEMBER value_t *am_get_or_insert(ArrayMap *self, key_t *key,
+                                      value_t *(*factory)(const key_t*, void*),
+                                      void *ctx)
+CODS_NOTNULL(3);
+
 /**
  * \brief Checks whether a key is present in the array map.
  *
@@ -129,5 +305,224 @@ CODS_MEMBER bool am_contains(const ArrayMap *self, const key_t *key);
  */
 CODS_MEMBER value_t *am_remove(ArrayMap *self, key_t *key);
 
+/**
+ * \brief Searches a key in the array map, and gives a handle on its place.
+ *
+ * The handle then reads the value of the key, replaces it, or inserts the key
+ * if missing, without searching the key again.
+ *
+ * \param[in] self The array map
+ * \param[in] key  The key
+ *
+ * \return The handle on the place of the key.
+ */
+CODS_MEMBER AMEntry am_entry(ArrayMap *self, key_t *key);
+
+/**
+ * \brief Checks whether the key of an entry is present in its array map.
+ *
+ * \param[in] entry The entry
+ *
+ * \return \c true if the key has a mapping in the map.
+ */
+CODS_MEMBER CODS_INLINE CODS_PURE
+bool am_entry_occupied(const AMEntry *const entry) {
+	return entry->index >= 0;
+}
+
+/**
+ * \brief Retrieves the value of the key of an entry.
+ *
+ * \param[in] entry The entry
+ *
+ * \return The value bound to the key, or \c NULL if the key is not present.
+ */
+CODS_MEMBER value_t *am_entry_get(const AMEntry *entry) CODS_PURE;
+
+/**
+ * \brief Replaces the value of the key of an entry, if present.
+ *
+ * \param[in,out] entry The entry
+ * \param[in]     value The new value
+ *
+ * \return The former value, or \c NULL if the key is not present; the map is
+ *         then left unchanged.
+ */
+CODS_MEMBER value_t *am_entry_replace(AMEntry *entry, value_t *value);
+
+/**
+ * \brief Inserts the key of an entry in its array map, if not present.
+ *
+ * The entry then refers to the inserted key.
+ *
+ * \note If the key is already present, the map is left unchanged and
+ *       \c false is returned; \e errno is set to \c 0, or to \c ENOMEM if the
+ *       insertion failed.
+ *
+ * \param[in,out] entry The entry
+ * \param[in]     value The value of the key
+ *
+ * \return \c true if the key was inserted.
+ */
+CODS_MEMBER bool am_entry_insert(AMEntry *entry, value_t *value);
+
+/**
+ * \brief Applies a function to the keys and values of the array map, in the
+ *        order of the keys.
+ *
+ * \note The function must not modify the map, nor its keys in a way that
+ *       changes their order.
+ *
+ * \param[in] self  The array map
+ * \param[in] apply The function to apply, given a key, its value and \a ctx
+ * \param[in] ctx   A context passed to the function, may be \c NULL
+ */
+CODS_MEMBER void am_foreach(const ArrayMap *self,
+                            void (*apply)(key_t*, value_t*, void*), void *ctx)
+CODS_NOTNULL(2);
+
+/**
+ * \brief Applies a function to the keys and values of the array map in a range
+ *        of keys, in order.
+ *
+ * The function is applied to each key not less than \a lo and less than \a hi,
+ * in \c O(log n + k) for \a k keys in the range.
+ *
+ * \note The function must not modify the map, nor its keys in a way that
+ *       changes their order.
+ *
+ * \param[in] self  The array map
+ * \param[in] lo    The lower bound of the range, included
+ * \param[in] hi    The upper bound of the range, excluded
+ * \param[in] apply The function to apply, given a key, its value and \a ctx
+ * \param[in] ctx   A context passed to the function, may be \c NULL
+ */
+CODS_MEMBER void am_foreach_range(const ArrayMap *self, const key_t *lo,
+                                  const key_t *hi,
+                                  void (*apply)(key_t*, value_t*, void*),
+                                  void *ctx)
+CODS_NOTNULL(4);
+
+/**
+ * \brief Gives a cursor on the first key of the array map not less than a
+ *        given key, in \c O(log n).
+ *
+ * \param[in] self The array map
+ * \param[in] key  The key to compare the keys of the map with
+ *
+ * \return The cursor, past the last pair if every key is less than \a key.
+ */
+CODS_MEMBER AMCursor am_seek(const ArrayMap *self, const key_t *key);
+
+/**
+ * \brief Gives a cursor on the least key of the array map.
+ *
+ * \param[in] self The array map
+ *
+ * \return The cursor, not valid if the map is empty.
+ */
+CODS_MEMBER AMCursor am_seek_first(const ArrayMap *self) CODS_PURE;
+
+/**
+ * \brief Gives a cursor on the greatest key of the array map.
+ *
+ * \param[in] self The array map
+ *
+ * \return The cursor, not valid if the map is empty.
+ */
+CODS_MEMBER AMCursor am_seek_last(const ArrayMap *self) CODS_PURE;
+
+/**
+ * \brief Checks whether a cursor is on a pair of its array map.
+ *
+ * \param[in] cursor The cursor
+ *
+ * \return \c false if the cursor moved past either end of the map.
+ */
+CODS_MEMBER CODS_INLINE CODS_PURE
+bool am_cursor_valid(const AMCursor *const cursor) {
+	return cursor->index >= 0 && (size_t)cursor->index < cursor->size;
+}
+
+/**
+ * \brief Retrieves the key a cursor is on.
+ *
+ * \param[in] cursor The cursor
+ *
+ * \return The key, or \c NULL if the cursor is not valid.
+ */
+CODS_MEMBER key_t *am_cursor_key(const AMCursor *cursor) CODS_PURE;
+
+/**
+ * \brief Retrieves the value of the key a cursor is on.
+ *
+ * \param[in] cursor The cursor
+ *
+ * \return The value, or \c NULL if the cursor is not valid.
+ */
+CODS_MEMBER value_t *am_cursor_value(const AMCursor *cursor) CODS_PURE;
+
+/**
+ * \brief Moves a cursor to the next key of its array map.
+ *
+ * \note A cursor past the last pair stays there; one before the first pair is
+ *       moved to it.
+ *
+ * \param[in,out] cursor The cursor
+ *
+ * \return \c true if the cursor is on a pair after moving.
+ */
+CODS_MEMBER bool am_cursor_next(AMCursor *cursor);
+
+/**
+ * \brief Moves a cursor to the previous key of its array map.
+ *
+ * \note A cursor before the first pair stays there; one past the last pair is
+ *       moved to it.
+ *
+ * \param[in,out] cursor The cursor
+ *
+ * \return \c true if the cursor is on a pair after moving.
+ */
+CODS_MEMBER bool am_cursor_prev(AMCursor *cursor);
+
+
+/**
+ * \brief Builds an immutable copy of an array map, indexed by a perfect hash
+ *        function.
+ *
+ * The frozen map compares the keys with the comparison function of the array
+ * map; see \a fm_new.
+ *
+ * \note The keys and values themselves are not copied: both maps refer to the
+ *       same ones.
+ *
+ * \param[in] self The array map
+ * \param[in] hash The hash function of the keys
+ *
+ * \return A newly-allocated FrozenMap, or \c NULL on error.
+ */
+CODS_MEMBER CODS_CTOR FrozenMap *am_freeze(const ArrayMap *self,
+                                           size_t (*hash)(const key_t*))
+CODS_NOTNULL(2);
+
+/**
+ * \brief Rebuilds a frozen copy of an array map from the data saved by
+ *        \a fm_save, without searching the hash function again.
+ *
+ * \note The array map must hold the same keys as the one frozen.
+ *
+ * \param[in] self The array map
+ * \param[in] hash The hash function of the keys
+ * \param[in] data The data written by \a fm_save
+ * \param[in] size The size of the data, in bytes
+ *
+ * \return A newly-allocated FrozenMap, or \c NULL on error.
+ */
+CODS_MEMBER CODS_CTOR FrozenMap *am_freeze_load(const ArrayMap *self,
+                                                size_t (*hash)(const key_t*),
+                                                const void *data, size_t size)
+CODS_NOTNULL(2, 3);
+
 
 #endif /* CODS_ARRAYMAP_H */
@@ -126,5 +126,24 @@ bool ba_put(BitArray *const self, const size_t i, const bool val) {
 	return val ? ba_set(self, i) : ba_unset(self, i);
 }
 
+/**
+ * \brief Counts the elements set to \c true in a range of the bit array.
+ *
+ * The bits are counted by whole bytes, which makes this function much faster
+ * than as many calls to \a ba_get.
+ *
+ * \note If the range is invalid, this function sets \a errno to \c ERANGE and
+ *       returns \c 0.
+ *
+ * \param[in] self The bit array
+ * \param[in] from The index of the first element of the range
+ * \param[in] to   The index following the last element of the range
+ *
+ * \return The number of elements set to \c true from \a from to \a to,
+ *         excluded.
+ */
+CODS_MEMBER size_t ba_count_range(const BitArray *self, size_t from, size_t to)
+CODS_PURE;
+
 
 #endif /* CODS_BITARRAY_H */
@@ -0,0 +1,173 @@
+/**
+ * \file "bplustree.h"
+ * \author joH1
+ * \version 0.1
+ *
+ * \brief An ordered set implemented as a B+ tree.
+ *
+ * The BPlusTree type stores its elements sorted with a comparison function,
+ * and offers the same interface as SortedArray. The elements are held in the
+ * leaves of a balanced tree, in blocks of contiguous slots sized after the
+ * processor cache lines, and the leaves are chained in order; the inner nodes
+ * only guide the searches.
+ *
+ * Where a SortedArray has to shift the whole tail of its array to insert or
+ * remove an element, a B+ tree only shifts the elements of one leaf, and
+ * splits or merges a few nodes at most: adding, removing, finding an element
+ * and accessing it by its index (its \e rank in the order of the set) all cost
+ * \c O(log n). Scanning the elements in order, with \a bpt_each, reads the
+ * leaves one after the other.
+ *
+ * The tree is to be preferred over a SortedArray for large sets; for small
+ * ones, the plain array remains more compact.
+ *
+ * The comparison function follows the specifications given for SortedArray;
+ * in particular, the tree does not contain two equivalent elements.
+ *
+ * The functions \a bpt_new, \a bpt_add, \a bpt_get and \a bpt_drop set the
+ * variable \a errno to describe their state:
+ * - \c 0 if the execution proceeded nominally,
+ * - \c ENOMEM if a memory allocation failed,
+ * - \c ERANGE if an index is greater than, or equal to the size of the tree.
+ */
+
+#ifndef CODS_BPLUSTREE_H
+#define CODS_BPLUSTREE_H
+
+
+#include <stddef.h> /* for size_t */
+#include <stdlib.h> /* for NULL */
+#include <unistd.h> /* for ssize_t */
+
+#include "cods.h" /* for func attrs, data_t */
+
+
+
+/** The B+ tree structure. */
+typedef struct bplustree BPlusTree;
+
+
+/**
+ * \brief Creates a new, empty B+ tree.
+ *
+ * \param[in] cmp The comparison function
+ *
+ * \return A newly allocated instance of BPlusTree, or \c NULL on error.
+ */
+CODS_CTOR BPlusTree *bpt_new(int (*cmp)(const data_t*, const data_t*))
+CODS_NOTNULL(1);
+
+/**
+ * \brief Deallocates a B+ tree, and all of its nodes.
+ *
+ * \note The elements themselves are not freed.
+ *
+ * \param[in,out] self The B+ tree
+ */
+CODS_MEMBER void bpt_free(BPlusTree *self);
+
+/**
+ * \brief Retrieves the size of the B+ tree.
+ *
+ * \param[in] self The B+ tree
+ *
+ * \return The number of elements in the tree.
+ */
+CODS_MEMBER size_t bpt_size(const BPlusTree *self) CODS_PURE;
+
+/**
+ * \brief Adds an element in the B+ tree.
+ *
+ * \note If the tree already contains an element equivalent to the given value,
+ *       the function does not add the element and returns \c -1.
+ *
+ * \param[in,out] self The B+ tree
+ * \param[in]     item The element, may be \c NULL
+ *
+ * \return The index of the element in the tree, or \c -1 on error.
+ */
+CODS_MEMBER ssize_t bpt_add(BPlusTree *self, data_t *item);
+
+/**
+ * \brief Retrieves an element in the B+ tree by its index.
+ *
+ * \note Since an element may be \c NULL, the user is advised to check the value
+ *       of \e errno on \c NULL returned to ensure that the value truly
+ *       indicates an error.
+ *
+ * \param[in] self  The B+ tree
+ * \param[in] index The index
+ *
+ * \return The element at given index in the tree, or \c NULL if the index is
+ *         invalid.
+ */
+CODS_MEMBER data_t *bpt_get(const BPlusTree *self, size_t index) CODS_PURE;
+
+/**
+ * \brief Retrieves the index of an equivalent element in the B+ tree.
+ *
+ * \param[in] self  The B+ tree
+ * \param[in] value The element value
+ *
+ * \return The index of the equivalent element, or \c -1 if none matches.
+ */
+CODS_MEMBER ssize_t bpt_indexof(const BPlusTree *self, const data_t *value)
+CODS_PURE;
+
+/**
+ * \brief Retrieves in the B+ tree an element equivalent to the given one.
+ *
+ * \param[in] self  The B+ tree
+ * \param[in] other The equivalent element
+ *
+ * \return The element equivalent to the given one, or \c NULL if none matches.
+ */
+CODS_MEMBER CODS_INLINE CODS_PURE
+data_t *bpt_geteq(const BPlusTree *const self, const data_t *const other) {
+	const ssize_t index = bpt_indexof(self, other);
+	return index == -1 ? NULL : bpt_get(self, index);
+}
+
+/**
+ * \brief Removes an element from the B+ tree, by its index.
+ *
+ * \note The tree keeps no reference to the element removed, which may then be
+ *       freed by the user.
+ *
+ * \param[in,out] self  The B+ tree
+ * \param[in]     index The index of the element
+ *
+ * \return The value just removed, or \c NULL on error.
+ */
+CODS_MEMBER data_t *bpt_drop(BPlusTree *self, size_t index);
+
+/**
+ * \brief Removes an element in the B+ tree equivalent to the given value.
+ *
+ * \note As with \a bpt_drop, the element removed may then be freed.
+ *
+ * \param[in,out] self  The B+ tree
+ * \param[in]     other The equivalent element
+ *
+ * \return The element just removed, or \c NULL if none matches.
+ */
+CODS_MEMBER CODS_INLINE
+data_t *bpt_remove(BPlusTree *const self, const data_t *const other) {
+	const ssize_t index = bpt_indexof(self, other);
+	return index < 0 ? NULL : bpt_drop(self, index);
+}
+
+/**
+ * \brief Applies a function to each element of the B+ tree, in order.
+ *
+ * \note The function must not modify the elements in a way that changes their
+ *       order.
+ *
+ * \param[in,out] self  The B+ tree
+ * \param[in]     apply The function to apply
+ */
+CODS_MEMBER void bpt_each(BPlusTree *self, void (*apply)(data_t*))
+CODS_NOTNULL(2);
+
+
+#endif /* CODS_BPLUSTREE_H */
@@ -0,0 +1,193 @@
+/**
+ * \file "cache.h"
+ * \author joH1
+ * \version 0.1
+ *
+ * \brief A map of bounded capacity, evicting its entries by recency of use.
+ *
+ * The Cache type binds keys to values as HashMap does, but holds at most a
+ * given number of entries: placing a new key in a full cache first evicts an
+ * entry, chosen by the \e policy of the cache:
+ * - \c CA_LRU evicts the least recently used entry: the entries are kept in an
+ *   intrusive list, ordered by their last use, and each hit moves its entry to
+ *   the front of the list;
+ * - \c CA_CLOCK approximates it with the \e second-chance algorithm: a hit only
+ *   sets a \e referenced bit of its entry, and a \e hand sweeping the entries
+ *   in a circle evicts the first one not referenced, clearing the bits it
+ *   passes. A hit thus writes no link, at the cost of a coarser order.
+ *
+ * The entries are allocated once, at creation, and indexed by a HashMap, so
+ * that finding, placing and evicting a key all cost \c O(1) on average. The
+ * user may be notified of each eviction with a callback, e.g. to release the
+ * key and the value; the cache counts its hits, misses and evictions.
+ *
+ * The functions \a ca_new and \a ca_put set the variable \a errno to describe
+ * their state:
+ * - \c 0 if the execution proceeded nominally,
+ * - \c ENOMEM if a memory allocation failed,
+ * - \c EINVAL if the capacity given to \a ca_new is \c 0.
+ */
+
+#ifndef CODS_CACHE_H
+#define CODS_CACHE_H
+
+
+#include <stdbool.h>
+#include <stddef.h> /* for size_t */
+
+#include "cods.h" /* for func attrs, data_t */
+
+
+
+/** A map of bounded capacity. */
+typedef struct cache Cache;
+
+/** The choice of the entry to evict from a full cache. */
+typedef enum cachepolicy {
+	CA_LRU,  /**< The least recently used entry */
+	CA_CLOCK /**< An entry not used since the last sweep of the clock hand */
+} CachePolicy;
+
+/** The counters of the uses of a cache. */
+typedef struct cachestats {
+	size_t hits;      /**< The number of keys found by \a ca_get */
+	size_t misses;    /**< The number of keys not found by \a ca_get */
+	size_t evictions; /**< The number of entries evicted by \a ca_put or
+	                       \a ca_clear */
+} CacheStats;
+
+
+/**
+ * \brief Creates a new cache.
+ *
+ * \param[in] capacity The maximal number of entries
+ * \param[in] policy   The choice of the entry to evict
+ * \param[in] hash     The hash function of the keys
+ * \param[in] equal    The equality function of the keys
+ *
+ * \return A newly-allocated Cache, or \c NULL on error.
+ */
+CODS_CTOR Cache *ca_new(size_t capacity, CachePolicy policy,
+                        size_t (*hash)(const data_t*),
+                        bool (*equal)(const data_t*, const data_t*))
+CODS_NOTNULL(3, 4);
+
+/**
+ * \brief Releases memory of a cache.
+ *
+ * \note The keys and values themselves are not freed, and the eviction
+ *       callback is not called; see \a ca_clear.
+ *
+ * \param[in,out] self The cache
+ */
+CODS_MEMBER void ca_free(Cache *self);
+
+/**
+ * \brief Sets the function called on each eviction.
+ *
+ * \param[in,out] self  The cache
+ * \param[in]     evict The function, given the key and the value of the
+ *                      evicted entry and the context, or \c NULL
+ * \param[in]     ctx   The context given to \a evict
+ */
+CODS_MEMBER void ca_set_evict(Cache *self,
+                              void (*evict)(data_t*, data_t*, void*),
+                              void *ctx);
+
+/**
+ * \brief Retrieves the number of entries in the cache.
+ *
+ * \param[in] self The cache
+ *
+ * \return The number of entries.
+ */
+CODS_MEMBER size_t ca_size(const Cache *self) CODS_PURE;
+
+/**
+ * \brief Retrieves the maximal number of entries in the cache.
+ *
+ * \param[in] self The cache
+ *
+ * \return The capacity given at creation.
+ */
+CODS_MEMBER size_t ca_capacity(const Cache *self) CODS_PURE;
+
+/**
+ * \brief Retrieves the counters of the uses of the cache.
+ *
+ * \param[in] self The cache
+ *
+ * \return The counters since the creation or the last reset.
+ */
+CODS_MEMBER CacheStats ca_stats(const Cache *self) CODS_PURE;
+
+/**
+ * \brief Resets the counters of the uses of the cache to \c 0.
+ *
+ * \param[in,out] self The cache
+ */
+CODS_MEMBER void ca_reset_stats(Cache *self);
+
+/**
+ * \brief Places a key and its value in the cache, evicting an entry if full.
+ *
+ * The entry counts as used.
+ *
+ * \note If the key is already present in the cache, the mapped value is
+ *       overriden, and no callback is called.
+ *
+ * \param[in,out] self  The cache
+ * \param[in]     key   The key
+ * \param[in]     value The value
+ *
+ * \return \c true if the key and the value could be placed, or \c false if any
+ *         error occurred; nothing is evicted then.
+ */
+CODS_MEMBER bool ca_put(Cache *self, data_t *key, data_t *value);
+
+/**
+ * \brief Retrieves the value mapped to a key in the cache, and counts the
+ *        entry as used.
+ *
+ * \param[in,out] self The cache
+ * \param[in]     key  The key
+ *
+ * \return The value bound to the given key, or \c NULL if the key is not
+ *         present.
+ */
+CODS_MEMBER data_t *ca_get(Cache *self, const data_t *key);
+
+/**
+ * \brief Checks whether a key is present in the cache, without counting the
+ *        entry as used.
+ *
+ * \param[in] self The cache
+ * \param[in] key  The key
+ *
+ * \return \c true if the key has an entry in the cache.
+ */
+CODS_MEMBER bool ca_contains(const Cache *self, const data_t *key) CODS_PURE;
+
+/**
+ * \brief Removes a key and its value from the cache.
+ *
+ * \note The eviction callback is not called. If the key is not present,
+ *       \c NULL is returned and no action is performed on the cache.
+ *
+ * \param[in,out] self The cache
+ * \param[in]     key  The key
+ *
+ * \return The former value, or \c NULL.
+ */
+CODS_MEMBER data_t *ca_remove(Cache *self, const data_t *key);
+
+/**
+ * \brief Evicts every entry of the cache, calling the eviction callback on
+ *        each of them.
+ *
+ * \param[in,out] self The cache
+ */
+CODS_MEMBER void ca_clear(Cache *self);
+
+
+#endif /* CODS_CACHE_H */
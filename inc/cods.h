@@ -29,6 +29,7 @@ typedef void data_t;
 
 # define CODS_LIKELY(cond)   __builtin_expect((cond), 1)
 # define CODS_UNLIKELY(cond) __builtin_expect((cond), 0)
+# define CODS_PREFETCH(addr) __builtin_prefetch((addr))
 
 
 #else /* GNU C */
@@ -39,6 +40,7 @@ typedef void data_t;
 
 # define CODS_LIKELY(cond)   (cond)
 # define CODS_UNLIKELY(cond) (cond)
+# define CODS_PREFETCH(addr) ((void)(addr))
 
 #endif
 
@@ -111,12 +113,30 @@ typedef void data_t;
 #define CODS_MEMBER CODS_NOTNULL(1)
 
 
+#ifndef CODS_CACHE_LINE
+/**
+ * \brief The assumed size, in bytes, of a line of the processor data cache.
+ *
+ * This value is used to lay out the structures whose members are accessed
+ * concurrently, or whose nodes are sized after the cache. It can be overridden
+ * at compilation, e.g. \c -DCODS_CACHE_LINE=128.
+ */
+# define CODS_CACHE_LINE 64
+#endif
+
+
 #if !defined(CODS_FIXEDARRAY_H) && !defined(CODS_FIXEDARRAY_FUNCS_H) \
     && !defined(CODS_ARRAY_H) && !defined(CODS_ARRAY_FUNCS_H) \
-    && !defined(CODS_ARRAYMAP_H)\
+    && !defined(CODS_ARRAYMAP_H) && !defined(CODS_CACHE_H) \
+    && !defined(CODS_CONCURRENTMAP_H) && !defined(CODS_INTMAP_H) \
+    && !defined(CODS_FROZENMAP_H) && !defined(CODS_INTRUSIVELIST_H) \
     && !defined(CODS_LINKEDLIST_H) && !defined(CODS_LINKEDLIST_FUNCS_H) \
+    && !defined(CODS_PERSISTENTVECTOR_H) \
     && !defined(CODS_BITARRAY_H) && !defined(CODS_BITARRAY_FUNCS_H)\
-    && !defined(CODS_SORTEDARRAY_H)
+    && !defined(CODS_BPLUSTREE_H) && !defined(CODS_HASHMAP_H) \
+    && !defined(CODS_SKIPLIST_H) && !defined(CODS_SORTEDARRAY_H) \
+    && !defined(CODS_SPSCQUEUE_H) && !defined(CODS_STRINGMAP_H) \
+    && !defined(CODS_STRINGPOOL_H)
 /* The file has been included directly: use it as the project's main interface
 */
 
@@ -125,11 +145,23 @@ typedef void data_t;
 #include "arraymap.h"
 #include "bitarray.h"
 #include "bitarray_funcs.h"
+#include "bplustree.h"
+#include "cache.h"
+#include "concurrentmap.h"
 #include "fixedarray.h"
 #include "fixedarray_funcs.h"
+#include "frozenmap.h"
+#include "hashmap.h"
+#include "intmap.h"
+#include "intrusivelist.h"
 #include "linkedlist.h"
 #include "linkedlist_funcs.h"
+#include "persistentvector.h"
+#include "skiplist.h"
 #include "sortedarray.h"
+#include "spscqueue.h"
+#include "stringmap.h"
+#include "stringpool.h"
 
 #endif /* main project file */
 
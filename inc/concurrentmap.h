@@ -0,0 +1,200 @@
+/**
+ * \file "concurrentmap.h"
+ * \author joH1
+ * \version 0.1
+ *
+ * \brief An ordered map shared between threads, whose readers never block.
+ *
+ * The ConcurrentMap type publishes successive versions of an ArrayMap through
+ * an atomic pointer. A version is never modified once published: a writer
+ * copies the current version into a \e draft, modifies it with the functions of
+ * ArrayMap (as many puts and removals as it likes), then commits it, which
+ * replaces the current version in a single atomic swap. The readers thus see
+ * either all the changes of a commit or none of them, and neither take a lock
+ * nor write to any memory shared with other readers.
+ *
+ * A version replaced by a commit is freed once no reader can still use it,
+ * with epoch-based reclamation: each commit increments a global \e epoch, and
+ * each reader records the epoch it entered the map at in a slot of its own, so
+ * that the writer frees the versions older than every reader still in the map.
+ * A reader registers once with \a cm_reader_new, then calls \a cm_get, or
+ * brackets several lookups in a single version with \a cm_enter and
+ * \a cm_leave.
+ *
+ * The writers are serialized by a spin lock, which the readers never take: the
+ * structure suits maps read much more often than they are modified, as a
+ * commit copies the whole map.
+ *
+ * The functions \a cm_new, \a cm_reader_new, \a cm_begin, \a cm_put and
+ * \a cm_remove set the variable \a errno to describe their state:
+ * - \c 0 if the execution proceeded nominally,
+ * - \c ENOMEM if a memory allocation failed,
+ * - \c EINVAL if the size given to \a cm_new is \c 0.
+ */
+
+#ifndef CODS_CONCURRENTMAP_H
+#define CODS_CONCURRENTMAP_H
+
+
+#include <stdbool.h>
+#include <stddef.h> /* for size_t */
+
+#include "arraymap.h" /* for ArrayMap, key_t, value_t */
+#include "cods.h" /* for func attrs */
+
+
+
+/** An ordered map read without locks by several threads. */
+typedef struct concurrentmap ConcurrentMap;
+
+/** The registration of a reader thread to a concurrent map. */
+typedef struct cmreader CMReader;
+
+
+/**
+ * \brief Creates a new concurrent map, empty.
+ *
+ * \param[in] size The initial number of key-value elements
+ * \param[in] cmp  The comparison function
+ *
+ * \return A newly-allocated ConcurrentMap, or \c NULL on error.
+ */
+CODS_CTOR ConcurrentMap *cm_new(size_t size,
+                                int (*cmp)(const key_t*, const key_t*))
+CODS_NOTNULL(2);
+
+/**
+ * \brief Releases memory of a concurrent map, its versions and its readers.
+ *
+ * \note No thread may use the map, nor any of its readers, anymore.
+ *
+ * \param[in,out] self The concurrent map
+ */
+CODS_MEMBER void cm_free(ConcurrentMap *self);
+
+
+/**
+ * \brief Registers a reader of the concurrent map.
+ *
+ * A reader is to be used by a single thread at a time. The slot of a reader
+ * released by \a cm_reader_free is reused by the next registration.
+ *
+ * \param[in,out] self The concurrent map
+ *
+ * \return The reader, or \c NULL on error.
+ */
+CODS_MEMBER CMReader *cm_reader_new(ConcurrentMap *self);
+
+/**
+ * \brief Releases a reader of its concurrent map.
+ *
+ * \note The reader must not be in the map, i.e. between \a cm_enter and
+ *       \a cm_leave.
+ *
+ * \param[in,out] reader The reader
+ */
+CODS_MEMBER void cm_reader_free(CMReader *reader);
+
+/**
+ * \brief Enters the concurrent map, and gives its current version.
+ *
+ * The version remains valid and unchanged until \a cm_leave, whatever the
+ * writers commit meanwhile. It is to be read with the functions of ArrayMap
+ * only, e.g. \a am_get or \a am_get_many.
+ *
+ * \note A reader cannot enter the map twice without leaving it in between.
+ *
+ * \param[in,out] reader The reader
+ *
+ * \return The current version of the map.
+ */
+CODS_MEMBER const ArrayMap *cm_enter(CMReader *reader);
+
+/**
+ * \brief Leaves the concurrent map, releasing the version given by
+ *        \a cm_enter.
+ *
+ * \param[in,out] reader The reader
+ */
+CODS_MEMBER void cm_leave(CMReader *reader);
+
+/**
+ * \brief Retrieves the value mapped to a key in the current version of the
+ *        concurrent map.
+ *
+ * \param[in,out] reader The reader
+ * \param[in]     key    The key
+ *
+ * \return The value bound to the given key, or \c NULL if the key is not
+ *         present.
+ */
+CODS_MEMBER value_t *cm_get(CMReader *reader, const key_t *key)
+CODS_NOTNULL(2);
+
+
+/**
+ * \brief Starts a modification of the concurrent map.
+ *
+ * The other writers wait until the draft is committed or aborted.
+ *
+ * \param[in,out] self The concurrent map
+ *
+ * \return A copy of the current version, to be modified with the functions of
+ *         ArrayMap then given to \a cm_commit or \a cm_abort, or \c NULL on
+ *         error.
+ */
+CODS_MEMBER ArrayMap *cm_begin(ConcurrentMap *self);
+
+/**
+ * \brief Publishes a draft as the current version of the concurrent map.
+ *
+ * The readers entering the map from then on see the draft. The versions no
+ * reader uses anymore are freed.
+ *
+ * \param[in,out] self  The concurrent map
+ * \param[in]     draft The draft given by \a cm_begin
+ */
+CODS_MEMBER void cm_commit(ConcurrentMap *self, ArrayMap *draft)
+CODS_NOTNULL(2);
+
+/**
+ * \brief Discards a draft, leaving the concurrent map unchanged.
+ *
+ * \param[in,out] self  The concurrent map
+ * \param[in]     draft The draft given by \a cm_begin
+ */
+CODS_MEMBER void cm_abort(ConcurrentMap *self, ArrayMap *draft)
+CODS_NOTNULL(2);
+
+/**
+ * \brief Places a key and its value in the concurrent map, in a version of
+ *        its own.
+ *
+ * \note If the key is already present in the map, the mapped value is
+ *       overriden.
+ *
+ * \param[in,out] self  The concurrent map
+ * \param[in]     key   The key
+ * \param[in]     value The value
+ *
+ * \return \c true if the key and the value could be placed, or \c false if any
+ *         error occurred.
+ */
+CODS_MEMBER bool cm_put(ConcurrentMap *self, key_t *key, value_t *value);
+
+/**
+ * \brief Removes a key and its value from the concurrent map, in a version of
+ *        its own.
+ *
+ * \note If the key is not present, \c NULL is returned and no version is
+ *       published.
+ *
+ * \param[in,out] self The concurrent map
+ * \param[in]     key  The key
+ *
+ * \return The former value, or \c NULL.
+ */
+CODS_MEMBER value_t *cm_remove(ConcurrentMap *self, key_t *key);
+
+
+#endif /* CODS_CONCURRENTMAP_H */
@@ -0,0 +1,166 @@
+/**
+ * \file "frozenmap.h"
+ * \author joH1
+ * \version 0.1
+ *
+ * \brief An immutable map indexed by a minimal perfect hash function.
+ *
+ * The FrozenMap type binds a fixed set of keys to values, given all at once at
+ * creation, and is never modified afterwards. The keys are placed in a table
+ * of exactly one slot per key, at the position given by a \e perfect hash
+ * function built for them: no two keys share a slot, so that a lookup reads
+ * one \e pilot, computes the slot of the key and compares it with the key held
+ * there, with no probing and no empty slot.
+ *
+ * The function follows the \e hash-and-displace scheme of PTHash: the keys are
+ * spread into buckets of about 4 keys, and each bucket is given the first
+ * pilot that sends all its keys to free slots, the largest buckets first. A
+ * table slightly larger than the number of keys makes this search fast; the
+ * few keys falling past the end of the table are then moved to the free slots
+ * before it, through a small remapping array. The function takes less than 2
+ * bytes per key.
+ *
+ * The hash function given by the user needs not be of high quality, as its
+ * result is mixed before use, but it must give distinct hashes to distinct
+ * keys of the map, as no function could separate them otherwise.
+ *
+ * A frozen map can be saved with \a fm_save, and rebuilt by \a fm_load from the
+ * same keys without searching the pilots again, e.g. to load a prebuilt table
+ * on startup. Only the function is saved, and the position of each key: the
+ * keys and values are pointers, which the user gives again. The data is in the
+ * byte order of the machine it was saved on.
+ *
+ * The functions \a fm_new and \a fm_load set the variable \a errno to describe
+ * their state:
+ * - \c 0 if the execution proceeded nominally,
+ * - \c ENOMEM if a memory allocation failed,
+ * - \c EINVAL if two keys have the same hash, if there are \c 2^32 keys or
+ *   more, or if the data given to \a fm_load does not describe the keys.
+ */
+
+#ifndef CODS_FROZENMAP_H
+#define CODS_FROZENMAP_H
+
+
+#include <stdbool.h>
+#include <stddef.h> /* for size_t */
+#include <stdlib.h> /* for NULL */
+
+#include "cods.h" /* for func attrs, data_t */
+
+
+
+/** An immutable map indexed by a perfect hash function. */
+typedef struct frozenmap FrozenMap;
+
+
+/**
+ * \brief Creates a frozen map from a set of keys and their values.
+ *
+ * \param[in] keys   The keys, all distinct
+ * \param[in] values The value of each key
+ * \param[in] n      The number of keys
+ * \param[in] hash   The hash function of the keys
+ * \param[in] cmp    The comparison function of the keys
+ *
+ * \return A newly-allocated FrozenMap, or \c NULL on error.
+ */
+CODS_CTOR FrozenMap *fm_new(data_t *const keys[], data_t *const values[],
+                            size_t n, size_t (*hash)(const data_t*),
+                            int (*cmp)(const data_t*, const data_t*))
+CODS_NOTNULL(4, 5);
+
+/**
+ * \brief Releases memory of a frozen map.
+ *
+ * \note The keys and values themselves are not freed.
+ *
+ * \param[in,out] self The frozen map
+ */
+CODS_MEMBER void fm_free(FrozenMap *self);
+
+/**
+ * \brief Retrieves the number of keys in the frozen map.
+ *
+ * \param[in] self The frozen map
+ *
+ * \return The number of keys.
+ */
+CODS_MEMBER size_t fm_size(const FrozenMap *self) CODS_PURE;
+
+/**
+ * \brief Retrieves the value mapped to a key in the frozen map.
+ *
+ * \param[in] self The frozen map
+ * \param[in] key  The key
+ *
+ * \return The value bound to the given key, or \c NULL if the key is not
+ *         present.
+ */
+CODS_MEMBER data_t *fm_get(const FrozenMap *self, const data_t *key) CODS_PURE;
+
+/**
+ * \brief Convenience function to get a value from the frozen map or a default
+ *        one if not present.
+ *
+ * \param[in] self  The frozen map
+ * \param[in] key   The key
+ * \param[in] d_val The default value
+ *
+ * \return The value bound to the given key, or the default value.
+ */
+CODS_MEMBER CODS_INLINE
+data_t *fm_getd(const FrozenMap *const self, const data_t *const key,
+                data_t *const d_val) {
+	data_t *const value = fm_get(self, key);
+	return value == NULL ? d_val : value;
+}
+
+/**
+ * \brief Checks whether a key is present in the frozen map.
+ *
+ * \param[in] self The frozen map
+ * \param[in] key  The key
+ *
+ * \return \c true if the key has a mapping in the instance.
+ */
+CODS_MEMBER bool fm_contains(const FrozenMap *self, const data_t *key)
+CODS_PURE;
+
+/**
+ * \brief Saves the hash function of the frozen map and the position of its
+ *        keys.
+ *
+ * \param[in]  self   The frozen map
+ * \param[out] buffer The buffer to write the data into, or \c NULL
+ * \param[in]  size   The size of the buffer, in bytes
+ *
+ * \return The size of the data, in bytes; nothing is written if it is greater
+ *         than \a size.
+ */
+CODS_MEMBER size_t fm_save(const FrozenMap *self, void *buffer, size_t size);
+
+/**
+ * \brief Rebuilds a frozen map saved by \a fm_save, from the same keys.
+ *
+ * The keys are checked to be at the positions the function gives them, in
+ * \c O(n) time, without searching the function again.
+ *
+ * \param[in] data   The data written by \a fm_save
+ * \param[in] size   The size of the data, in bytes
+ * \param[in] keys   The keys, in the same order as given to \a fm_new
+ * \param[in] values The value of each key
+ * \param[in] n      The number of keys
+ * \param[in] hash   The hash function of the keys
+ * \param[in] cmp    The comparison function of the keys
+ *
+ * \return A newly-allocated FrozenMap, or \c NULL on error.
+ */
+CODS_CTOR FrozenMap *fm_load(const void *data, size_t size,
+                             data_t *const keys[], data_t *const values[],
+                             size_t n, size_t (*hash)(const data_t*),
+                             int (*cmp)(const data_t*, const data_t*))
+CODS_NOTNULL(1, 6, 7);
+
+
+#endif /* CODS_FROZENMAP_H */
@@ -0,0 +1,147 @@
+/**
+ * \file "hashmap.h"
+ * \author joH1
+ * \version 0.1
+ *
+ * \brief A structure mapping keys to values in an open-addressing hash table.
+ *
+ * The HashMap type binds keys to values as ArrayMap does, but without ordering
+ * the keys: each instance is given a hash function and an equality function
+ * for the keys, instead of a comparison function. Placing, finding and
+ * removing a key cost \c O(1) on average, where an ArrayMap searches its keys
+ * in \c O(log n) and shifts its arrays in \c O(n) on each insertion or removal.
+ *
+ * The table follows the design of the SwissTable: the keys and values are
+ * stored in a single array of slots, with no node to allocate, and each slot
+ * has a control byte telling whether it is empty, removed, or holding a key
+ * along with 7 bits of its hash. A search loads the control bytes of a group of
+ * 16 slots at once and compares them with the searched hash in a single SIMD
+ * instruction (SSE2, selected at compilation, or a plain loop otherwise), so
+ * that the keys are only compared when the 7 bits match. The table grows to
+ * keep at least an eighth of its slots empty.
+ *
+ * The hash function needs not be of high quality: its result is mixed before
+ * use. Equal keys must have equal hashes.
+ *
+ * The functions \a hm_new and \a hm_put set the variable \a errno to describe
+ * their state:
+ * - \c 0 if the execution proceeded nominally,
+ * - \c ENOMEM if a memory allocation failed,
+ * - \c EINVAL if the size given to \a hm_new is \c 0.
+ */
+
+#ifndef CODS_HASHMAP_H
+#define CODS_HASHMAP_H
+
+
+#include <stdbool.h>
+#include <stddef.h> /* for size_t */
+#include <stdlib.h> /* for NULL */
+
+#include "cods.h" /* for func attrs, data_t */
+
+
+
+/** A hash table binding values to unique keys. */
+typedef struct hashmap HashMap;
+
+
+/**
+ * \brief Creates a new hash map.
+ *
+ * \param[in] size  The number of keys the map holds without growing
+ * \param[in] hash  The hash function of the keys
+ * \param[in] equal The equality function of the keys
+ *
+ * \return A newly-allocated HashMap, or \c NULL on error.
+ */
+CODS_CTOR HashMap *hm_new(size_t size, size_t (*hash)(const data_t*),
+                          bool (*equal)(const data_t*, const data_t*))
+CODS_NOTNULL(2, 3);
+
+/**
+ * \brief Releases memory of a hash map.
+ *
+ * \note The keys and values themselves are not freed.
+ *
+ * \param[in,out] self The hash map
+ */
+CODS_MEMBER void hm_free(HashMap *self);
+
+/**
+ * \brief Retrieves the number of keys in the hash map.
+ *
+ * \param[in] self The hash map
+ *
+ * \return The number of keys.
+ */
+CODS_MEMBER size_t hm_size(const HashMap *self) CODS_PURE;
+
+/**
+ * \brief Places a key and its value in the hash map.
+ *
+ * \note If the key is already present in the map, the mapped value is
+ *       overriden.
+ *
+ * \param[in,out] self  The hash map
+ * \param[in]     key   The key
+ * \param[in]     value The value
+ *
+ * \return \c true if the key and the value could be placed, or \c false if any
+ *         error occurred.
+ */
+CODS_MEMBER bool hm_put(HashMap *self, data_t *key, data_t *value);
+
+/**
+ * \brief Retrieves the value mapped to a key in the hash map.
+ *
+ * \param[in] self The hash map
+ * \param[in] key  The key
+ *
+ * \return The value bound to the given key, or \c NULL if the key is not
+ *         present.
+ */
+CODS_MEMBER data_t *hm_get(const HashMap *self, const data_t *key) CODS_PURE;
+
+/**
+ * \brief Convenience function to get a value from the hash map or a default
+ *        one if not present.
+ *
+ * \param[in] self  The hash map
+ * \param[in] key   The key
+ * \param[in] d_val The default value
+ *
+ * \return The value bound to the given key, or the default value.
+ */
+CODS_MEMBER CODS_INLINE
+data_t *hm_getd(const HashMap *const self, const data_t *const key,
+                data_t *const d_val) {
+	data_t *const value = hm_get(self, key);
+	return value == NULL ? d_val : value;
+}
+
+/**
+ * \brief Checks whether a key is present in the hash map.
+ *
+ * \param[in] self The hash map
+ * \param[in] key  The key
+ *
+ * \return \c true if the key has a mapping in the instance.
+ */
+CODS_MEMBER bool hm_contains(const HashMap *self, const data_t *key) CODS_PURE;
+
+/**
+ * \brief Removes a key and its value from the hash map.
+ *
+ * \note If the key is not present, \c NULL is returned and no action is
+ *       performed on the hash map.
+ *
+ * \param[in,out] self The hash map
+ * \param[in]     key  The key
+ *
+ * \return The former value, or \c NULL.
+ */
+CODS_MEMBER data_t *hm_remove(HashMap *self, const data_t *key);
+
+
+#endif /* CODS_HASHMAP_H */
@@ -0,0 +1,203 @@
+/**
+ * \file "intmap.h"
+ * \author joH1
+ * \version 0.1
+ *
+ * \brief A sorted map specialized for integer keys.
+ *
+ * The IntMap type maps 64-bit signed integer keys to values, as ArrayMap maps
+ * generic keys. The keys are stored by value, sorted, in a contiguous array
+ * aligned on the cache lines, and compared directly: there is no comparison
+ * function to call, and no element to dereference during a search. The values
+ * are held in a parallel array. Smaller integer types (\c int, \c int32_t,
+ * ...) can be used as keys by conversion to \c int64_t.
+ *
+ * A search narrows the range of the keys by halves, without branching on the
+ * comparisons, then counts the keys less than the searched one in the last few
+ * cache lines, with SIMD instructions when available (AVX2, selected at
+ * compilation). For keys distributed evenly, the map can instead narrow the
+ * range by interpolation (see \a im_set_interpolation), in \c O(log log n)
+ * steps on average.
+ *
+ * Used with \c NULL values, an IntMap is an ordered set of integers.
+ *
+ * The functions \a im_new, \a im_put, \a im_put_sorted, \a im_key and
+ * \a im_value set the variable \a errno to describe their state:
+ * - \c 0 if the execution proceeded nominally,
+ * - \c ENOMEM if a memory allocation failed,
+ * - \c EINVAL if the size given to \a im_new is \c 0, or the keys given to
+ *   \a im_put_sorted are not sorted,
+ * - \c ERANGE if an index is greater than, or equal to the size of the map.
+ */
+
+#ifndef CODS_INTMAP_H
+#define CODS_INTMAP_H
+
+
+#include <stdbool.h>
+#include <stddef.h> /* for size_t */
+#include <stdint.h> /* for int64_t */
+#include <stdlib.h> /* for NULL */
+#include <unistd.h> /* for ssize_t */
+
+#include "cods.h" /* for func attrs, data_t */
+
+
+
+/** The integer-keyed map structure. */
+typedef struct intmap IntMap;
+
+
+/**
+ * \brief Creates a new integer-keyed map.
+ *
+ * \param[in] size The initial number of key-value elements
+ *
+ * \return A newly-allocated IntMap, or \c NULL on error.
+ */
+CODS_CTOR IntMap *im_new(size_t size);
+
+/**
+ * \brief Releases memory of an integer-keyed map.
+ *
+ * \param[in,out] self The map
+ */
+CODS_MEMBER void im_free(IntMap *self);
+
+/**
+ * \brief Retrieves the number of keys in the map.
+ *
+ * \param[in] self The map
+ *
+ * \return The number of keys.
+ */
+CODS_MEMBER size_t im_size(const IntMap *self) CODS_PURE;
+
+/**
+ * \brief Chooses how the map narrows the range of the keys during a search.
+ *
+ * By default, the range is halved at each step. With interpolation, the
+ * position of the key is estimated from the values of the keys at both ends of
+ * the range, which takes far fewer steps when the keys are spread evenly; a
+ * step that does not halve the range is followed by a halving one, so that a
+ * search never costs more than twice a binary one.
+ *
+ * \param[in,out] self        The map
+ * \param[in]     interpolate Whether to search by interpolation
+ */
+CODS_MEMBER void im_set_interpolation(IntMap *self, bool interpolate);
+
+/**
+ * \brief Places a key and its value in the map.
+ *
+ * \note If the key is already present in the map, the mapped value is
+ *       overriden.
+ *
+ * \param[in,out] self  The map
+ * \param[in]     key   The key
+ * \param[in]     value The value, may be \c NULL
+ *
+ * \return \c true if the key and the value could be placed, or \c false if any
+ *         error occurred.
+ */
+CODS_MEMBER bool im_put(IntMap *self, int64_t key, data_t *value);
+
+/**
+ * \brief Places a batch of sorted keys and their values in the map.
+ *
+ * The batch is merged with the keys of the map in a single pass from the end,
+ * moving the keys of the map by whole runs: the cost is dominated by copying
+ * memory, instead of the one shift per key of \a im_put.
+ *
+ * \note The keys already present in the map have their values overriden.
+ *
+ * \param[in,out] self   The map
+ * \param[in]     keys   The keys, in strictly increasing order
+ * \param[in]     values The values of the keys
+ * \param[in]     n      The number of keys
+ *
+ * \return \c true if the keys and the values could be placed, or \c false if
+ *         any error occurred; the map is then left unchanged.
+ */
+CODS_MEMBER bool im_put_sorted(IntMap *self, const int64_t keys[],
+                               data_t *const values[], size_t n)
+CODS_NOTNULL(2, 3);
+
+/**
+ * \brief Retrieves the value mapped to a key in the map.
+ *
+ * \param[in] self The map
+ * \param[in] key  The key
+ *
+ * \return The value bound to the given key, or \c NULL if the key is not
+ *         present.
+ */
+CODS_MEMBER data_t *im_get(const IntMap *self, int64_t key) CODS_PURE;
+
+/**
+ * \brief Checks whether a key is present in the map.
+ *
+ * \param[in] self The map
+ * \param[in] key  The key
+ *
+ * \return \c true if the key has a mapping in the instance.
+ */
+CODS_MEMBER bool im_contains(const IntMap *self, int64_t key) CODS_PURE;
+
+/**
+ * \brief Retrieves the index of a key in the map.
+ *
+ * \param[in] self The map
+ * \param[in] key  The key
+ *
+ * \return The index of the key in the sorted keys, or \c -1 if not present.
+ */
+CODS_MEMBER ssize_t im_indexof(const IntMap *self, int64_t key) CODS_PURE;
+
+/**
+ * \brief Retrieves the index of the first key of the map not less than the
+ *        given one.
+ *
+ * \param[in] self The map
+ * \param[in] key  The key
+ *
+ * \return The index of the first key not less than \a key, or the size of the
+ *         map if all the keys are less.
+ */
+CODS_MEMBER size_t im_lower_bound(const IntMap *self, int64_t key) CODS_PURE;
+
+/**
+ * \brief Retrieves a key of the map by its index.
+ *
+ * \param[in] self  The map
+ * \param[in] index The index
+ *
+ * \return The key at given index, or \c 0 if the index is invalid.
+ */
+CODS_MEMBER int64_t im_key(const IntMap *self, size_t index) CODS_PURE;
+
+/**
+ * \brief Retrieves a value of the map by the index of its key.
+ *
+ * \param[in] self  The map
+ * \param[in] index The index
+ *
+ * \return The value at given index, or \c NULL if the index is invalid.
+ */
+CODS_MEMBER data_t *im_value(const IntMap *self, size_t index) CODS_PURE;
+
+/**
+ * \brief Removes a key and its value from the map.
+ *
+ * \note If the key is not present, \c NULL is returned and no action is
+ *       performed on the map.
+ *
+ * \param[in,out] self The map
+ * \param[in]     key  The key
+ *
+ * \return The former value, or \c NULL.
+ */
+CODS_MEMBER data_t *im_remove(IntMap *self, int64_t key);
+
+
+#endif /* CODS_INTMAP_H */
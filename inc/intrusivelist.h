@@ -0,0 +1,247 @@
+/**
+ * \file "intrusivelist.h"
+ * \author joH1
+ * \version 0.1
+ *
+ * \brief A doubly-linked list whose links are embedded in the elements.
+ *
+ * In the contrary of LinkedList, which allocates a node for each element it
+ * holds, the IntrusiveList type does not allocate any memory: the user embeds
+ * an IntrusiveNode member in their own structure, and it is this member that
+ * is linked into the list. The enclosing element is retrieved from the node
+ * with the macro \a IL_ENTRY.
+ *
+ * Since an element knows its own links, inserting, removing or moving an
+ * element in the list are all constant-time operations, without any search.
+ *
+ * The list is circular, around a sentinel node held by the list structure
+ * itself; for this reason both structures are defined in this header, so that
+ * they can be declared as automatic or static variables or embedded in other
+ * structures. Their members are however to be considered private.
+ *
+ * A node can only be in one list at a time; a node not in any list is
+ * \e unlinked, which can be checked with \a il_linked. An element must be
+ * removed from its list before it is freed.
+ */
+
+#ifndef CODS_INTRUSIVELIST_H
+#define CODS_INTRUSIVELIST_H
+
+
+#include <stdbool.h>
+#include <stddef.h> /* for size_t, offsetof */
+
+#include "cods.h" /* for function attrs */
+
+
+
+/** The link to embed in the elements of an intrusive list. */
+typedef struct intrusivenode IntrusiveNode;
+
+struct intrusivenode {
+	IntrusiveNode *prev; /**< The previous node, or \c NULL if unlinked */
+	IntrusiveNode *next; /**< The next node, or \c NULL if unlinked */
+};
+
+/** The intrusive doubly-linked list. */
+typedef struct intrusivelist IntrusiveList;
+
+struct intrusivelist {
+	IntrusiveNode head; /**< The sentinel node, linking the ends of the list */
+	size_t len;         /**< The number of nodes in the list */
+};
+
+
+/**
+ * \brief Retrieves the element enclosing a node.
+ *
+ * \param[in] node   A pointer to the node
+ * \param[in] type   The type of the enclosing element
+ * \param[in] member The name of the node member in \a type
+ *
+ * \return A pointer to the element of type \a type that contains \a node.
+ */
+#define IL_ENTRY(node, type, member) \
+	((type*)((char*)(node) - offsetof(type, member)))
+
+
+/**
+ * \brief Initializes an empty intrusive list.
+ *
+ * \param[out] self The list to initialize
+ */
+CODS_MEMBER void il_init(IntrusiveList *self);
+
+/**
+ * \brief Marks a node as unlinked.
+ *
+ * \note Calling this function on a node before inserting it is not mandatory,
+ *       but it is required for \a il_linked to give a meaningful result.
+ *
+ * \param[out] node The node to initialize
+ */
+CODS_NOTNULL(1) void il_node_init(IntrusiveNode *node);
+
+/**
+ * \brief Checks whether a node is currently in a list.
+ *
+ * \param[in] node The node
+ *
+ * \return \c true if the node has been inserted in a list and not removed
+ *         since.
+ */
+CODS_NOTNULL(1) CODS_INLINE CODS_PURE
+bool il_linked(const IntrusiveNode *const node) {
+	return node->next != NULL;
+}
+
+
+/**
+ * \brief Returns the number of nodes in the list.
+ *
+ * \param[in] self The list
+ *
+ * \return The length of the list.
+ */
+CODS_MEMBER size_t il_len(const IntrusiveList *self) CODS_PURE;
+
+
+/**
+ * \brief Retrieves the first node of the list.
+ *
+ * \param[in] self The list
+ *
+ * \return The first node, or \c NULL if the list is empty.
+ */
+CODS_MEMBER IntrusiveNode *il_first(const IntrusiveList *self) CODS_PURE;
+
+/**
+ * \brief Retrieves the last node of the list.
+ *
+ * \param[in] self The list
+ *
+ * \return The last node, or \c NULL if the list is empty.
+ */
+CODS_MEMBER IntrusiveNode *il_last(const IntrusiveList *self) CODS_PURE;
+
+/**
+ * \brief Retrieves the node following another in the list.
+ *
+ * \param[in] self The list
+ * \param[in] node A node of the list
+ *
+ * \return The next node, or \c NULL if \a node is the last one.
+ */
+CODS_MEMBER IntrusiveNode *il_next(const IntrusiveList *self,
+                                   const IntrusiveNode *node)
+CODS_NOTNULL(2) CODS_PURE;
+
+/**
+ * \brief Retrieves the node preceding another in the list.
+ *
+ * \param[in] self The list
+ * \param[in] node A node of the list
+ *
+ * \return The previous node, or \c NULL if \a node is the first one.
+ */
+CODS_MEMBER IntrusiveNode *il_prev(const IntrusiveList *self,
+                                   const IntrusiveNode *node)
+CODS_NOTNULL(2) CODS_PURE;
+
+
+/**
+ * \brief Inserts an unlinked node before a node of the list.
+ *
+ * \param[in,out] self     The list
+ * \param[in,out] position The node of the list before which to insert
+ * \param[in,out] node     The node to insert
+ */
+CODS_MEMBER void il_insert_before(IntrusiveList *self, IntrusiveNode *position,
+                                  IntrusiveNode *node) CODS_NOTNULL(2, 3);
+
+/**
+ * \brief Inserts an unlinked node after a node of the list.
+ *
+ * \param[in,out] self     The list
+ * \param[in,out] position The node of the list after which to insert
+ * \param[in,out] node     The node to insert
+ */
+CODS_MEMBER void il_insert_after(IntrusiveList *self, IntrusiveNode *position,
+                                 IntrusiveNode *node) CODS_NOTNULL(2, 3);
+
+/**
+ * \brief Inserts an unlinked node at the head of the list.
+ *
+ * \param[in,out] self The list
+ * \param[in,out] node The node to insert
+ */
+CODS_MEMBER CODS_INLINE CODS_NOTNULL(2)
+void il_push_front(IntrusiveList *const self, IntrusiveNode *const node) {
+	il_insert_after(self, &self->head, node);
+}
+
+/**
+ * \brief Inserts an unlinked node at the end of the list.
+ *
+ * \param[in,out] self The list
+ * \param[in,out] node The node to insert
+ */
+CODS_MEMBER CODS_INLINE CODS_NOTNULL(2)
+void il_push_back(IntrusiveList *const self, IntrusiveNode *const node) {
+	il_insert_before(self, &self->head, node);
+}
+
+
+/**
+ * \brief Removes a node from the list.
+ *
+ * \note The node is left unlinked; the enclosing element is not freed.
+ *
+ * \param[in,out] self The list
+ * \param[in,out] node The node to remove
+ */
+CODS_MEMBER void il_remove(IntrusiveList *self, IntrusiveNode *node)
+CODS_NOTNULL(2);
+
+/**
+ * \brief Removes the first node of the list.
+ *
+ * \param[in,out] self The list
+ *
+ * \return The node just removed, or \c NULL if the list is empty.
+ */
+CODS_MEMBER IntrusiveNode *il_pop_front(IntrusiveList *self);
+
+/**
+ * \brief Removes the last node of the list.
+ *
+ * \param[in,out] self The list
+ *
+ * \return The node just removed, or \c NULL if the list is empty.
+ */
+CODS_MEMBER IntrusiveNode *il_pop_back(IntrusiveList *self);
+
+
+/**
+ * \brief Moves a node of the list to its head.
+ *
+ * This is the operation to perform on an element of a \e least recently used
+ * list, when it is accessed.
+ *
+ * \param[in,out] self The list
+ * \param[in,out] node The node to move
+ */
+CODS_MEMBER void il_move_front(IntrusiveList *self, IntrusiveNode *node)
+CODS_NOTNULL(2);
+
+/**
+ * \brief Moves a node of the list to its end.
+ *
+ * \param[in,out] self The list
+ * \param[in,out] node The node to move
+ */
+CODS_MEMBER void il_move_back(IntrusiveList *self, IntrusiveNode *node)
+CODS_NOTNULL(2);
+
+
+#endif /* CODS_INTRUSIVELIST_H */
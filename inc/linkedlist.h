@@ -158,4 +158,59 @@ int ll_append(LinkedList *self, data_t *item) {
 CODS_MEMBER data_t *ll_drop(LinkedList *self, size_t index);
 
 
+/**
+ * \brief Sorts the elements of the linked list, in place.
+ *
+ * The sort is a bottom-up merge sort: it only relinks the nodes of the list,
+ * no memory is allocated, and the relative order of equivalent elements is
+ * preserved (the sort is stable). It runs in \c O(n log n) time.
+ *
+ * The comparison function follows the same specifications as for SortedArray:
+ * it returns a negative value if its first argument is inferior to the second,
+ * a positive value if it is superior, and \c 0 if they are equivalent.
+ *
+ * \param[in,out] self The linked list
+ * \param[in]     cmp  The comparison function
+ */
+CODS_MEMBER void ll_sort(LinkedList *self,
+                         int (*cmp)(const data_t*, const data_t*))
+CODS_NOTNULL(2);
+
+
+/**
+ * \brief Moves all the elements of a linked list into another, before given
+ *        \a index.
+ *
+ * The nodes of \a other are relinked into \a self, no memory is allocated;
+ * \a other is left empty, but not freed. The operation costs the walk to
+ * \a index in \a self, and is constant-time at the head or the end of the list.
+ *
+ * \note Sets \a errno to \c ERANGE if \a index is greater than the length of
+ *       \a self, or to \c EINVAL if both lists are the same; in these cases no
+ *       element is moved.
+ *
+ * \param[in,out] self  The linked list to insert the elements into
+ * \param[in]     index The index where to insert the elements
+ * \param[in,out] other The linked list to take the elements from
+ */
+CODS_MEMBER void ll_splice(LinkedList *self, size_t index, LinkedList *other)
+CODS_NOTNULL(3);
+
+/**
+ * \brief Moves all the elements of a linked list at the end of another.
+ *
+ * \note This operation is performed in constant time, and leaves \a other
+ *       empty.
+ *
+ * \param[in,out] self  The linked list to append the elements to
+ * \param[in,out] other The linked list to take the elements from
+ *
+ * \sa ll_splice
+ */
+CODS_MEMBER CODS_INLINE CODS_NOTNULL(2)
+void ll_concat(LinkedList *const self, LinkedList *const other) {
+	ll_splice(self, ll_len(self), other);
+}
+
+
 #endif /* LINKEDLIST_H */
@@ -0,0 +1,243 @@
+/**
+ * \file "persistentvector.h"
+ * \author joH1
+ * \version 0.1
+ *
+ * \brief An immutable dynamic array, whose versions share their structure.
+ *
+ * The PersistentVector type holds a sequence of elements, as Array does, but
+ * is never modified: setting, appending or removing an element gives a new
+ * version of the vector, and leaves the former one unchanged. Keeping a version
+ * of a vector, e.g. as a snapshot to roll back to, thus costs \c O(1)
+ * (\a pv_copy) instead of a copy of all the elements.
+ *
+ * The elements are stored in a trie of nodes of 32 slots, whose leaves hold
+ * the elements in order, and whose inner nodes index their children by 5 bits
+ * of the index of an element, so that a vector of \c n elements has a depth of
+ * \c log32(n): 4 levels for a million elements. The last elements are kept
+ * apart, in a \e tail node, so that most appends only touch the tail. A new
+ * version copies the nodes on the path to the element it changes, i.e. about
+ * \c 32 \c log32(n) pointers, and shares all the others with the former one;
+ * the nodes are reference counted, and freed with the last version using them.
+ *
+ * A \e transient (PVTransient) is a private, mutable view of a version, for
+ * making many changes at once: it copies a node on its first change only, and
+ * changes the nodes it owns in place afterwards. It is then published as a new
+ * version with \a pv_persistent, in \c O(1). The persistent functions are
+ * themselves a single change made through a transient.
+ *
+ * \note The reference counts are not atomic: the versions sharing nodes must
+ *       not be created nor freed by several threads at once.
+ *
+ * The functions that create a version or a transient, or change a transient,
+ * set the variable \a errno to describe their state:
+ * - \c 0 if the execution proceeded nominally,
+ * - \c ENOMEM if a memory allocation failed,
+ * - \c ERANGE if an index is not lower than the size of the vector, or an
+ *   element is removed from an empty vector.
+ */
+
+#ifndef CODS_PERSISTENTVECTOR_H
+#define CODS_PERSISTENTVECTOR_H
+
+
+#include <stdbool.h>
+#include <stddef.h> /* for size_t */
+#include <stdlib.h> /* for NULL */
+
+#include "array.h" /* for Array */
+#include "cods.h" /* for func attrs, data_t */
+
+
+
+/** An immutable dynamic array. */
+typedef struct persistentvector PersistentVector;
+
+/** A mutable view of a persistent vector, made for batches of changes. */
+typedef struct pvtransient PVTransient;
+
+
+/**
+ * \brief Creates a new, empty persistent vector.
+ *
+ * \return A newly-allocated PersistentVector, or \c NULL on error.
+ */
+CODS_CTOR PersistentVector *pv_new(void);
+
+/**
+ * \brief Creates a persistent vector holding the elements of an array.
+ *
+ * \param[in] array The array
+ *
+ * \return A newly-allocated PersistentVector, or \c NULL on error.
+ */
+CODS_CTOR PersistentVector *pv_from_array(const Array *array) CODS_NOTNULL(1);
+
+/**
+ * \brief Releases memory of a version of a persistent vector.
+ *
+ * The nodes it shares with other versions are kept for them.
+ *
+ * \note The elements themselves are not freed.
+ *
+ * \param[in,out] self The persistent vector
+ */
+CODS_MEMBER void pv_free(PersistentVector *self);
+
+/**
+ * \brief Gives another handle on a version of a persistent vector, in
+ *        \c O(1).
+ *
+ * \param[in] self The persistent vector
+ *
+ * \return A newly-allocated PersistentVector, equal to \a self and to be freed
+ *         on its own, or \c NULL on error.
+ */
+CODS_MEMBER CODS_CTOR PersistentVector *pv_copy(const PersistentVector *self);
+
+/**
+ * \brief Retrieves the number of elements of a persistent vector.
+ *
+ * \param[in] self The persistent vector
+ *
+ * \return The number of elements.
+ */
+CODS_MEMBER size_t pv_size(const PersistentVector *self) CODS_PURE;
+
+/**
+ * \brief Retrieves an element of a persistent vector from its index.
+ *
+ * \note If the index is not lower than the size of the vector, \a errno is set
+ *       to \c ERANGE and \c NULL is returned.
+ *
+ * \param[in] self  The persistent vector
+ * \param[in] index The index
+ *
+ * \return The \a index 'th element of the vector, or \c NULL.
+ */
+CODS_MEMBER data_t *pv_get(const PersistentVector *self, size_t index)
+CODS_PURE;
+
+/**
+ * \brief Gives a version of a persistent vector with an element replaced.
+ *
+ * \param[in] self    The persistent vector
+ * \param[in] index   The index of the element
+ * \param[in] element The new element
+ *
+ * \return A newly-allocated PersistentVector, or \c NULL on error.
+ */
+CODS_MEMBER CODS_CTOR PersistentVector *pv_set(const PersistentVector *self,
+                                               size_t index, data_t *element);
+
+/**
+ * \brief Gives a version of a persistent vector with an element appended.
+ *
+ * \param[in] self    The persistent vector
+ * \param[in] element The element
+ *
+ * \return A newly-allocated PersistentVector, or \c NULL on error.
+ */
+CODS_MEMBER CODS_CTOR PersistentVector *pv_push(const PersistentVector *self,
+                                                data_t *element);
+
+/**
+ * \brief Gives a version of a persistent vector without its last element.
+ *
+ * \param[in] self The persistent vector
+ *
+ * \return A newly-allocated PersistentVector, or \c NULL on error.
+ */
+CODS_MEMBER CODS_CTOR PersistentVector *pv_pop(const PersistentVector *self);
+
+/**
+ * \brief Creates a transient from a version of a persistent vector.
+ *
+ * The version is left unchanged by the changes to the transient.
+ *
+ * \param[in] self The persistent vector
+ *
+ * \return A newly-allocated PVTransient, or \c NULL on error.
+ */
+CODS_MEMBER CODS_CTOR PVTransient *pv_transient(const PersistentVector *self);
+
+/**
+ * \brief Publishes the changes of a transient as a new version.
+ *
+ * The transient is consumed: it must not be used nor freed afterwards.
+ *
+ * \param[in,out] self The transient
+ *
+ * \return The new version of the persistent vector.
+ */
+CODS_MEMBER PersistentVector *pv_persistent(PVTransient *self);
+
+/**
+ * \brief Releases memory of a transient, discarding its changes.
+ *
+ * \param[in,out] self The transient
+ */
+CODS_MEMBER void pv_transient_free(PVTransient *self);
+
+/**
+ * \brief Retrieves the number of elements of a transient.
+ *
+ * \param[in] self The transient
+ *
+ * \return The number of elements.
+ */
+CODS_MEMBER size_t pv_transient_size(const PVTransient *self) CODS_PURE;
+
+/**
+ * \brief Retrieves an element of a transient from its index.
+ *
+ * \note If the index is not lower than the size of the transient, \a errno is
+ *       set to \c ERANGE and \c NULL is returned.
+ *
+ * \param[in] self  The transient
+ * \param[in] index The index
+ *
+ * \return The \a index 'th element of the transient, or \c NULL.
+ */
+CODS_MEMBER data_t *pv_transient_get(const PVTransient *self, size_t index)
+CODS_PURE;
+
+/**
+ * \brief Replaces an element of a transient.
+ *
+ * \param[in,out] self    The transient
+ * \param[in]     index   The index of the element
+ * \param[in]     element The new element
+ *
+ * \return \c true if the element was replaced; on error, the elements of the
+ *         transient are left unchanged.
+ */
+CODS_MEMBER bool pv_transient_set(PVTransient *self, size_t index,
+                                  data_t *element);
+
+/**
+ * \brief Appends an element to a transient.
+ *
+ * \param[in,out] self    The transient
+ * \param[in]     element The element
+ *
+ * \return \c true if the element was appended; on error, the elements of the
+ *         transient are left unchanged.
+ */
+CODS_MEMBER bool pv_transient_push(PVTransient *self, data_t *element);
+
+/**
+ * \brief Removes the last element of a transient.
+ *
+ * \note Since an element may be \c NULL, the user is advised to check the
+ *       value of \e errno on \c NULL returned.
+ *
+ * \param[in,out] self The transient
+ *
+ * \return The removed element, or \c NULL on error; the elements of the
+ *         transient are then left unchanged.
+ */
+CODS_MEMBER data_t *pv_transient_pop(PVTransient *self);
+
+
+#endif /* CODS_PERSISTENTVECTOR_H */
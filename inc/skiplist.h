@@ -0,0 +1,150 @@
+/**
+ * \file "skiplist.h"
+ * \author joH1
+ * \version 0.1
+ *
+ * \brief An ordered set implemented as an indexable skip list.
+ *
+ * The SkipList type stores its elements sorted with a comparison function, in
+ * the same manner as SortedArray, and offers the same interface. However where
+ * a SortedArray has to shift the tail of its array on each insertion or
+ * deletion, a skip list only relinks a few nodes: inserting, removing, finding
+ * an element or accessing it by its index (its \e rank in the order of the
+ * set) are all performed in \c O(log n) expected time.
+ *
+ * Each link of the list also records the number of elements it skips over,
+ * which is what allows an element to be accessed by its index.
+ *
+ * The nodes are allocated from a pool owned by the list: memory is requested by
+ * large chunks, and the nodes of the removed elements are recycled by the
+ * following insertions. The whole pool is released at once by \a sl_free.
+ *
+ * The comparison function follows the specifications given for SortedArray;
+ * in particular, the skip list does not contain two equivalent elements.
+ *
+ * The functions \a sl_new, \a sl_get and \a sl_drop set the variable \a errno
+ * to describe their state:
+ * - \c 0 if the execution proceeded nominally,
+ * - \c ENOMEM if a memory allocation failed,
+ * - \c EINVAL if the size given to \a sl_new is \c 0,
+ * - \c ERANGE if an index is greater than, or equal to the size of the list.
+ */
+
+#ifndef CODS_SKIPLIST_H
+#define CODS_SKIPLIST_H
+
+
+#include <stddef.h> /* for size_t */
+#include <stdlib.h> /* for NULL */
+#include <unistd.h> /* for ssize_t */
+
+#include "cods.h" /* for func attrs, data_t */
+
+
+
+/** The indexable skip list structure. */
+typedef struct skiplist SkipList;
+
+
+/**
+ * \brief Creates a new, empty skip list.
+ *
+ * \param[in] size The number of elements to preallocate nodes for
+ * \param[in] cmp  The comparison function
+ *
+ * \return A newly allocated instance of SkipList, or \c NULL on error.
+ */
+CODS_CTOR
+SkipList *sl_new(size_t size, int (*cmp)(const data_t*, const data_t*))
+CODS_NOTNULL(2);
+
+/**
+ * \brief Deallocates a skip list, and all of its nodes.
+ *
+ * \note The elements themselves are not freed.
+ *
+ * \param[in,out] self The skip list
+ */
+CODS_MEMBER void sl_free(SkipList *self);
+
+/**
+ * \brief Retrieves the size of the skip list.
+ *
+ * \param[in] self The skip list
+ *
+ * \return The number of elements in the skip list.
+ */
+CODS_MEMBER size_t sl_size(const SkipList *self) CODS_PURE;
+
+/**
+ * \brief Adds an element in the skip list.
+ *
+ * \note If the list already contains an element equivalent to the given value,
+ *       the function does not add the element and returns \c -1.
+ *
+ * \param[in,out] self The skip list
+ * \param[in]     item The element, may be \c NULL
+ *
+ * \return The index of the element in the list, or \c -1 on error.
+ */
+CODS_MEMBER ssize_t sl_add(SkipList *self, data_t *item);
+
+/**
+ * \brief Retrieves an element in the skip list by its index.
+ *
+ * \note Since an element may be \c NULL, the user is advised to check the value
+ *       of \e errno on \c NULL returned to ensure that the value truly
+ *       indicates an error.
+ *
+ * \param[in] self  The skip list
+ * \param[in] index The index
+ *
+ * \return The element at given index in the list, or \c NULL if the index is
+ *         invalid.
+ */
+CODS_MEMBER data_t *sl_get(const SkipList *self, size_t index) CODS_PURE;
+
+/**
+ * \brief Retrieves the index of an equivalent element in the skip list.
+ *
+ * \param[in] self  The skip list
+ * \param[in] value The element value
+ *
+ * \return The index of the equivalent element, or \c -1 if none matches.
+ */
+CODS_MEMBER ssize_t sl_indexof(const SkipList *self, const data_t *value)
+CODS_PURE;
+
+/**
+ * \brief Retrieves in the skip list an element equivalent to the given one.
+ *
+ * \param[in] self  The skip list
+ * \param[in] other The equivalent element
+ *
+ * \return The element equivalent to the given one, or \c NULL if none matches.
+ */
+CODS_MEMBER data_t *sl_geteq(const SkipList *self, const data_t *other)
+CODS_PURE;
+
+/**
+ * \brief Removes an element from the skip list, by its index.
+ *
+ * \param[in,out] self  The skip list
+ * \param[in]     index The index of the element
+ *
+ * \return The value just removed, or \c NULL on error.
+ */
+CODS_MEMBER data_t *sl_drop(SkipList *self, size_t index);
+
+/**
+ * \brief Removes an element in the skip list equivalent to the given value.
+ *
+ * \param[in,out] self  The skip list
+ * \param[in]     other The equivalent element
+ *
+ * \return The element just removed, or \c NULL if none matches.
+ */
+CODS_MEMBER data_t *sl_remove(SkipList *self, const data_t *other);
+
+
+#endif /* CODS_SKIPLIST_H */
@@ -25,7 +25,9 @@
 #define CODS_SORTEDARRAY_H
 
 
+#include <stdbool.h>
 #include <stddef.h> /* for size_t */
+#include <stdint.h> /* for uint64_t */
 #include <stdlib.h> /* for NULL */
 #include <unistd.h> /* for ssize_t */
 
@@ -48,6 +50,39 @@ CODS_CTOR
 SortedArray *sa_new(size_t size, int (*cmp)(const data_t*, const data_t*))
 CODS_NOTNULL(2);
 
+/**
+ * \brief Creates a new sorted array of given capacity, that caches a key
+ *        prefix of each element.
+ *
+ * The prefix function maps an element to an unsigned integer that preserves
+ * the order of the elements: if an element is less than another one, its prefix
+ * must be less than or equal to the prefix of the other, and two equivalent
+ * elements must have the same prefix. For instance, the prefix of a signed
+ * integer \c x can be <tt>(uint64_t)x ^ (UINT64_C(1) << 63)</tt>, and the
+ * prefix of a string its first 8 bytes read in big-endian order.
+ *
+ * The array stores the prefix of each element apart from the elements, and the
+ * searches compare the prefixes first, without dereferencing the elements nor
+ * calling the comparison function; the latter is only called among the elements
+ * whose prefix equals the one of the searched value. The more distinct the
+ * prefixes, the fewer elements have to be compared.
+ *
+ * The prefix function is called once for each element added or searched.
+ * While the array is frozen (see \a sa_freeze), the searches use the frozen
+ * layout instead.
+ *
+ * \param[in] size   The initial size of the sorted array
+ * \param[in] cmp    The comparison function
+ * \param[in] prefix The key prefix function
+ *
+ * \return A newly allocated instance of SortedArray, or \c NULL on error.
+ */
+CODS_CTOR
+SortedArray *sa_new_prefixed(size_t size,
+                             int (*cmp)(const data_t*, const data_t*),
+                             uint64_t (*prefix)(const data_t*))
+CODS_NOTNULL(2, 3);
+
 /**
  * \brief Deallocates a sorted array.
  *
@@ -103,6 +138,28 @@ CODS_MEMBER data_t *sa_get(const SortedArray *self, size_t index) CODS_PURE;
 CODS_MEMBER ssize_t sa_indexof(const SortedArray *self, const data_t *value)
 CODS_PURE;
 
+/**
+ * \brief Retrieves the indices of the elements equivalent to a batch of values.
+ *
+ * This is equivalent to calling \a sa_indexof for each value, but faster:
+ * - if the values are sorted, and numerous enough for consecutive values to be
+ *   close in the array, the array is walked once, from each value to the next
+ *   by galloping (exponential search);
+ * - otherwise, the values are searched by groups, the binary searches of a
+ *   group advancing together so that their cache misses overlap.
+ *
+ * \param[in]  self    The sorted array
+ * \param[in]  values  The values to search
+ * \param[in]  n       The number of values
+ * \param[out] indices The index of the element equivalent to each value, or
+ *                     \c -1 if none matches
+ *
+ * \return The number of values found.
+ */
+CODS_MEMBER size_t sa_indexof_many(const SortedArray *self,
+                                   data_t *const values[], size_t n,
+                                   ssize_t indices[]) CODS_NOTNULL(2, 4);
+
 /**
  * \brief Retrieves in the sorted array an element equivalent to the given one.
  *
@@ -117,6 +174,70 @@ data_t *sa_geteq(const SortedArray *const self, const data_t *const other) {
 	return index == -1 ? NULL : sa_get(self, index);
 }
 
+/**
+ * \brief Retrieves the index of the first element of the sorted array that is
+ *        not less than the given value.
+ *
+ * \param[in] self  The sorted array
+ * \param[in] value The value to compare the elements with
+ *
+ * \return The index of the first element not less than \a value, or the size
+ *         of the array if all the elements are less.
+ */
+CODS_MEMBER size_t sa_lower_bound(const SortedArray *self, const data_t *value)
+CODS_PURE;
+
+/**
+ * \brief Retrieves the index of the first element of the sorted array that is
+ *        greater than the given value.
+ *
+ * \param[in] self  The sorted array
+ * \param[in] value The value to compare the elements with
+ *
+ * \return The index of the first element greater than \a value, or the size of
+ *         the array if none is greater.
+ */
+CODS_MEMBER size_t sa_upper_bound(const SortedArray *self, const data_t *value)
+CODS_PURE;
+
+/**
+ * \brief Retrieves the range of the elements equivalent to the given value.
+ *
+ * Since the array does not contain two equivalent elements, the range holds
+ * one element at most; it is empty, and starts at the position where the value
+ * would be inserted, if no element matches.
+ *
+ * \param[in]  self  The sorted array
+ * \param[in]  value The value to compare the elements with
+ * \param[out] first The index of the first element of the range
+ * \param[out] last  The index following the last element of the range
+ */
+CODS_MEMBER void sa_equal_range(const SortedArray *self, const data_t *value,
+                                size_t *first, size_t *last)
+CODS_NOTNULL(3, 4);
+
+/**
+ * \brief Applies a function to the elements of the sorted array in a range of
+ *        values, in order.
+ *
+ * The function is applied to each element not less than \a lo and less than
+ * \a hi, in \c O(log n + k) for \a k elements in the range, plus the slots
+ * of the elements lazily removed from it.
+ *
+ * \note The function must not modify the array, nor its elements in a way that
+ *       changes their order.
+ *
+ * \param[in,out] self  The sorted array
+ * \param[in]     lo    The lower bound of the range, included
+ * \param[in]     hi    The upper bound of the range, excluded
+ * \param[in]     apply The function to apply, given an element and \a ctx
+ * \param[in]     ctx   A context passed to the function, may be \c NULL
+ */
+CODS_MEMBER void sa_foreach_range(SortedArray *self, const data_t *lo,
+                                  const data_t *hi,
+                                  void (*apply)(data_t*, void*), void *ctx)
+CODS_NOTNULL(4);
+
 /**
  * \brief Removes an element from the sorted array.
  *
@@ -142,4 +263,284 @@ CODS_MEMBER CODS_INLINE data_t *sa_remove(SortedArray *const self,
 	return index < 0 ? NULL : sa_drop(self, index);
 }
 
+
+/**
+ * \brief Constructs a sorted array from a set of elements in any order.
+ *
+ * The elements are sorted at once, in \c O(n log n) time, instead of being
+ * added one at a time. If several elements are equivalent, only the first in
+ * the order of \a items is kept.
+ *
+ * \note This function sets \a errno to \c EINVAL if \a n is \c 0, or to
+ *       \c ENOMEM if a memory allocation fails; in that case it returns
+ *       \c NULL.
+ *
+ * \param[in] items The elements to fill the sorted array with
+ * \param[in] n     The number of elements
+ * \param[in] cmp   The comparison function
+ *
+ * \return A new instance of SortedArray holding the elements, or \c NULL.
+ */
+CODS_CTOR SortedArray *sa_from_unsorted(data_t *const items[], size_t n,
+                                        int (*cmp)(const data_t*,
+                                                   const data_t*))
+CODS_NOTNULL(1, 3);
+
+/**
+ * \brief Adds a batch of elements in the sorted array.
+ *
+ * The batch is sorted, then merged with the contents of the array in a single
+ * linear pass, which costs \c O(m log m + n) for \a m elements added to an
+ * array of size \a n; adding them one by one would cost \c O(m n).
+ *
+ * The elements equivalent to an element already in the array, or to a previous
+ * element of the batch, are not added. If \a rejected is not \c NULL, these
+ * elements are stored into it, in sorted order; it must be able to hold up to
+ * \a n elements, and the number of elements stored is \a n minus the returned
+ * value.
+ *
+ * \note This function sets \a errno to \c ENOMEM and returns \c -1 if a
+ *       memory allocation fails; in that case the array is left unchanged.
+ *
+ * \param[in,out] self     The sorted array
+ * \param[in]     items    The elements to add
+ * \param[in]     n        The number of elements
+ * \param[out]    rejected The array to store the elements not added, or
+ *                          \c NULL
+ *
+ * \return The number of elements added, or \c -1 on error.
+ */
+CODS_MEMBER ssize_t sa_add_many(SortedArray *self, data_t *const items[],
+                                size_t n, data_t *rejected[]) CODS_NOTNULL(2);
+
+/**
+ * \brief Lays out the sorted array for faster searches.
+ *
+ * The elements are copied in an additional array in the \e Eytzinger order,
+ * i.e. the order of a breadth-first traversal of the implicit binary search
+ * tree: the children of the slot \c k are the slots \c 2k and \c 2k+1. The
+ * first levels of the tree, used by every search, stay in the cache, and the
+ * descent can load the slots a few levels ahead of the comparisons. The
+ * searches (\a sa_indexof, \a sa_geteq, \a sa_remove) then use this layout.
+ *
+ * This is worth it for an array built once and searched many times: any
+ * modification of the array discards the layout, which has to be built again
+ * by another call to this function.
+ *
+ * \note This function sets \a errno to \c ENOMEM and returns \c false if a
+ *       memory allocation fails; the array is still usable in that case.
+ *
+ * \param[in,out] self The sorted array
+ *
+ * \return Whether the layout was built.
+ */
+CODS_MEMBER bool sa_freeze(SortedArray *self);
+
+/**
+ * \brief Discards the layout built by \a sa_freeze, and frees its memory.
+ *
+ * \param[in,out] self The sorted array
+ */
+CODS_MEMBER void sa_thaw(SortedArray *self);
+
+/**
+ * \brief Creates the union of two sorted arrays.
+ *
+ * The set operations (\a sa_union, \a sa_intersection, \a sa_difference and
+ * \a sa_symdiff) create a new sorted array, using the comparison function of
+ * \a a; both arrays must be sorted in the same order. Of two equivalent
+ * elements, the one from \a a is kept.
+ *
+ * When the size of an array is many times the size of the other, each element
+ * of the smaller one is searched in the larger one by galloping (an exponential
+ * search from the position of the previous element): the operation then costs
+ * \c O(m log(n/m)) comparisons for \a m and \a n elements, instead of the
+ * \c O(m + n) of a linear merge, used otherwise or when the larger array has
+ * pending insertions or removals (see \a sa_set_buffer).
+ *
+ * \note These functions set \a errno to \c ENOMEM and return \c NULL if a
+ *       memory allocation fails.
+ *
+ * \param[in] a The first sorted array
+ * \param[in] b The second sorted array
+ *
+ * \return A new sorted array holding the elements of either \a a or \a b, or
+ *         \c NULL on error.
+ */
+CODS_CTOR SortedArray *sa_union(const SortedArray *a, const SortedArray *b)
+CODS_NOTNULL(1, 2);
+
+/**
+ * \brief Creates the intersection of two sorted arrays.
+ *
+ * \param[in] a The first sorted array
+ * \param[in] b The second sorted array
+ *
+ * \return A new sorted array holding the elements of both \a a and \a b, or
+ *         \c NULL on error.
+ *
+ * \see sa_union
+ */
+CODS_CTOR
+SortedArray *sa_intersection(const SortedArray *a, const SortedArray *b)
+CODS_NOTNULL(1, 2);
+
+/**
+ * \brief Creates the difference of two sorted arrays.
+ *
+ * \param[in] a The first sorted array
+ * \param[in] b The second sorted array
+ *
+ * \return A new sorted array holding the elements of \a a not in \a b, or
+ *         \c NULL on error.
+ *
+ * \see sa_union
+ */
+CODS_CTOR
+SortedArray *sa_difference(const SortedArray *a, const SortedArray *b)
+CODS_NOTNULL(1, 2);
+
+/**
+ * \brief Creates the symmetric difference of two sorted arrays.
+ *
+ * \param[in] a The first sorted array
+ * \param[in] b The second sorted array
+ *
+ * \return A new sorted array holding the elements of exactly one of \a a and
+ *         \a b, or \c NULL on error.
+ *
+ * \see sa_union
+ */
+CODS_CTOR SortedArray *sa_symdiff(const SortedArray *a, const SortedArray *b)
+CODS_NOTNULL(1, 2);
+
+/**
+ * \brief Counts the elements of the union of two sorted arrays, without
+ *        creating it.
+ *
+ * The counting functions follow the same algorithms as the set operations, but
+ * allocate nothing; they cannot fail.
+ *
+ * \param[in] a The first sorted array
+ * \param[in] b The second sorted array
+ *
+ * \return The number of elements of either \a a or \a b.
+ */
+CODS_PURE size_t sa_union_count(const SortedArray *a, const SortedArray *b)
+CODS_NOTNULL(1, 2);
+
+/**
+ * \brief Counts the elements of the intersection of two sorted arrays.
+ *
+ * \param[in] a The first sorted array
+ * \param[in] b The second sorted array
+ *
+ * \return The number of elements of both \a a and \a b.
+ */
+CODS_PURE
+size_t sa_intersection_count(const SortedArray *a, const SortedArray *b)
+CODS_NOTNULL(1, 2);
+
+/**
+ * \brief Counts the elements of the difference of two sorted arrays.
+ *
+ * \param[in] a The first sorted array
+ * \param[in] b The second sorted array
+ *
+ * \return The number of elements of \a a not in \a b.
+ */
+CODS_PURE
+size_t sa_difference_count(const SortedArray *a, const SortedArray *b)
+CODS_NOTNULL(1, 2);
+
+/**
+ * \brief Counts the elements of the symmetric difference of two sorted arrays.
+ *
+ * \param[in] a The first sorted array
+ * \param[in] b The second sorted array
+ *
+ * \return The number of elements of exactly one of \a a and \a b.
+ */
+CODS_PURE size_t sa_symdiff_count(const SortedArray *a, const SortedArray *b)
+CODS_NOTNULL(1, 2);
+
+/**
+ * \brief Puts an insert buffer in front of the sorted array, or removes it.
+ *
+ * With an insert buffer, \a sa_add does not shift the tail of the array: the
+ * element goes into a small sorted buffer, and \a sa_drop (hence
+ * \a sa_remove) only marks the elements of the array as removed, or removes
+ * them from the buffer. Once the buffer and the marks reach the given
+ * threshold, they are merged into the array in a single linear pass, which
+ * also compacts the removed elements away. The threshold bounds the cost of
+ * the searches in the buffer: a few hundred is a sensible value.
+ *
+ * The searches and \a sa_get look into both the buffer and the array, and the
+ * indices are those of the elements in the sorted set; \a sa_get then costs
+ * \c O(log t) for a threshold \a t. The set operations read the buffer along
+ * with the array, leaving both unchanged; \a sa_add_many and \a sa_freeze
+ * merge the buffer first.
+ *
+ * \note If a merge fails to allocate memory, \a errno is set to \c ENOMEM,
+ *       and the function that triggered it fails: \a sa_add returns \c -1 and
+ *       \a sa_drop \c NULL. The array and its buffer are left unchanged.
+ *
+ * \param[in,out] self      The sorted array
+ * \param[in]     threshold The number of pending insertions and removals that
+ *                          triggers a merge, or \c 0 to remove the buffer
+ *
+ * \return Whether the buffer could be set.
+ */
+CODS_MEMBER bool sa_set_buffer(SortedArray *self, size_t threshold);
+
+/**
+ * \brief Merges the insert buffer of the sorted array into the array.
+ *
+ * \param[in,out] self The sorted array
+ *
+ * \return Whether the merge succeeded.
+ *
+ * \see sa_set_buffer
+ */
+CODS_MEMBER bool sa_flush(SortedArray *self);
+
+/**
+ * \brief Makes the removals from the sorted array lazy, or eager again.
+ *
+ * With lazy removals, \a sa_drop (hence \a sa_remove) does not shift the tail
+ * of the array: it only marks the element as removed, in a bit array beside
+ * the elements, and the searches skip the marked slots: a removed element is
+ * never read again, so it may be freed as soon as it is returned. An insertion
+ * reuses the slot of a removed element when it falls next to one. Once the
+ * removed elements make the given percentage of the slots, or when
+ * \a sa_compact is called, the array is compacted in a single linear pass.
+ *
+ * The marks are counted by blocks in a Fenwick tree: the element at an index
+ * then costs \c O(log n) more, and so does each step of a search falling on a
+ * marked slot, moved onto the next element not removed.
+ *
+ * \note If an insert buffer is also set, the marks no longer count towards its
+ *       threshold.
+ *
+ * \param[in,out] self    The sorted array
+ * \param[in]     percent The percentage of removed slots that triggers a
+ *                        compaction, in \c 1..100, or \c 0 to compact the
+ *                        array and make the removals eager
+ *
+ * \return Whether the percentage is valid; if not, \a errno is set to
+ *         \c EINVAL.
+ *
+ * \see sa_compact
+ */
+CODS_MEMBER bool sa_set_lazy_drop(SortedArray *self, unsigned percent);
+
+/**
+ * \brief Compacts the removed elements away from the sorted array.
+ *
+ * \param[in,out] self The sorted array
+ *
+ * \see sa_set_lazy_drop
+ */
+CODS_MEMBER void sa_compact(SortedArray *self);
+
 #endif /* CODS_SORTEDARRAY_H */
@@ -0,0 +1,158 @@
+/**
+ * \file "spscqueue.h"
+ * \author joH1
+ * \version 0.1
+ *
+ * \brief A bounded, lock-free queue for one producer and one consumer.
+ *
+ * The SPSCQueue type is a ring buffer of fixed capacity, designed to pass
+ * elements from exactly one \e producer thread to exactly one \e consumer
+ * thread without any lock. The storage is a contiguous array of pointers, as
+ * for FixedArray; the index of the next element to read (the \e head) and the
+ * index of the next slot to write (the \e tail) are kept on separate cache
+ * lines, so that each thread only writes to its own line.
+ *
+ * Only the producer may call \a spsc_push and \a spsc_push_n, and only the
+ * consumer may call \a spsc_pop and \a spsc_pop_n. The synchronization between
+ * the two relies on C11 atomics with acquire/release semantics only.
+ *
+ * The capacity given at creation is rounded up to the next power of two.
+ *
+ * The functions \a spsc_new, \a spsc_push and \a spsc_pop set the variable
+ * \a errno to describe their state:
+ * - \c 0 if the execution proceeded nominally,
+ * - \c ENOMEM if a memory allocation failed (only in \a spsc_new),
+ * - \c EINVAL if the capacity given to \a spsc_new is \c 0, or too large,
+ * - \c EAGAIN if the queue is full (in \a spsc_push) or empty (in
+ *   \a spsc_pop).
+ */
+
+#ifndef CODS_SPSCQUEUE_H
+#define CODS_SPSCQUEUE_H
+
+
+#include <stdbool.h>
+#include <stddef.h> /* for size_t */
+
+#include "cods.h" /* for function attrs, data_t */
+
+
+
+/** The single-producer, single-consumer ring queue. */
+typedef struct spscqueue SPSCQueue;
+
+
+/**
+ * \brief Allocates a new queue able to hold at least \a capacity elements.
+ *
+ * \note This function sets \a errno to \c EINVAL if \a capacity is \c 0 (or
+ *       can not be rounded to a power of two), or to \c ENOMEM if the memory
+ *       allocation fails; in both cases \c NULL is returned.
+ *
+ * \param[in] capacity The minimum number of elements in the queue
+ *
+ * \return A new, empty instance of SPSCQueue, or \c NULL.
+ */
+CODS_CTOR SPSCQueue *spsc_new(size_t capacity);
+
+/**
+ * \brief Deallocates a queue.
+ *
+ * \note The elements still in the queue are not freed.
+ *
+ * \param[in,out] self The queue to free
+ */
+CODS_MEMBER void spsc_free(SPSCQueue *self);
+
+
+/**
+ * \brief Gives the maximum number of elements the queue can hold.
+ *
+ * \param[in] self The queue
+ *
+ * \return The capacity of the queue, a power of two.
+ */
+CODS_MEMBER size_t spsc_capacity(const SPSCQueue *self) CODS_PURE;
+
+/**
+ * \brief Gives the number of elements currently in the queue.
+ *
+ * \note When called while the other thread is working on the queue, the value
+ *       is only a snapshot and may be outdated as soon as it is returned.
+ *
+ * \param[in] self The queue
+ *
+ * \return The number of elements waiting in the queue.
+ */
+CODS_MEMBER size_t spsc_size(const SPSCQueue *self);
+
+
+/**
+ * \brief Appends an element at the tail of the queue.
+ *
+ * \note This function must only be called from the producer thread.
+ *
+ * \note If the queue is full, \a errno is set to \c EAGAIN and \c false is
+ *       returned.
+ *
+ * \param[in,out] self The queue
+ * \param[in]     item The element to push, may be \c NULL
+ *
+ * \return \c true if the element was pushed, \c false if the queue is full.
+ */
+CODS_MEMBER bool spsc_push(SPSCQueue *self, data_t *item);
+
+/**
+ * \brief Appends up to \a n elements at the tail of the queue at once.
+ *
+ * The elements are pushed in order, and made visible to the consumer with a
+ * single synchronization.
+ *
+ * \note This function must only be called from the producer thread.
+ *
+ * \param[in,out] self  The queue
+ * \param[in]     items The elements to push
+ * \param[in]     n     The number of elements in \a items
+ *
+ * \return The number of elements actually pushed, lower than \a n if the queue
+ *         had less than \a n free slots.
+ */
+CODS_MEMBER size_t spsc_push_n(SPSCQueue *self, data_t *const items[],
+                               size_t n) CODS_NOTNULL(2);
+
+
+/**
+ * \brief Removes the element at the head of the queue.
+ *
+ * \note This function must only be called from the consumer thread.
+ *
+ * \note Since an element may be \c NULL, the user is advised to check the value
+ *       of \a errno on \c NULL returned: it is set to \c EAGAIN if the queue is
+ *       empty.
+ *
+ * \param[in,out] self The queue
+ *
+ * \return The oldest element in the queue, or \c NULL if it is empty.
+ */
+CODS_MEMBER data_t *spsc_pop(SPSCQueue *self);
+
+/**
+ * \brief Removes up to \a n elements from the head of the queue at once.
+ *
+ * The elements are stored in \a items in the order they were pushed, and their
+ * slots are released to the producer with a single synchronization.
+ *
+ * \note This function must only be called from the consumer thread.
+ *
+ * \param[in,out] self  The queue
+ * \param[out]    items The array to store the elements into
+ * \param[in]     n     The maximum number of elements to pop
+ *
+ * \return The number of elements actually popped, lower than \a n if the queue
+ *         held less than \a n elements.
+ */
+CODS_MEMBER size_t spsc_pop_n(SPSCQueue *self, data_t *items[], size_t n)
+CODS_NOTNULL(2);
+
+
+#endif /* CODS_SPSCQUEUE_H */
@@ -0,0 +1,170 @@
+/**
+ * \file "stringmap.h"
+ * \author joH1
+ * \version 0.1
+ *
+ * \brief A hash map whose keys are strings interned in a StringPool.
+ *
+ * The StringMap type binds C strings to values, as a HashMap given a string
+ * hash and \c strcmp would, but compares its keys by address: each key is
+ * interned in a StringPool given at creation, and only its interned copy is
+ * stored. Finding the interned copy of a string in the map thus compares no
+ * string, and takes its hash from the pool instead of reading the string.
+ *
+ * The map is an open-addressing table, probed linearly, whose slots hold the
+ * address of the key and its value next to 32 bits of the hash and of the
+ * length of the key. A search for a string that was not interned hashes it
+ * once, then reads the bytes of a key only when its hash and length match, so
+ * that most mismatches are rejected from the slots alone. The table grows to
+ * keep at least a quarter of its slots empty; a removal shifts the following
+ * keys back instead of leaving a tombstone.
+ *
+ * Several maps may share the same pool, which must outlive them.
+ *
+ * The functions \a sm_new and \a sm_put set the variable \a errno to describe
+ * their state:
+ * - \c 0 if the execution proceeded nominally,
+ * - \c ENOMEM if a memory allocation failed,
+ * - \c EINVAL if the size given to \a sm_new is \c 0.
+ */
+
+#ifndef CODS_STRINGMAP_H
+#define CODS_STRINGMAP_H
+
+
+#include <stdbool.h>
+#include <stddef.h> /* for size_t */
+#include <stdlib.h> /* for NULL */
+
+#include "cods.h" /* for func attrs, data_t */
+#include "stringpool.h" /* for StringPool */
+
+
+
+/** A hash table binding values to interned strings. */
+typedef struct stringmap StringMap;
+
+
+/**
+ * \brief Creates a new string map.
+ *
+ * \param[in] size The number of keys the map holds without growing
+ * \param[in] pool The pool to intern the keys in
+ *
+ * \return A newly-allocated StringMap, or \c NULL on error.
+ */
+CODS_CTOR StringMap *sm_new(size_t size, StringPool *pool) CODS_NOTNULL(2);
+
+/**
+ * \brief Releases memory of a string map.
+ *
+ * \note The pool and the values are not freed.
+ *
+ * \param[in,out] self The string map
+ */
+CODS_MEMBER void sm_free(StringMap *self);
+
+/**
+ * \brief Retrieves the number of keys in the string map.
+ *
+ * \param[in] self The string map
+ *
+ * \return The number of keys.
+ */
+CODS_MEMBER size_t sm_size(const StringMap *self) CODS_PURE;
+
+/**
+ * \brief Retrieves the pool the keys of the string map are interned in.
+ *
+ * \param[in] self The string map
+ *
+ * \return The pool given at creation.
+ */
+CODS_MEMBER StringPool *sm_pool(const StringMap *self) CODS_PURE;
+
+/**
+ * \brief Places a key and its value in the string map, interning the key.
+ *
+ * \note If the key is already present in the map, the mapped value is
+ *       overriden.
+ *
+ * \param[in,out] self  The string map
+ * \param[in]     key   The key, terminated by a null byte
+ * \param[in]     value The value
+ *
+ * \return \c true if the key and the value could be placed, or \c false if any
+ *         error occurred.
+ */
+CODS_MEMBER bool sm_put(StringMap *self, const char *key, data_t *value)
+CODS_NOTNULL(2);
+
+/**
+ * \brief Retrieves the value mapped to a key in the string map.
+ *
+ * \param[in] self The string map
+ * \param[in] key  The key, interned or not
+ *
+ * \return The value bound to the given key, or \c NULL if the key is not
+ *         present.
+ */
+CODS_MEMBER data_t *sm_get(const StringMap *self, const char *key)
+CODS_PURE CODS_NOTNULL(2);
+
+/**
+ * \brief Retrieves the value mapped to an interned key in the string map,
+ *        without reading the bytes of any string.
+ *
+ * \param[in] self     The string map
+ * \param[in] interned The key, returned by the pool of the map
+ *
+ * \return The value bound to the given key, or \c NULL if the key is not
+ *         present.
+ */
+CODS_MEMBER data_t *sm_get_interned(const StringMap *self,
+                                    const char *interned)
+CODS_PURE CODS_NOTNULL(2);
+
+/**
+ * \brief Convenience function to get a value from the string map or a default
+ *        one if not present.
+ *
+ * \param[in] self  The string map
+ * \param[in] key   The key
+ * \param[in] d_val The default value
+ *
+ * \return The value bound to the given key, or the default value.
+ */
+CODS_MEMBER CODS_INLINE
+data_t *sm_getd(const StringMap *const self, const char *const key,
+                data_t *const d_val) {
+	data_t *const value = sm_get(self, key);
+	return value == NULL ? d_val : value;
+}
+
+/**
+ * \brief Checks whether a key is present in the string map.
+ *
+ * \param[in] self The string map
+ * \param[in] key  The key, interned or not
+ *
+ * \return \c true if the key has a mapping in the instance.
+ */
+CODS_MEMBER bool sm_contains(const StringMap *self, const char *key)
+CODS_PURE CODS_NOTNULL(2);
+
+/**
+ * \brief Removes a key and its value from the string map.
+ *
+ * \note If the key is not present, \c NULL is returned and no action is
+ *       performed on the string map. The key stays interned in the pool.
+ *
+ * \param[in,out] self The string map
+ * \param[in]     key  The key, interned or not
+ *
+ * \return The former value, or \c NULL.
+ */
+CODS_MEMBER data_t *sm_remove(StringMap *self, const char *key)
+CODS_NOTNULL(2);
+
+
+#endif /* CODS_STRINGMAP_H */
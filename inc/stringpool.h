@@ -0,0 +1,143 @@
+/**
+ * \file "stringpool.h"
+ * \author joH1
+ * \version 0.1
+ *
+ * \brief A set of strings stored once each, compared by address.
+ *
+ * The StringPool type \e interns strings: it copies each distinct string it is
+ * given once, and returns that copy for every equal string given afterwards.
+ * Two strings interned in the same pool are thus equal if and only if they are
+ * at the same address, so that comparing them costs a single pointer compare
+ * instead of a \c strcmp.
+ *
+ * The copies are packed in large blocks, each preceded by its length and its
+ * hash, which are read in \c O(1) by \a sp_length and \a sp_hash. They are
+ * indexed by an open-addressing table whose slots hold 32 bits of the hash and
+ * of the length of their string next to its address: a search reads the bytes
+ * of a string only when both match, i.e. nearly always for the searched string
+ * itself. The copies remain valid, at the same address, until the pool is
+ * freed; a string cannot be removed from its pool.
+ *
+ * The functions \a sp_new, \a sp_intern and \a sp_intern_n set the variable
+ * \a errno to describe their state:
+ * - \c 0 if the execution proceeded nominally,
+ * - \c ENOMEM if a memory allocation failed,
+ * - \c EINVAL if the size given to \a sp_new is \c 0.
+ */
+
+#ifndef CODS_STRINGPOOL_H
+#define CODS_STRINGPOOL_H
+
+
+#include <stddef.h> /* for size_t */
+#include <stdint.h> /* for uint64_t */
+#include <stdlib.h> /* for NULL */
+
+#include "cods.h" /* for func attrs */
+
+
+
+/** A set of interned strings. */
+typedef struct stringpool StringPool;
+
+
+/**
+ * \brief Creates a new string pool.
+ *
+ * \param[in] size The number of strings the pool holds without growing its
+ *                 index
+ *
+ * \return A newly-allocated StringPool, or \c NULL on error.
+ */
+CODS_CTOR StringPool *sp_new(size_t size);
+
+/**
+ * \brief Releases memory of a string pool, and of the strings interned in it.
+ *
+ * \param[in,out] self The string pool
+ */
+CODS_MEMBER void sp_free(StringPool *self);
+
+/**
+ * \brief Retrieves the number of strings interned in the pool.
+ *
+ * \param[in] self The string pool
+ *
+ * \return The number of distinct strings.
+ */
+CODS_MEMBER size_t sp_size(const StringPool *self) CODS_PURE;
+
+/**
+ * \brief Interns a string in the pool.
+ *
+ * \param[in,out] self   The string pool
+ * \param[in]     string The string, terminated by a null byte
+ *
+ * \return The copy of the string held by the pool, or \c NULL on error.
+ */
+CODS_MEMBER const char *sp_intern(StringPool *self, const char *string)
+CODS_NOTNULL(2);
+
+/**
+ * \brief Interns the first bytes of a string in the pool.
+ *
+ * \note The bytes may hold null bytes, though such a string is only equal to
+ *       the strings interned with \a sp_intern_n.
+ *
+ * \param[in,out] self   The string pool
+ * \param[in]     string The bytes of the string
+ * \param[in]     length The number of bytes
+ *
+ * \return The copy of the string held by the pool, terminated by a null byte,
+ *         or \c NULL on error.
+ */
+CODS_MEMBER const char *sp_intern_n(StringPool *self, const char *string,
+                                    size_t length)
+CODS_NOTNULL(2);
+
+/**
+ * \brief Searches a string in the pool, without interning it.
+ *
+ * \param[in] self   The string pool
+ * \param[in] string The string, terminated by a null byte
+ *
+ * \return The copy of the string held by the pool, or \c NULL if the string
+ *         is not interned.
+ */
+CODS_MEMBER const char *sp_find(const StringPool *self, const char *string)
+CODS_PURE CODS_NOTNULL(2);
+
+/**
+ * \brief Computes the hash of a string, as the pool stores it.
+ *
+ * \param[in] string The bytes of the string
+ * \param[in] length The number of bytes
+ *
+ * \return The hash of the string.
+ */
+CODS_PURE uint64_t sp_hash_bytes(const char *string, size_t length)
+CODS_NOTNULL(1);
+
+/**
+ * \brief Retrieves the hash of an interned string, without reading its bytes.
+ *
+ * \param[in] interned A string returned by a pool
+ *
+ * \return The hash of the string.
+ */
+CODS_PURE uint64_t sp_hash(const char *interned) CODS_NOTNULL(1);
+
+/**
+ * \brief Retrieves the length of an interned string, without reading its
+ *        bytes.
+ *
+ * \param[in] interned A string returned by a pool
+ *
+ * \return The number of bytes of the string, not counting the null byte
+ *         added by the pool.
+ */
+CODS_PURE size_t sp_length(const char *interned) CODS_NOTNULL(1);
+
+
+#endif /* CODS_STRINGPOOL_H */
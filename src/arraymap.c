@@ -1,61 +1,572 @@
 #include "arraymap.h"
 
-#include "array.h"
-#include "sortedarray.h"
+#include <errno.h> /* for errno, EINVAL, ENOMEM */
+#include <stdint.h> /* for SIZE_MAX */
+#include <stdlib.h> /* for malloc(), free() */
+#include <string.h> /* for memcpy(), memmove() */
+#include <unistd.h> /* for ssize_t */
+
+
+
+extern int errno;
+
+/* The number of searches interleaved by am_get_many */
+#define AM_SEARCH_LANES 16
+
+/* The minimal ratio between the size of the map and the number of keys for
+   am_get_many to walk the map once for a sorted batch */
+#define AM_GALLOP_RATIO 8
+
+/* A key is stored next to its value, so that both are fetched with the same
+   cache line */
+struct ampair {
+	key_t *key;
+	value_t *value;
+};
 
 struct arraymap {
-	SortedArray *keys;
-	Array *values;
+	int (*cmp)(const key_t*, const key_t*);
+	struct ampair *pairs; /* sorted by key */
+	size_t size;
+	size_t capacity;
 };
 
+
+/* The index of a key, or the index it is to be inserted at if not present */
+static size_t am_search(const ArrayMap *const self, const key_t *const key,
+                        bool *const found) {
+	size_t s = 0, e = self->size;
+	while(s < e) {
+		const size_t m = (s + e) / 2;
+		const int d = self->cmp(key, self->pairs[m].key);
+		if(d < 0) {
+			e = m;
+		} else if(d > 0) {
+			s = m + 1;
+		} else {
+			*found = true;
+			return m;
+		}
+	}
+	*found = false;
+	return s;
+}
+
+/* The index of a key, or -1 if it is not present */
+static ssize_t am_indexof(const ArrayMap *const self, const key_t *const key) {
+	bool found;
+	const size_t i = am_search(self, key, &found);
+	return found ? (ssize_t)i : -1;
+}
+
+/* The index of the first key not less than the given one, from lo on: the
+   step doubles until it goes past the key */
+static size_t am_gallop(const ArrayMap *const self, size_t lo,
+                        const key_t *const key) {
+	size_t hi = lo, step = 1;
+	while(hi < self->size && self->cmp(self->pairs[hi].key, key) < 0) {
+		lo = hi + 1;
+		hi += step;
+		step *= 2;
+	}
+	if(hi > self->size) {
+		hi = self->size;
+	}
+	while(lo < hi) {
+		const size_t m = lo + (hi - lo) / 2;
+		if(self->cmp(self->pairs[m].key, key) < 0) {
+			lo = m + 1;
+		} else {
+			hi = m;
+		}
+	}
+	return lo;
+}
+
+/* Searches a group of at most AM_SEARCH_LANES keys at once: at each step, the
+   keys probed by all the searches are first loaded, then compared, so that
+   their cache misses overlap instead of following each other */
+static size_t am_get_lanes(const ArrayMap *const self, key_t *const keys[],
+                           const size_t n, value_t *values[]) {
+	const struct ampair *const pairs = self->pairs;
+	size_t base[AM_SEARCH_LANES];
+	const key_t *probe[AM_SEARCH_LANES];
+	size_t found = 0;
+	for(size_t l = 0; l < n; ++l) {
+		base[l] = 0;
+	}
+	/* all the searches share the same sequence of lengths, so they end
+	   together */
+	for(size_t len = self->size; len > 1; len -= len / 2) {
+		const size_t half = len / 2;
+		for(size_t l = 0; l < n; ++l) {
+			probe[l] = pairs[base[l] + half - 1].key;
+			CODS_PREFETCH(probe[l]);
+		}
+		for(size_t l = 0; l < n; ++l) {
+			base[l] += (self->cmp(probe[l], keys[l]) < 0) * half;
+		}
+	}
+	for(size_t l = 0; l < n; ++l) {
+		values[l] = NULL;
+		if(!self->size) {
+			continue;
+		}
+		int d = self->cmp(pairs[base[l]].key, keys[l]);
+		if(d < 0 && base[l] + 1 < self->size) {
+			d = self->cmp(pairs[++base[l]].key, keys[l]);
+		}
+		if(d == 0) {
+			values[l] = pairs[base[l]].value;
+			++found;
+		}
+	}
+	return found;
+}
+
+/* Makes room for one more pair, growing the array if it is full */
+static bool am_reserve(ArrayMap *const self) {
+	if(self->size == self->capacity) {
+		const size_t c = self->capacity,
+		             capacity = c + (c / 2 + c % 2) /* capacity * 1.5 */;
+		struct ampair *pairs = NULL;
+		if(capacity <= SIZE_MAX / sizeof(struct ampair)) {
+			pairs = realloc(self->pairs, capacity * sizeof(struct ampair));
+		}
+		if(!pairs) {
+			errno = ENOMEM;
+			return false;
+		}
+		self->pairs = pairs;
+		self->capacity = capacity;
+	}
+	return true;
+}
+
+/* Inserts a key and its value at an index, shifting the following pairs; on
+   failure, the map is left unchanged */
+static bool am_insert(ArrayMap *const self, const size_t index,
+                      key_t *const key, value_t *const value) {
+	if(!am_reserve(self)) {
+		return false;
+	}
+	memmove(self->pairs + index + 1, self->pairs + index,
+	        (self->size - index) * sizeof(struct ampair));
+	self->pairs[index].key = key;
+	self->pairs[index].value = value;
+	++self->size;
+	return true;
+}
+
+
 ArrayMap *am_new(const size_t size,
                  int (*const cmp)(const key_t*, const key_t*)) {
-	ArrayMap *const self = malloc(sizeof(ArrayMap));
-	if(!self)
+	if(!size) {
+		errno = EINVAL;
 		return NULL;
-	self->keys = sa_new(size, cmp);
-	if(!self->keys) {
-		free(self);
+	}
+	if(size > SIZE_MAX / sizeof(struct ampair)) {
+		errno = ENOMEM;
 		return NULL;
 	}
-	self->values = a_new(size);
-	if(!self->values) {
-		sa_free(self->keys);
+	ArrayMap *const self = malloc(sizeof(ArrayMap));
+	if(!self)
+		return NULL;
+	self->pairs = malloc(size * sizeof(struct ampair));
+	if(!self->pairs) {
 		free(self);
 		return NULL;
 	}
+	self->cmp = cmp;
+	self->size = 0;
+	self->capacity = size;
+	errno = 0;
 	return self;
 }
 
 void am_free(ArrayMap *const self) {
-	a_free(self->values);
-	sa_free(self->keys);
+	free(self->pairs);
 	free(self);
 }
 
+ArrayMap *am_copy(const ArrayMap *const self) {
+	ArrayMap *const copy = am_new(self->size ? self->size : 1, self->cmp);
+	if(!copy)
+		return NULL;
+	memcpy(copy->pairs, self->pairs, self->size * sizeof(struct ampair));
+	copy->size = self->size;
+	return copy;
+}
+
 bool am_put(ArrayMap *const self, key_t *const key, value_t *const value) {
-	const ssize_t index = sa_add(self->keys, key);
-	if(index < 0)
-		return false;
-	return a_add(self->values, (size_t)index, value) == index;
+	AMEntry entry = am_entry(self, key);
+	if(am_entry_occupied(&entry)) {
+		am_entry_replace(&entry, value);
+		errno = 0;
+		return true;
+	}
+	return am_entry_insert(&entry, value);
+}
+
+value_t *am_upsert(ArrayMap *const self, key_t *const key,
+                   value_t *const value) {
+	AMEntry entry = am_entry(self, key);
+	if(am_entry_occupied(&entry)) {
+		value_t *const former = am_entry_replace(&entry, value);
+		errno = 0;
+		return former;
+	}
+	am_entry_insert(&entry, value);
+	return NULL;
+}
+
+/* Stable bottom-up merge sort of pairs by key, using tmp as buffer */
+static void am_sort(struct ampair *pairs, struct ampair *tmp, const size_t n,
+                    int (*const cmp)(const key_t*, const key_t*)) {
+	struct ampair *const orig = pairs;
+	for(size_t width = 1; width < n; width *= 2) {
+		for(size_t lo = 0; lo < n; lo += 2 * width) {
+			const size_t mid = lo + width < n ? lo + width : n;
+			const size_t hi = mid + width < n ? mid + width : n;
+			size_t i = lo, j = mid, k = lo;
+			while(i < mid && j < hi) {
+				tmp[k++] = cmp(pairs[j].key, pairs[i].key) < 0 ? pairs[j++]
+				                                               : pairs[i++];
+			}
+			while(i < mid) {
+				tmp[k++] = pairs[i++];
+			}
+			while(j < hi) {
+				tmp[k++] = pairs[j++];
+			}
+		}
+		struct ampair *const swap = pairs;
+		pairs = tmp;
+		tmp = swap;
+	}
+	if(pairs != orig) {
+		memcpy(orig, pairs, n * sizeof(struct ampair));
+	}
+}
+
+/* The value kept for a key met twice */
+static value_t *am_resolve(const key_t *const key, value_t *const first,
+                           value_t *const last, const AMDuplicates policy,
+                           value_t *(*const merge)(const key_t*, value_t*,
+                                                   value_t*, void*),
+                           void *const ctx) {
+	switch(policy) {
+		case AM_KEEP_FIRST:
+			return first;
+		case AM_MERGE:
+			return merge(key, first, last, ctx);
+		default:
+			return last;
+	}
+}
+
+ssize_t am_put_many(ArrayMap *const self, key_t *const keys[],
+                    value_t *const values[], const size_t n,
+                    const AMDuplicates policy,
+                    value_t *(*const merge)(const key_t*, value_t*, value_t*,
+                                            void*),
+                    void *const ctx) {
+	if(!n) {
+		errno = 0;
+		return 0;
+	}
+	/* the batch and its sorting buffer, then the merged pairs: all allocated
+	   before any change, so that a failure leaves the map unchanged */
+	const size_t size = self->size;
+	struct ampair *const batch = n <= SIZE_MAX / 2 / sizeof(struct ampair)
+	                             ? malloc(2 * n * sizeof(struct ampair)) : NULL;
+	struct ampair *const merged = batch && size + n >= size
+	                              && size + n <= SIZE_MAX / sizeof(struct ampair)
+	                              ? malloc((size + n) * sizeof(struct ampair))
+	                              : NULL;
+	if(!merged) {
+		free(batch);
+		errno = ENOMEM;
+		return -1;
+	}
+	bool sorted = true;
+	for(size_t j = 0; j < n; ++j) {
+		batch[j].key = keys[j];
+		batch[j].value = values[j];
+		sorted = sorted && (!j || self->cmp(keys[j - 1], keys[j]) <= 0);
+	}
+	if(!sorted) {
+		am_sort(batch, batch + n, n, self->cmp);
+	}
+
+	/* a single pass over both the map and the batch */
+	size_t i = 0, j = 0, w = 0;
+	while(j < n) {
+		int d = i < size ? self->cmp(self->pairs[i].key, batch[j].key) : 1;
+		if(d < 0) {
+			merged[w++] = self->pairs[i++];
+			continue;
+		}
+		if(d > 0) {
+			merged[w++] = batch[j++];
+		} else {
+			merged[w] = self->pairs[i++];
+			merged[w].value = am_resolve(merged[w].key, merged[w].value,
+			                             batch[j++].value, policy, merge, ctx);
+			++w;
+		}
+		/* the following pairs of the batch with the same key */
+		while(j < n && self->cmp(merged[w - 1].key, batch[j].key) == 0) {
+			merged[w - 1].value = am_resolve(merged[w - 1].key,
+			                                 merged[w - 1].value,
+			                                 batch[j++].value, policy, merge,
+			                                 ctx);
+		}
+	}
+	memcpy(merged + w, self->pairs + i, (size - i) * sizeof(struct ampair));
+	w += size - i;
+	free(batch);
+	free(self->pairs);
+	self->pairs = merged;
+	self->capacity = size + n;
+	self->size = w;
+	errno = 0;
+	return (ssize_t)(w - size);
+}
+
+ArrayMap *am_from_pairs(key_t *const keys[], value_t *const values[],
+                        const size_t n,
+                        int (*const cmp)(const key_t*, const key_t*),
+                        const AMDuplicates policy,
+                        value_t *(*const merge)(const key_t*, value_t*,
+                                                value_t*, void*),
+                        void *const ctx) {
+	/* am_put_many allocates the array of the merged pairs */
+	ArrayMap *const self = am_new(1, cmp);
+	if(!self) {
+		return NULL;
+	}
+	if(am_put_many(self, keys, values, n, policy, merge, ctx) < 0) {
+		am_free(self);
+		errno = ENOMEM;
+		return NULL;
+	}
+	return self;
 }
 
 value_t *am_get(const ArrayMap *const self, const key_t *const key) {
-	const ssize_t index = sa_indexof(self->keys, key);
+	const ssize_t index = am_indexof(self, key);
 	if(index < 0)
 		return NULL;
-	return a_get(self->values, index);
+	return self->pairs[index].value;
 }
 extern value_t *am_getd(const ArrayMap*, const key_t*, value_t*);
 
+value_t *am_get_or_insert(ArrayMap *const self, key_t *const key,
+                          value_t *(*const factory)(const key_t*, void*),
+                          void *const ctx) {
+	AMEntry entry = am_entry(self, key);
+	if(am_entry_occupied(&entry)) {
+		return am_entry_get(&entry);
+	}
+	/* the room is made first: once built, the value is always inserted */
+	if(!am_reserve(self)) {
+		return NULL;
+	}
+	value_t *const value = factory(key, ctx);
+	am_entry_insert(&entry, value);
+	return value;
+}
+
+size_t am_get_many(const ArrayMap *const self, key_t *const keys[],
+                   const size_t n, value_t *values[]) {
+	size_t found = 0, l = 1;
+	/* galloping only pays when the keys are close to each other */
+	const bool dense = n && n * AM_GALLOP_RATIO >= self->size;
+	while(dense && l < n && self->cmp(keys[l - 1], keys[l]) <= 0) {
+		++l;
+	}
+	if(dense && l == n) {
+		/* the keys are sorted: walk the map once, galloping from one key to
+		   the next */
+		size_t p = 0;
+		for(size_t i = 0; i < n; ++i) {
+			p = am_gallop(self, p, keys[i]);
+			values[i] = NULL;
+			if(p < self->size && self->cmp(self->pairs[p].key, keys[i]) == 0) {
+				values[i] = self->pairs[p].value;
+				++found;
+			}
+		}
+		return found;
+	}
+	for(size_t i = 0; i < n; i += AM_SEARCH_LANES) {
+		const size_t lanes = n - i < AM_SEARCH_LANES ? n - i : AM_SEARCH_LANES;
+		found += am_get_lanes(self, keys + i, lanes, values + i);
+	}
+	return found;
+}
+
 bool am_contains(const ArrayMap *const self, const key_t *const key) {
-	return sa_indexof(self->keys, key) >= 0;
+	return am_indexof(self, key) >= 0;
 }
 
 value_t *am_remove(ArrayMap *self, key_t *key) {
-	const ssize_t index = sa_indexof(self->keys, key);
+	const ssize_t index = am_indexof(self, key);
 	if(index < 0)
 		return NULL;
-	sa_drop(self->keys, index);
-	return a_drop(self->values, index);
+	value_t *const value = self->pairs[index].value;
+	--self->size;
+	memmove(self->pairs + index, self->pairs + index + 1,
+	        (self->size - index) * sizeof(struct ampair));
+	return value;
+}
+
+AMEntry am_entry(ArrayMap *const self, key_t *const key) {
+	bool found;
+	const size_t i = am_search(self, key, &found);
+	const AMEntry entry = {self, key, found ? (ssize_t)i : -1 - (ssize_t)i};
+	return entry;
+}
+
+extern bool am_entry_occupied(const AMEntry*);
+
+value_t *am_entry_get(const AMEntry *const entry) {
+	if(entry->index < 0) {
+		return NULL;
+	}
+	return entry->map->pairs[entry->index].value;
+}
+
+value_t *am_entry_replace(AMEntry *const entry, value_t *const value) {
+	if(entry->index < 0) {
+		return NULL;
+	}
+	value_t *const former = entry->map->pairs[entry->index].value;
+	entry->map->pairs[entry->index].value = value;
+	return former;
+}
+
+bool am_entry_insert(AMEntry *const entry, value_t *const value) {
+	if(entry->index >= 0) {
+		errno = 0;
+		return false;
+	}
+	const size_t index = -1 - entry->index;
+	if(!am_insert(entry->map, index, entry->key, value)) {
+		return false;
+	}
+	entry->index = index;
+	errno = 0;
+	return true;
+}
+
+
+void am_foreach(const ArrayMap *const self,
+                void (*const apply)(key_t*, value_t*, void*), void *const ctx) {
+	for(size_t i = 0; i < self->size; ++i) {
+		apply(self->pairs[i].key, self->pairs[i].value, ctx);
+	}
+}
+
+void am_foreach_range(const ArrayMap *const self, const key_t *const lo,
+                      const key_t *const hi,
+                      void (*const apply)(key_t*, value_t*, void*),
+                      void *const ctx) {
+	bool found;
+	const size_t last = am_search(self, hi, &found);
+	for(size_t i = am_search(self, lo, &found); i < last; ++i) {
+		apply(self->pairs[i].key, self->pairs[i].value, ctx);
+	}
+}
+
+AMCursor am_seek(const ArrayMap *const self, const key_t *const key) {
+	bool found;
+	const AMCursor cursor = {self, (ssize_t)am_search(self, key, &found),
+	                         self->size};
+	return cursor;
+}
+
+AMCursor am_seek_first(const ArrayMap *const self) {
+	const AMCursor cursor = {self, 0, self->size};
+	return cursor;
+}
+
+AMCursor am_seek_last(const ArrayMap *const self) {
+	const AMCursor cursor = {self, (ssize_t)self->size - 1, self->size};
+	return cursor;
+}
+
+extern bool am_cursor_valid(const AMCursor*);
+
+key_t *am_cursor_key(const AMCursor *const cursor) {
+	if(!am_cursor_valid(cursor)) {
+		return NULL;
+	}
+	return cursor->map->pairs[cursor->index].key;
+}
+
+value_t *am_cursor_value(const AMCursor *const cursor) {
+	if(!am_cursor_valid(cursor)) {
+		return NULL;
+	}
+	return cursor->map->pairs[cursor->index].value;
+}
+
+bool am_cursor_next(AMCursor *const cursor) {
+	if((size_t)(cursor->index + 1) <= cursor->size) {
+		++cursor->index;
+	}
+	return am_cursor_valid(cursor);
+}
+
+bool am_cursor_prev(AMCursor *const cursor) {
+	if(cursor->index >= 0) {
+		--cursor->index;
+	}
+	return am_cursor_valid(cursor);
+}
+
+/* The keys and the values of the map in two arrays, as fm_new takes them */
+static bool am_unzip(const ArrayMap *const self, key_t ***const keys,
+                     value_t ***const values) {
+	*keys = malloc((self->size ? self->size : 1) * sizeof(key_t*));
+	*values = malloc((self->size ? self->size : 1) * sizeof(value_t*));
+	if(!*keys || !*values) {
+		free(*keys);
+		free(*values);
+		errno = ENOMEM;
+		return false;
+	}
+	for(size_t i = 0; i < self->size; ++i) {
+		(*keys)[i] = self->pairs[i].key;
+		(*values)[i] = self->pairs[i].value;
+	}
+	return true;
+}
+
+FrozenMap *am_freeze(const ArrayMap *const self,
+                     size_t (*const hash)(const key_t*)) {
+	key_t **keys;
+	value_t **values;
+	if(!am_unzip(self, &keys, &values))
+		return NULL;
+	FrozenMap *const frozen = fm_new(keys, values, self->size, hash, self->cmp);
+	free(keys);
+	free(values);
+	return frozen;
+}
+
+FrozenMap *am_freeze_load(const ArrayMap *const self,
+                          size_t (*const hash)(const key_t*),
+                          const void *const data, const size_t size) {
+	key_t **keys;
+	value_t **values;
+	if(!am_unzip(self, &keys, &values))
+		return NULL;
+	FrozenMap *const frozen = fm_load(data, size, keys, values, self->size,
+	                                  hash, self->cmp);
+	free(keys);
+	free(values);
+	return frozen;
 }
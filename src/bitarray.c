@@ -25,6 +25,14 @@ static CODS_INLINE bool ba_replace(BitArray *const ba, const size_t i,
 }
 
 
+/* Counts the bits set in a byte */
+static CODS_INLINE size_t ba_popcount(uint8_t b) {
+	b = b - ((b >> 1) & 0x55);
+	b = (b & 0x33) + ((b >> 2) & 0x33);
+	return (b + (b >> 4)) & 0x0F;
+}
+
+
 BitArray *ba_new(const size_t s) {
 	if(!s) {
 		errno = EINVAL;
@@ -63,3 +71,28 @@ bool ba_unset(BitArray *const ba, const size_t i) {
 	return ba_replace(ba, i, ba->data_t[i / 8] & ~(1 << i % 8));
 }
 extern bool ba_put(BitArray*, size_t, bool);
+
+size_t ba_count_range(const BitArray *const ba, const size_t from,
+                      const size_t to) {
+	if(from > to || to > ba->size) {
+		errno = ERANGE;
+		return 0;
+	}
+	errno = 0;
+	if(from == to) {
+		return 0;
+	}
+	const size_t first = from / 8, last = (to - 1) / 8;
+	/* the bits of the first and last bytes out of the range are masked */
+	const uint8_t head = (uint8_t)(0xFF << from % 8);
+	const uint8_t tail = (uint8_t)(0xFF >> (7 - (to - 1) % 8));
+	if(first == last) {
+		return ba_popcount(ba->data_t[first] & head & tail);
+	}
+	size_t count = ba_popcount(ba->data_t[first] & head)
+	               + ba_popcount(ba->data_t[last] & tail);
+	for(size_t i = first + 1; i < last; ++i) {
+		count += ba_popcount(ba->data_t[i]);
+	}
+	return count;
+}
@@ -0,0 +1,492 @@
+#include "bplustree.h"
+
+#include <errno.h> /* for errno, ERANGE */
+#include <stdbool.h>
+#include <stdlib.h> /* for aligned_alloc(), free() */
+#include <string.h> /* for memcpy(), memmove() */
+
+
+
+extern int errno;
+
+/* The nodes are sized after a whole number of cache lines */
+#define BPT_LEAF_LINES 4
+#define BPT_INNER_LINES 8
+
+/* The number of elements in a leaf */
+#define BPT_LEAF_SIZE \
+	((BPT_LEAF_LINES * CODS_CACHE_LINE - sizeof(size_t) - sizeof(void*)) \
+	 / sizeof(data_t*))
+/* The number of children of an inner node */
+#define BPT_FANOUT \
+	((BPT_INNER_LINES * CODS_CACHE_LINE - sizeof(size_t)) \
+	 / (sizeof(data_t*) + sizeof(void*) + sizeof(size_t)))
+
+/* Under these occupancies, a node (other than the root) is rebalanced */
+#define BPT_LEAF_MIN (BPT_LEAF_SIZE / 2)
+#define BPT_INNER_MIN (BPT_FANOUT / 2)
+
+typedef struct bptleaf Leaf;
+struct bptleaf {
+	size_t count;
+	Leaf *next;
+	data_t *items[BPT_LEAF_SIZE];
+};
+
+/* The key of a child is lower than, or equivalent to, all the elements in the
+   child, and greater than all the elements in the previous child. The key of
+   the first child is never used to search. */
+typedef struct bptinner Inner;
+struct bptinner {
+	size_t count;
+	data_t *keys[BPT_FANOUT];
+	void *children[BPT_FANOUT];
+	size_t sizes[BPT_FANOUT]; /* the number of elements in each child */
+};
+
+struct bplustree {
+	int (*cmp)(const data_t*, const data_t*);
+	size_t size;
+	size_t height; /* the number of levels of inner nodes */
+	void *root;
+	Leaf *first;
+};
+
+
+static void *bpt_alloc(size_t size) {
+	/* aligned_alloc() requires a size multiple of the alignment */
+	size += (CODS_CACHE_LINE - size % CODS_CACHE_LINE) % CODS_CACHE_LINE;
+	return aligned_alloc(CODS_CACHE_LINE, size);
+}
+
+static void bpt_freenode(void *const node, const size_t height) {
+	if(height) {
+		const Inner *const inner = node;
+		for(size_t i = 0; i < inner->count; ++i) {
+			bpt_freenode(inner->children[i], height - 1);
+		}
+	}
+	free(node);
+}
+
+static size_t bpt_nodesize(const void *const node, const size_t height) {
+	if(!height) {
+		return ((const Leaf*)node)->count;
+	}
+	const Inner *const inner = node;
+	size_t size = 0;
+	for(size_t i = 0; i < inner->count; ++i) {
+		size += inner->sizes[i];
+	}
+	return size;
+}
+
+static CODS_INLINE bool bpt_full(const void *const node, const size_t height) {
+	return height ? ((const Inner*)node)->count == BPT_FANOUT
+	              : ((const Leaf*)node)->count == BPT_LEAF_SIZE;
+}
+
+/* The index of the first element not lower than the value */
+static size_t bpt_leafbound(const BPlusTree *const self, const Leaf *const leaf,
+                            const data_t *const value) {
+	size_t s = 0, e = leaf->count;
+	while(s < e) {
+		const size_t m = (s + e) / 2;
+		if(self->cmp(leaf->items[m], value) < 0) {
+			s = m + 1;
+		} else {
+			e = m;
+		}
+	}
+	return s;
+}
+
+/* The index of the child that would contain the value */
+static size_t bpt_childindex(const BPlusTree *const self,
+                             const Inner *const inner,
+                             const data_t *const value) {
+	size_t s = 1, e = inner->count;
+	while(s < e) {
+		const size_t m = (s + e) / 2;
+		if(self->cmp(value, inner->keys[m]) < 0) {
+			e = m;
+		} else {
+			s = m + 1;
+		}
+	}
+	return s - 1;
+}
+
+static void bpt_innerinsert(Inner *const inner, const size_t i,
+                            data_t *const key, void *const child,
+                            const size_t size) {
+	const size_t n = inner->count - i;
+	memmove(inner->keys + i + 1, inner->keys + i, n * sizeof(data_t*));
+	memmove(inner->children + i + 1, inner->children + i, n * sizeof(void*));
+	memmove(inner->sizes + i + 1, inner->sizes + i, n * sizeof(size_t));
+	inner->keys[i] = key;
+	inner->children[i] = child;
+	inner->sizes[i] = size;
+	++inner->count;
+}
+
+static void bpt_innererase(Inner *const inner, const size_t i) {
+	const size_t n = inner->count - i - 1;
+	memmove(inner->keys + i, inner->keys + i + 1, n * sizeof(data_t*));
+	memmove(inner->children + i, inner->children + i + 1, n * sizeof(void*));
+	memmove(inner->sizes + i, inner->sizes + i + 1, n * sizeof(size_t));
+	--inner->count;
+}
+
+
+/* Returns -1 if the item is a duplicate or on error, 0 if it was inserted, and
+   1 if the node had to be split: then the new right node and its key are
+   stored in sibling and key. The index of the item is added to rank. */
+static int bpt_insert(BPlusTree *const self, void *const node,
+                      const size_t height, data_t *const item,
+                      size_t *const rank, void **const sibling,
+                      data_t **const key) {
+	if(!height) {
+		Leaf *const leaf = node;
+		size_t pos = bpt_leafbound(self, leaf, item);
+		if(pos < leaf->count && self->cmp(leaf->items[pos], item) == 0) {
+			return -1;
+		}
+		*rank += pos;
+		Leaf *target = leaf;
+		Leaf *right = NULL;
+		if(leaf->count == BPT_LEAF_SIZE) {
+			if(!(right = bpt_alloc(sizeof(Leaf)))) {
+				return -1;
+			}
+			const size_t mid = BPT_LEAF_SIZE / 2;
+			right->count = BPT_LEAF_SIZE - mid;
+			memcpy(right->items, leaf->items + mid,
+			       right->count * sizeof(data_t*));
+			leaf->count = mid;
+			right->next = leaf->next;
+			leaf->next = right;
+			if(pos > mid) {
+				target = right;
+				pos -= mid;
+			}
+		}
+		memmove(target->items + pos + 1, target->items + pos,
+		        (target->count - pos) * sizeof(data_t*));
+		target->items[pos] = item;
+		++target->count;
+		if(right) {
+			*sibling = right;
+			*key = right->items[0];
+			return 1;
+		}
+		return 0;
+	}
+
+	Inner *const inner = node;
+	Inner *right = NULL;
+	/* allocate beforehand, a failure after the child is split would leave the
+	   tree inconsistent */
+	if(inner->count == BPT_FANOUT && !(right = bpt_alloc(sizeof(Inner)))) {
+		return -1;
+	}
+	const size_t i = bpt_childindex(self, inner, item);
+	for(size_t k = 0; k < i; ++k) {
+		*rank += inner->sizes[k];
+	}
+	void *childsibling;
+	data_t *childkey;
+	const int r = bpt_insert(self, inner->children[i], height - 1, item, rank,
+	                         &childsibling, &childkey);
+	if(r <= 0) {
+		free(right);
+		if(r == 0) {
+			++inner->sizes[i];
+		}
+		return r;
+	}
+	const size_t siblingsize = bpt_nodesize(childsibling, height - 1);
+	inner->sizes[i] = inner->sizes[i] + 1 - siblingsize;
+	if(!right) {
+		bpt_innerinsert(inner, i + 1, childkey, childsibling, siblingsize);
+		return 0;
+	}
+	const size_t mid = BPT_FANOUT / 2;
+	right->count = BPT_FANOUT - mid;
+	memcpy(right->keys, inner->keys + mid, right->count * sizeof(data_t*));
+	memcpy(right->children, inner->children + mid,
+	       right->count * sizeof(void*));
+	memcpy(right->sizes, inner->sizes + mid, right->count * sizeof(size_t));
+	inner->count = mid;
+	if(i + 1 > mid) {
+		bpt_innerinsert(right, i + 1 - mid, childkey, childsibling,
+		                siblingsize);
+	} else {
+		bpt_innerinsert(inner, i + 1, childkey, childsibling, siblingsize);
+	}
+	*sibling = right;
+	*key = right->keys[0];
+	return 1;
+}
+
+
+static void bpt_mergeleaves(Inner *const parent, const size_t i) {
+	Leaf *const left = parent->children[i];
+	Leaf *const right = parent->children[i + 1];
+	memcpy(left->items + left->count, right->items,
+	       right->count * sizeof(data_t*));
+	left->count += right->count;
+	left->next = right->next;
+	parent->sizes[i] += parent->sizes[i + 1];
+	bpt_innererase(parent, i + 1);
+	free(right);
+}
+
+static void bpt_fixleaf(Inner *const parent, const size_t i) {
+	Leaf *const child = parent->children[i];
+	if(child->count >= BPT_LEAF_MIN) {
+		return;
+	}
+	Leaf *const left = i > 0 ? parent->children[i - 1] : NULL;
+	Leaf *const right = i + 1 < parent->count ? parent->children[i + 1] : NULL;
+	if(left && left->count > BPT_LEAF_MIN) {
+		memmove(child->items + 1, child->items,
+		        child->count * sizeof(data_t*));
+		child->items[0] = left->items[--left->count];
+		++child->count;
+		parent->keys[i] = child->items[0];
+		--parent->sizes[i - 1];
+		++parent->sizes[i];
+	} else if(right && right->count > BPT_LEAF_MIN) {
+		child->items[child->count++] = right->items[0];
+		memmove(right->items, right->items + 1,
+		        --right->count * sizeof(data_t*));
+		parent->keys[i + 1] = right->items[0];
+		++parent->sizes[i];
+		--parent->sizes[i + 1];
+	} else if(left) {
+		bpt_mergeleaves(parent, i - 1);
+	} else if(right) {
+		bpt_mergeleaves(parent, i);
+	}
+}
+
+static void bpt_mergeinners(Inner *const parent, const size_t i) {
+	Inner *const left = parent->children[i];
+	Inner *const right = parent->children[i + 1];
+	right->keys[0] = parent->keys[i + 1];
+	memcpy(left->keys + left->count, right->keys,
+	       right->count * sizeof(data_t*));
+	memcpy(left->children + left->count, right->children,
+	       right->count * sizeof(void*));
+	memcpy(left->sizes + left->count, right->sizes,
+	       right->count * sizeof(size_t));
+	left->count += right->count;
+	parent->sizes[i] += parent->sizes[i + 1];
+	bpt_innererase(parent, i + 1);
+	free(right);
+}
+
+static void bpt_fixinner(Inner *const parent, const size_t i) {
+	Inner *const child = parent->children[i];
+	if(child->count >= BPT_INNER_MIN) {
+		return;
+	}
+	Inner *const left = i > 0 ? parent->children[i - 1] : NULL;
+	Inner *const right = i + 1 < parent->count ? parent->children[i + 1]
+	                                           : NULL;
+	if(left && left->count > BPT_INNER_MIN) {
+		const size_t last = left->count - 1;
+		const size_t moved = left->sizes[last];
+		child->keys[0] = parent->keys[i];
+		bpt_innerinsert(child, 0, left->keys[last], left->children[last],
+		                moved);
+		parent->keys[i] = left->keys[last];
+		--left->count;
+		parent->sizes[i - 1] -= moved;
+		parent->sizes[i] += moved;
+	} else if(right && right->count > BPT_INNER_MIN) {
+		const size_t moved = right->sizes[0];
+		bpt_innerinsert(child, child->count, parent->keys[i + 1],
+		                right->children[0], moved);
+		parent->keys[i + 1] = right->keys[1];
+		bpt_innererase(right, 0);
+		parent->sizes[i] += moved;
+		parent->sizes[i + 1] -= moved;
+	} else if(left) {
+		bpt_mergeinners(parent, i - 1);
+	} else if(right) {
+		bpt_mergeinners(parent, i);
+	}
+}
+
+/* The least element under a node */
+static data_t *bpt_least(const void *node, size_t height) {
+	for(; height; --height) {
+		node = ((const Inner*)node)->children[0];
+	}
+	return ((const Leaf*)node)->items[0];
+}
+
+static data_t *bpt_delete(void *const node, const size_t height,
+                          size_t index) {
+	if(!height) {
+		Leaf *const leaf = node;
+		data_t *const item = leaf->items[index];
+		memmove(leaf->items + index, leaf->items + index + 1,
+		        (leaf->count - index - 1) * sizeof(data_t*));
+		--leaf->count;
+		return item;
+	}
+	Inner *const inner = node;
+	size_t i = 0;
+	while(index >= inner->sizes[i]) {
+		index -= inner->sizes[i];
+		++i;
+	}
+	data_t *const item = bpt_delete(inner->children[i], height - 1, index);
+	--inner->sizes[i];
+	/* the removed element may be the key of its child, and then freed by the
+	   user: the key is replaced before being copied by a rebalancing */
+	if(inner->keys[i] == item) {
+		inner->keys[i] = bpt_least(inner->children[i], height - 1);
+	}
+	if(height == 1) {
+		bpt_fixleaf(inner, i);
+	} else {
+		bpt_fixinner(inner, i);
+	}
+	return item;
+}
+
+
+BPlusTree *bpt_new(int (*const cmp)(const data_t*, const data_t*)) {
+	BPlusTree *const self = malloc(sizeof(BPlusTree));
+	if(!self) {
+		return NULL;
+	}
+	Leaf *const root = bpt_alloc(sizeof(Leaf));
+	if(!root) {
+		free(self);
+		return NULL;
+	}
+	root->count = 0;
+	root->next = NULL;
+	self->cmp = cmp;
+	self->size = 0;
+	self->height = 0;
+	self->root = root;
+	self->first = root;
+	errno = 0;
+	return self;
+}
+
+void bpt_free(BPlusTree *const self) {
+	bpt_freenode(self->root, self->height);
+	free(self);
+}
+
+size_t bpt_size(const BPlusTree *const self) {
+	return self->size;
+}
+
+ssize_t bpt_add(BPlusTree *const self, data_t *const item) {
+	Inner *root = NULL;
+	if(bpt_full(self->root, self->height)
+	   && !(root = bpt_alloc(sizeof(Inner)))) {
+		return -1;
+	}
+	size_t rank = 0;
+	void *sibling;
+	data_t *key;
+	const int r = bpt_insert(self, self->root, self->height, item, &rank,
+	                         &sibling, &key);
+	if(r < 0) {
+		free(root);
+		return -1;
+	}
+	if(r > 0) {
+		const size_t siblingsize = bpt_nodesize(sibling, self->height);
+		root->count = 2;
+		root->keys[0] = NULL;
+		root->keys[1] = key;
+		root->children[0] = self->root;
+		root->children[1] = sibling;
+		root->sizes[0] = self->size + 1 - siblingsize;
+		root->sizes[1] = siblingsize;
+		self->root = root;
+		++self->height;
+	} else {
+		free(root);
+	}
+	++self->size;
+	errno = 0;
+	return rank;
+}
+
+data_t *bpt_get(const BPlusTree *const self, size_t index) {
+	if(index >= self->size) {
+		errno = ERANGE;
+		return NULL;
+	}
+	const void *node = self->root;
+	for(size_t h = self->height; h > 0; --h) {
+		const Inner *const inner = node;
+		size_t i = 0;
+		while(index >= inner->sizes[i]) {
+			index -= inner->sizes[i];
+			++i;
+		}
+		node = inner->children[i];
+	}
+	errno = 0;
+	return ((const Leaf*)node)->items[index];
+}
+
+ssize_t bpt_indexof(const BPlusTree *const self, const data_t *const value) {
+	const void *node = self->root;
+	size_t rank = 0;
+	for(size_t h = self->height; h > 0; --h) {
+		const Inner *const inner = node;
+		const size_t i = bpt_childindex(self, inner, value);
+		for(size_t k = 0; k < i; ++k) {
+			rank += inner->sizes[k];
+		}
+		node = inner->children[i];
+	}
+	const Leaf *const leaf = node;
+	const size_t pos = bpt_leafbound(self, leaf, value);
+	if(pos < leaf->count && self->cmp(leaf->items[pos], value) == 0) {
+		return rank + pos;
+	}
+	return -1;
+}
+
+extern data_t *bpt_geteq(const BPlusTree*, const data_t*);
+
+data_t *bpt_drop(BPlusTree *const self, const size_t index) {
+	if(index >= self->size) {
+		errno = ERANGE;
+		return NULL;
+	}
+	data_t *const item = bpt_delete(self->root, self->height, index);
+	--self->size;
+	while(self->height && ((Inner*)self->root)->count == 1) {
+		Inner *const root = self->root;
+		self->root = root->children[0];
+		--self->height;
+		free(root);
+	}
+	errno = 0;
+	return item;
+}
+
+extern data_t *bpt_remove(BPlusTree*, const data_t*);
+
+void bpt_each(BPlusTree *const self, void (*const f)(data_t*)) {
+	for(const Leaf *leaf = self->first; leaf; leaf = leaf->next) {
+		for(size_t i = 0; i < leaf->count; ++i) {
+			f(leaf->items[i]);
+		}
+	}
+}
@@ -0,0 +1,243 @@
+#include "cache.h"
+
+#include <errno.h> /* for errno, EINVAL, ENOMEM */
+#include <stdint.h> /* for SIZE_MAX */
+#include <stdlib.h> /* for NULL, malloc(), calloc(), free() */
+
+#include "hashmap.h"
+#include "intrusivelist.h"
+
+
+
+extern int errno;
+
+struct caentry {
+	IntrusiveNode node; /* in the list of the used or of the unused entries */
+	data_t *key;
+	data_t *value;
+};
+
+/* With the LRU policy, the used entries are listed from the most recently used
+   one; with the CLOCK policy, they are listed in the order the hand sweeps
+   them, and the policy is told by the referenced bits, NULL for LRU */
+struct cache {
+	HashMap *index; /* binds each key to its entry */
+	struct caentry *entries;
+	bool *referenced; /* indexed as the entries */
+	IntrusiveList used;
+	IntrusiveList unused;
+	IntrusiveNode *hand; /* the next entry the clock looks at, or NULL */
+	void (*evict)(data_t*, data_t*, void*);
+	void *ctx;
+	CacheStats stats;
+	size_t capacity;
+};
+
+
+static CODS_INLINE struct caentry *ca_entry(IntrusiveNode *const node) {
+	return IL_ENTRY(node, struct caentry, node);
+}
+
+/* The node following the hand, around the circle of the used entries */
+static IntrusiveNode *ca_advance(const Cache *const self,
+                                 const IntrusiveNode *const hand) {
+	IntrusiveNode *const next = il_next(&self->used, hand);
+	return next ? next : il_first(&self->used);
+}
+
+/* Chooses the entry to evict from a full cache, without removing it */
+static struct caentry *ca_victim(Cache *const self) {
+	if(!self->referenced) {
+		return ca_entry(il_last(&self->used));
+	}
+	IntrusiveNode *hand = self->hand ? self->hand : il_first(&self->used);
+	for(;;) {
+		bool *const referenced = &self->referenced[ca_entry(hand)
+		                                           - self->entries];
+		if(!*referenced) {
+			break;
+		}
+		*referenced = false;
+		hand = ca_advance(self, hand);
+	}
+	self->hand = hand;
+	return ca_entry(hand);
+}
+
+static void ca_touch(Cache *const self, struct caentry *const entry) {
+	if(self->referenced) {
+		self->referenced[entry - self->entries] = true;
+	} else {
+		il_move_front(&self->used, &entry->node);
+	}
+}
+
+/* Moves an entry from the used list to the unused one */
+static void ca_release(Cache *const self, struct caentry *const entry) {
+	if(self->hand == &entry->node) {
+		self->hand = il_len(&self->used) > 1 ? ca_advance(self, self->hand)
+		                                     : NULL;
+	}
+	il_remove(&self->used, &entry->node);
+	il_push_front(&self->unused, &entry->node);
+}
+
+
+Cache *ca_new(const size_t capacity, const CachePolicy policy,
+              size_t (*const hash)(const data_t*),
+              bool (*const equal)(const data_t*, const data_t*)) {
+	if(!capacity) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if(capacity > SIZE_MAX / sizeof(struct caentry)) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	Cache *const self = malloc(sizeof(Cache));
+	if(!self) {
+		return NULL;
+	}
+	self->index = hm_new(capacity, hash, equal);
+	self->entries = malloc(capacity * sizeof(struct caentry));
+	self->referenced = policy == CA_CLOCK ? calloc(capacity, sizeof(bool))
+	                                      : NULL;
+	if(!self->index || !self->entries
+	   || (policy == CA_CLOCK && !self->referenced)) {
+		if(self->index) {
+			hm_free(self->index);
+		}
+		free(self->entries);
+		free(self->referenced);
+		free(self);
+		errno = ENOMEM;
+		return NULL;
+	}
+	il_init(&self->used);
+	il_init(&self->unused);
+	for(size_t i = 0; i < capacity; ++i) {
+		il_push_back(&self->unused, &self->entries[i].node);
+	}
+	self->hand = NULL;
+	self->evict = NULL;
+	self->ctx = NULL;
+	ca_reset_stats(self);
+	self->capacity = capacity;
+	errno = 0;
+	return self;
+}
+
+void ca_free(Cache *const self) {
+	hm_free(self->index);
+	free(self->entries);
+	free(self->referenced);
+	free(self);
+}
+
+void ca_set_evict(Cache *const self,
+                  void (*const evict)(data_t*, data_t*, void*),
+                  void *const ctx) {
+	self->evict = evict;
+	self->ctx = ctx;
+}
+
+size_t ca_size(const Cache *const self) {
+	return il_len(&self->used);
+}
+
+size_t ca_capacity(const Cache *const self) {
+	return self->capacity;
+}
+
+CacheStats ca_stats(const Cache *const self) {
+	return self->stats;
+}
+
+void ca_reset_stats(Cache *const self) {
+	self->stats.hits = 0;
+	self->stats.misses = 0;
+	self->stats.evictions = 0;
+}
+
+bool ca_put(Cache *const self, data_t *const key, data_t *const value) {
+	struct caentry *entry = hm_get(self->index, key);
+	if(entry) {
+		entry->value = value;
+		ca_touch(self, entry);
+		errno = 0;
+		return true;
+	}
+	const bool full = !il_len(&self->unused);
+	entry = full ? ca_victim(self) : ca_entry(il_first(&self->unused));
+	/* the key is indexed first, so that nothing is lost on failure */
+	if(!hm_put(self->index, key, entry)) {
+		return false;
+	}
+	if(full) {
+		hm_remove(self->index, entry->key);
+		if(self->evict) {
+			self->evict(entry->key, entry->value, self->ctx);
+		}
+		++self->stats.evictions;
+	}
+	entry->key = key;
+	entry->value = value;
+	if(self->referenced) {
+		/* the evicted entry is replaced in place, just behind the hand */
+		self->referenced[entry - self->entries] = false;
+		if(full) {
+			self->hand = ca_advance(self, self->hand);
+		} else {
+			il_remove(&self->unused, &entry->node);
+			if(self->hand) {
+				il_insert_before(&self->used, self->hand, &entry->node);
+			} else {
+				il_push_back(&self->used, &entry->node);
+			}
+		}
+	} else if(full) {
+		il_move_front(&self->used, &entry->node);
+	} else {
+		il_remove(&self->unused, &entry->node);
+		il_push_front(&self->used, &entry->node);
+	}
+	errno = 0;
+	return true;
+}
+
+data_t *ca_get(Cache *const self, const data_t *const key) {
+	struct caentry *const entry = hm_get(self->index, key);
+	if(!entry) {
+		++self->stats.misses;
+		return NULL;
+	}
+	++self->stats.hits;
+	ca_touch(self, entry);
+	return entry->value;
+}
+
+bool ca_contains(const Cache *const self, const data_t *const key) {
+	return hm_contains(self->index, key);
+}
+
+data_t *ca_remove(Cache *const self, const data_t *const key) {
+	struct caentry *const entry = hm_remove(self->index, key);
+	if(!entry) {
+		return NULL;
+	}
+	ca_release(self, entry);
+	return entry->value;
+}
+
+void ca_clear(Cache *const self) {
+	IntrusiveNode *node;
+	while((node = il_first(&self->used))) {
+		struct caentry *const entry = ca_entry(node);
+		hm_remove(self->index, entry->key);
+		ca_release(self, entry);
+		if(self->evict) {
+			self->evict(entry->key, entry->value, self->ctx);
+		}
+		++self->stats.evictions;
+	}
+}
@@ -0,0 +1,248 @@
+#include "concurrentmap.h"
+
+#include <errno.h> /* for errno, ENOMEM */
+#include <stdatomic.h>
+#include <stdlib.h> /* for NULL, aligned_alloc(), malloc(), free() */
+
+
+
+extern int errno;
+
+/* The epoch recorded by a reader outside of the map; the global epoch starts
+   above it */
+#define CM_QUIESCENT 0
+
+/* A version replaced by a commit, waiting for the readers that may use it to
+   leave the map */
+struct cmretired {
+	ArrayMap *map;
+	size_t epoch; /* the global epoch when it was replaced */
+	struct cmretired *next;
+};
+
+/* Each reader has a cache line of its own, written by its thread only */
+struct cmreader {
+	_Alignas(CODS_CACHE_LINE) atomic_size_t epoch;
+	ConcurrentMap *map;
+	struct cmreader *next;
+	atomic_bool used;
+	char pad[CODS_CACHE_LINE - sizeof(atomic_size_t) - 2 * sizeof(void*)
+	         - sizeof(atomic_bool)];
+};
+
+struct concurrentmap {
+	/* Read by every reader, written on each commit */
+	_Alignas(CODS_CACHE_LINE) _Atomic(ArrayMap*) current;
+	atomic_size_t epoch;
+	char reader_pad[CODS_CACHE_LINE - sizeof(_Atomic(ArrayMap*))
+	                - sizeof(atomic_size_t)];
+	/* Used by the writers and the registrations only */
+	_Atomic(CMReader*) readers;
+	struct cmretired *retired;
+	/* allocated by cm_begin, for the version the commit replaces */
+	struct cmretired *spare;
+	atomic_flag writing;
+	char writer_pad[CODS_CACHE_LINE - sizeof(_Atomic(CMReader*))
+	                - 2 * sizeof(struct cmretired*) - sizeof(atomic_flag)];
+};
+
+
+/* Frees the retired versions older than the epoch of every reader in the map;
+   a reader that entered at a later epoch loaded a later version */
+static void cm_reclaim(ConcurrentMap *const self) {
+	size_t oldest = atomic_load(&self->epoch);
+	for(CMReader *r = atomic_load(&self->readers); r; r = r->next) {
+		const size_t epoch = atomic_load(&r->epoch);
+		if(epoch != CM_QUIESCENT && epoch < oldest) {
+			oldest = epoch;
+		}
+	}
+	struct cmretired **link = &self->retired;
+	while(*link) {
+		struct cmretired *const node = *link;
+		if(node->epoch < oldest) {
+			*link = node->next;
+			am_free(node->map);
+			free(node);
+		} else {
+			link = &node->next;
+		}
+	}
+}
+
+static void cm_lock(ConcurrentMap *const self) {
+	while(atomic_flag_test_and_set_explicit(&self->writing,
+	                                        memory_order_acquire))
+		;
+}
+
+/* Publishes a draft, or only releases the writer lock if NULL */
+static void cm_publish(ConcurrentMap *const self, ArrayMap *const draft) {
+	if(draft) {
+		/* the swap precedes the increment: a reader entering at the new epoch
+		   loads the draft */
+		ArrayMap *const former = atomic_exchange(&self->current, draft);
+		self->spare->map = former;
+		self->spare->epoch = atomic_fetch_add(&self->epoch, 1);
+		self->spare->next = self->retired;
+		self->retired = self->spare;
+		self->spare = NULL;
+		cm_reclaim(self);
+	} else {
+		free(self->spare);
+		self->spare = NULL;
+	}
+	atomic_flag_clear_explicit(&self->writing, memory_order_release);
+}
+
+/* Copies the current version, once the writer lock is taken */
+static ArrayMap *cm_draft(ConcurrentMap *const self) {
+	/* the node is allocated now, so that the commit cannot fail */
+	self->spare = malloc(sizeof(struct cmretired));
+	ArrayMap *const draft = self->spare
+	                        ? am_copy(atomic_load(&self->current)) : NULL;
+	if(!draft) {
+		cm_publish(self, NULL);
+		errno = ENOMEM;
+		return NULL;
+	}
+	errno = 0;
+	return draft;
+}
+
+
+ConcurrentMap *cm_new(const size_t size,
+                      int (*const cmp)(const key_t*, const key_t*)) {
+	ArrayMap *const map = am_new(size, cmp);
+	if(!map) {
+		return NULL;
+	}
+	ConcurrentMap *const self = aligned_alloc(CODS_CACHE_LINE,
+	                                          sizeof(ConcurrentMap));
+	if(!self) {
+		am_free(map);
+		errno = ENOMEM;
+		return NULL;
+	}
+	atomic_init(&self->current, map);
+	atomic_init(&self->epoch, CM_QUIESCENT + 1);
+	atomic_init(&self->readers, NULL);
+	self->retired = NULL;
+	self->spare = NULL;
+	atomic_flag_clear(&self->writing);
+	errno = 0;
+	return self;
+}
+
+void cm_free(ConcurrentMap *const self) {
+	CMReader *reader = atomic_load(&self->readers);
+	while(reader) {
+		CMReader *const next = reader->next;
+		free(reader);
+		reader = next;
+	}
+	while(self->retired) {
+		struct cmretired *const next = self->retired->next;
+		am_free(self->retired->map);
+		free(self->retired);
+		self->retired = next;
+	}
+	am_free(atomic_load(&self->current));
+	free(self);
+}
+
+
+CMReader *cm_reader_new(ConcurrentMap *const self) {
+	for(CMReader *r = atomic_load(&self->readers); r; r = r->next) {
+		bool unused = false;
+		if(!atomic_load_explicit(&r->used, memory_order_relaxed)
+		   && atomic_compare_exchange_strong(&r->used, &unused, true)) {
+			errno = 0;
+			return r;
+		}
+	}
+	CMReader *const reader = aligned_alloc(CODS_CACHE_LINE, sizeof(CMReader));
+	if(!reader) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	atomic_init(&reader->epoch, CM_QUIESCENT);
+	atomic_init(&reader->used, true);
+	reader->map = self;
+	reader->next = atomic_load(&self->readers);
+	while(!atomic_compare_exchange_weak(&self->readers, &reader->next, reader))
+		;
+	errno = 0;
+	return reader;
+}
+
+void cm_reader_free(CMReader *const reader) {
+	atomic_store_explicit(&reader->used, false, memory_order_release);
+}
+
+const ArrayMap *cm_enter(CMReader *const reader) {
+	ConcurrentMap *const map = reader->map;
+	/* the epoch is recorded before the version is loaded, so that a writer
+	   missing it replaced the version first */
+	atomic_store(&reader->epoch, atomic_load(&map->epoch));
+	return atomic_load(&map->current);
+}
+
+void cm_leave(CMReader *const reader) {
+	atomic_store_explicit(&reader->epoch, CM_QUIESCENT, memory_order_release);
+}
+
+value_t *cm_get(CMReader *const reader, const key_t *const key) {
+	value_t *const value = am_get(cm_enter(reader), key);
+	cm_leave(reader);
+	return value;
+}
+
+
+ArrayMap *cm_begin(ConcurrentMap *const self) {
+	cm_lock(self);
+	return cm_draft(self);
+}
+
+void cm_commit(ConcurrentMap *const self, ArrayMap *const draft) {
+	cm_publish(self, draft);
+}
+
+void cm_abort(ConcurrentMap *const self, ArrayMap *const draft) {
+	am_free(draft);
+	cm_publish(self, NULL);
+}
+
+bool cm_put(ConcurrentMap *const self, key_t *const key,
+            value_t *const value) {
+	ArrayMap *const draft = cm_begin(self);
+	if(!draft) {
+		return false;
+	}
+	if(!am_put(draft, key, value)) {
+		cm_abort(self, draft);
+		errno = ENOMEM;
+		return false;
+	}
+	cm_commit(self, draft);
+	errno = 0;
+	return true;
+}
+
+value_t *cm_remove(ConcurrentMap *const self, key_t *const key) {
+	cm_lock(self);
+	/* the current version is only freed by the writers */
+	if(!am_contains(atomic_load(&self->current), key)) {
+		cm_publish(self, NULL);
+		errno = 0;
+		return NULL;
+	}
+	ArrayMap *const draft = cm_draft(self);
+	if(!draft) {
+		return NULL;
+	}
+	value_t *const value = am_remove(draft, key);
+	cm_commit(self, draft);
+	errno = 0;
+	return value;
+}
@@ -0,0 +1,382 @@
+#include "frozenmap.h"
+
+#include <errno.h> /* for errno, EINVAL, ENOMEM */
+#include <stdint.h> /* for uint32_t, uint64_t, UINT32_MAX */
+#include <stdlib.h> /* for NULL, malloc(), calloc(), free() */
+#include <string.h> /* for memcpy() */
+
+#include "bitarray.h"
+
+
+
+extern int errno;
+
+/* The average number of keys per bucket */
+#define FM_BUCKET_SIZE 4
+
+/* The number of seeds tried before giving up, and the number of pilots tried
+   for a bucket before changing the seed */
+#define FM_ATTEMPTS 8
+#define FM_MAX_PILOT (UINT32_C(1) << 20)
+
+/* Marks the data written by fm_save */
+#define FM_MAGIC UINT64_C(0x0000000148504D46)
+
+struct fmslot {
+	data_t *key;
+	data_t *value;
+};
+
+/* The function sends a key to a position in [0, capacity): the pilot of the
+   bucket of its hash selects the position, and the positions past the number
+   of keys are remapped to the slots no key was sent to */
+struct frozenmap {
+	size_t (*hash)(const data_t*);
+	int (*cmp)(const data_t*, const data_t*);
+	struct fmslot *slots;
+	uint32_t *pilots; /* one per bucket */
+	uint32_t *remap; /* one per position past the number of keys */
+	uint32_t *order; /* the index given to fm_new of the key in each slot */
+	uint64_t seed;
+	size_t size;
+	size_t nbuckets;
+	size_t capacity;
+};
+
+/* The data written by fm_save, followed by the pilots, the remapped positions
+   and the order of the keys, as 32-bit integers */
+struct fmheader {
+	uint64_t magic;
+	uint64_t seed;
+	uint64_t size;
+	uint64_t nbuckets;
+	uint64_t capacity;
+};
+
+
+/* The finalizer of SplitMix64 */
+static CODS_INLINE uint64_t fm_mix(uint64_t x) {
+	x ^= x >> 30;
+	x *= UINT64_C(0xBF58476D1CE4E5B9);
+	x ^= x >> 27;
+	x *= UINT64_C(0x94D049BB133111EB);
+	return x ^ (x >> 31);
+}
+
+static CODS_INLINE uint64_t fm_hash(const FrozenMap *const self,
+                                    const data_t *const key) {
+	return fm_mix((uint64_t)self->hash(key) ^ self->seed);
+}
+
+/* The bucket of a hash, from its high bits */
+static CODS_INLINE size_t fm_bucket(const FrozenMap *const self,
+                                   const uint64_t h) {
+	return (size_t)((h >> 32) * self->nbuckets >> 32);
+}
+
+/* The position of a hash given a pilot, from the high bits of their product:
+   these depend on all the bits of the hash, where a modulo would only keep the
+   low ones, which the keys of a bucket may share whatever the pilot */
+static CODS_INLINE size_t fm_position(const FrozenMap *const self,
+                                     const uint64_t h, const uint32_t pilot) {
+	const uint64_t x = (h ^ (pilot * UINT64_C(0xC2B2AE3D27D4EB4F)))
+	                   * UINT64_C(0x9E3779B97F4A7C15);
+	return (size_t)((x >> 32) * self->capacity >> 32);
+}
+
+/* The slot of a hash: one read of a pilot, and of a remapped position for the
+   few keys sent past the table */
+static CODS_INLINE size_t fm_slot(const FrozenMap *const self,
+                                 const uint64_t h) {
+	const size_t p = fm_position(self, h, self->pilots[fm_bucket(self, h)]);
+	return p < self->size ? p : self->remap[p - self->size];
+}
+
+static FrozenMap *fm_alloc(const size_t n, const size_t nbuckets,
+                           const size_t capacity,
+                           size_t (*const hash)(const data_t*),
+                           int (*const cmp)(const data_t*, const data_t*)) {
+	if(n >= UINT32_MAX || capacity >= UINT32_MAX || capacity <= n) {
+		errno = EINVAL;
+		return NULL;
+	}
+	FrozenMap *const self = malloc(sizeof(FrozenMap));
+	if(!self) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	self->slots = malloc((n ? n : 1) * sizeof(struct fmslot));
+	self->pilots = malloc(nbuckets * sizeof(uint32_t));
+	self->remap = calloc(capacity - n, sizeof(uint32_t));
+	self->order = malloc((n ? n : 1) * sizeof(uint32_t));
+	if(!self->slots || !self->pilots || !self->remap || !self->order) {
+		fm_free(self);
+		errno = ENOMEM;
+		return NULL;
+	}
+	self->hash = hash;
+	self->cmp = cmp;
+	self->seed = 0;
+	self->size = n;
+	self->nbuckets = nbuckets;
+	self->capacity = capacity;
+	return self;
+}
+
+/* Searches a pilot for each bucket, the largest ones first; the position of
+   each key is written in positions. Returns false if a bucket found no pilot,
+   and sets errno to EINVAL if two keys have the same hash */
+static bool fm_search(FrozenMap *const self, const uint64_t *const hashes,
+                      uint32_t *const positions, BitArray *const taken) {
+	const size_t n = self->size, nbuckets = self->nbuckets;
+	/* the keys grouped by bucket, then the buckets sorted by size */
+	size_t *const start = calloc(nbuckets + 1, sizeof(size_t));
+	uint32_t *const members = malloc((n ? n : 1) * sizeof(uint32_t));
+	uint32_t *const sorted = malloc(nbuckets * sizeof(uint32_t));
+	size_t *const bysize = calloc(n + 2, sizeof(size_t));
+	size_t *const tried = malloc((n + 1) * sizeof(size_t));
+	bool found = start && members && sorted && bysize && tried;
+	errno = found ? 0 : ENOMEM;
+	if(found) {
+		for(size_t i = 0; i < n; ++i) {
+			++start[fm_bucket(self, hashes[i]) + 1];
+		}
+		for(size_t b = 0; b < nbuckets; ++b) {
+			++bysize[n - start[b + 1] + 1];
+			start[b + 1] += start[b];
+		}
+		for(size_t i = 0; i < n; ++i) {
+			members[start[fm_bucket(self, hashes[i])]++] = (uint32_t)i;
+		}
+		/* start[b] now is the end of bucket b */
+		for(size_t s = 1; s <= n + 1; ++s) {
+			bysize[s] += bysize[s - 1];
+		}
+		for(size_t b = 0; b < nbuckets; ++b) {
+			const size_t count = start[b] - (b ? start[b - 1] : 0);
+			sorted[bysize[n - count]++] = (uint32_t)b;
+		}
+	}
+	for(size_t k = 0; found && k < nbuckets; ++k) {
+		const size_t b = sorted[k];
+		const size_t first = b ? start[b - 1] : 0, count = start[b] - first;
+		const uint32_t *const keys = members + first;
+		for(size_t i = 0; i < count; ++i) {
+			for(size_t j = 0; j < i; ++j) {
+				if(hashes[keys[i]] == hashes[keys[j]]) {
+					errno = EINVAL;
+					found = false;
+				}
+			}
+		}
+		uint32_t pilot = 0;
+		size_t i = 0;
+		for(; found && i < count && pilot < FM_MAX_PILOT; ++i) {
+			tried[i] = fm_position(self, hashes[keys[i]], pilot);
+			bool vacant = !ba_get(taken, tried[i]);
+			for(size_t j = 0; vacant && j < i; ++j) {
+				vacant = tried[j] != tried[i];
+			}
+			if(!vacant) {
+				++pilot;
+				i = (size_t)-1;
+			}
+		}
+		if(!found || pilot == FM_MAX_PILOT) {
+			found = false;
+			break;
+		}
+		self->pilots[b] = pilot;
+		for(i = 0; i < count; ++i) {
+			ba_set(taken, tried[i]);
+			positions[keys[i]] = (uint32_t)tried[i];
+		}
+	}
+	free(start);
+	free(members);
+	free(sorted);
+	free(bysize);
+	free(tried);
+	return found;
+}
+
+/* Sends the positions past the number of keys to the free slots */
+static void fm_remap(FrozenMap *const self, const BitArray *const taken) {
+	size_t hole = 0;
+	for(size_t p = self->size; p < self->capacity; ++p) {
+		if(ba_get(taken, p)) {
+			while(ba_get(taken, hole)) {
+				++hole;
+			}
+			self->remap[p - self->size] = (uint32_t)hole++;
+		}
+	}
+}
+
+
+FrozenMap *fm_new(data_t *const keys[], data_t *const values[], const size_t n,
+                  size_t (*const hash)(const data_t*),
+                  int (*const cmp)(const data_t*, const data_t*)) {
+	FrozenMap *const self = fm_alloc(n, n / FM_BUCKET_SIZE + 1, n + n / 32 + 1,
+	                                 hash, cmp);
+	if(!self) {
+		return NULL;
+	}
+	uint64_t *const hashes = malloc((n ? n : 1) * sizeof(uint64_t));
+	uint32_t *const positions = malloc((n ? n : 1) * sizeof(uint32_t));
+	BitArray *taken = NULL;
+	bool built = false;
+	errno = hashes && positions ? 0 : ENOMEM;
+	for(unsigned attempt = 0; !errno && !built && attempt < FM_ATTEMPTS;
+	    ++attempt) {
+		self->seed = fm_mix(attempt + 1);
+		for(size_t i = 0; i < n; ++i) {
+			hashes[i] = fm_hash(self, keys[i]);
+		}
+		if(taken) {
+			ba_free(taken);
+		}
+		taken = ba_new(self->capacity);
+		if(!taken) {
+			errno = ENOMEM;
+			break;
+		}
+		built = fm_search(self, hashes, positions, taken);
+	}
+	if(built) {
+		fm_remap(self, taken);
+		for(size_t i = 0; i < n; ++i) {
+			size_t p = positions[i];
+			p = p < n ? p : self->remap[p - n];
+			self->slots[p].key = keys[i];
+			self->slots[p].value = values[i];
+			self->order[p] = (uint32_t)i;
+		}
+	}
+	if(taken) {
+		ba_free(taken);
+	}
+	free(hashes);
+	free(positions);
+	if(!built) {
+		const int error = errno ? errno : EINVAL;
+		fm_free(self);
+		errno = error;
+		return NULL;
+	}
+	errno = 0;
+	return self;
+}
+
+void fm_free(FrozenMap *const self) {
+	free(self->slots);
+	free(self->pilots);
+	free(self->remap);
+	free(self->order);
+	free(self);
+}
+
+size_t fm_size(const FrozenMap *const self) {
+	return self->size;
+}
+
+data_t *fm_get(const FrozenMap *const self, const data_t *const key) {
+	if(!self->size) {
+		return NULL;
+	}
+	const struct fmslot *const slot = &self->slots[fm_slot(self,
+	                                                      fm_hash(self, key))];
+	return self->cmp(slot->key, key) == 0 ? slot->value : NULL;
+}
+extern data_t *fm_getd(const FrozenMap*, const data_t*, data_t*);
+
+bool fm_contains(const FrozenMap *const self, const data_t *const key) {
+	if(!self->size) {
+		return false;
+	}
+	const size_t i = fm_slot(self, fm_hash(self, key));
+	return self->cmp(self->slots[i].key, key) == 0;
+}
+
+size_t fm_save(const FrozenMap *const self, void *const buffer,
+               const size_t size) {
+	const size_t nremap = self->capacity - self->size;
+	const size_t bytes = sizeof(struct fmheader)
+	                     + (self->nbuckets + nremap + self->size)
+	                       * sizeof(uint32_t);
+	if(!buffer || size < bytes) {
+		return bytes;
+	}
+	const struct fmheader header = {
+		FM_MAGIC, self->seed, self->size, self->nbuckets, self->capacity
+	};
+	char *out = buffer;
+	memcpy(out, &header, sizeof(header));
+	out += sizeof(header);
+	memcpy(out, self->pilots, self->nbuckets * sizeof(uint32_t));
+	out += self->nbuckets * sizeof(uint32_t);
+	memcpy(out, self->remap, nremap * sizeof(uint32_t));
+	out += nremap * sizeof(uint32_t);
+	memcpy(out, self->order, self->size * sizeof(uint32_t));
+	return bytes;
+}
+
+FrozenMap *fm_load(const void *const data, const size_t size,
+                   data_t *const keys[], data_t *const values[],
+                   const size_t n, size_t (*const hash)(const data_t*),
+                   int (*const cmp)(const data_t*, const data_t*)) {
+	struct fmheader header;
+	if(size < sizeof(header)) {
+		errno = EINVAL;
+		return NULL;
+	}
+	memcpy(&header, data, sizeof(header));
+	if(header.magic != FM_MAGIC || header.size != n || !header.nbuckets
+	   || header.nbuckets > n + 1 || header.capacity <= n
+	   || header.capacity >= UINT32_MAX
+	   || size != sizeof(header) + (header.nbuckets + header.capacity)
+	                               * sizeof(uint32_t)) {
+		errno = EINVAL;
+		return NULL;
+	}
+	FrozenMap *const self = fm_alloc(n, header.nbuckets, header.capacity, hash,
+	                                 cmp);
+	if(!self) {
+		return NULL;
+	}
+	const size_t nremap = self->capacity - n;
+	const char *in = (const char*)data + sizeof(header);
+	self->seed = header.seed;
+	memcpy(self->pilots, in, self->nbuckets * sizeof(uint32_t));
+	in += self->nbuckets * sizeof(uint32_t);
+	memcpy(self->remap, in, nremap * sizeof(uint32_t));
+	in += nremap * sizeof(uint32_t);
+	memcpy(self->order, in, n * sizeof(uint32_t));
+	/* each key must be found at its slot, once */
+	BitArray *const seen = ba_new(n ? n : 1);
+	bool valid = seen != NULL;
+	for(size_t r = 0; valid && r < nremap; ++r) {
+		valid = self->remap[r] < n || !n;
+	}
+	for(size_t p = 0; valid && p < n; ++p) {
+		const uint32_t i = self->order[p];
+		valid = i < n && !ba_get(seen, i)
+		        && fm_slot(self, fm_hash(self, keys[i])) == p;
+		if(valid) {
+			ba_set(seen, i);
+			self->slots[p].key = keys[i];
+			self->slots[p].value = values[i];
+		}
+	}
+	if(seen) {
+		ba_free(seen);
+	}
+	if(!valid) {
+		const int error = seen ? EINVAL : ENOMEM;
+		fm_free(self);
+		errno = error;
+		return NULL;
+	}
+	errno = 0;
+	return self;
+}
@@ -0,0 +1,285 @@
+#include "hashmap.h"
+
+#include <errno.h> /* for errno, EINVAL, ENOMEM */
+#include <stdint.h> /* for int8_t, uint64_t, SIZE_MAX */
+#include <stdlib.h> /* for malloc(), free() */
+#include <string.h> /* for memset() */
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+
+
+extern int errno;
+
+/* The number of slots whose control bytes are probed at once */
+#define HM_GROUP 16
+
+/* The control bytes: a full slot holds the 7 low bits of the hash of its key,
+   i.e. a non-negative value */
+#define HM_EMPTY ((int8_t)-128)
+#define HM_DELETED ((int8_t)-2)
+
+struct hmslot {
+	data_t *key;
+	data_t *value;
+};
+
+/* The control bytes of the first HM_GROUP slots are repeated after the last
+   one, so that a group can be loaded from any slot without wrapping around */
+struct hashmap {
+	size_t (*hash)(const data_t*);
+	bool (*equal)(const data_t*, const data_t*);
+	int8_t *ctrl;
+	struct hmslot *slots;
+	size_t capacity; /* a power of 2, at least HM_GROUP */
+	size_t size;
+	size_t growth; /* the number of empty slots that can still be filled */
+};
+
+
+/* Mixes the hash given by the user, so that its low and high bits are both
+   usable */
+static CODS_INLINE uint64_t hm_mix(const HashMap *const self,
+                                   const data_t *const key) {
+	uint64_t h = (uint64_t)self->hash(key);
+	h = (h ^ (h >> 32)) * UINT64_C(0x9E3779B97F4A7C15);
+	return h ^ (h >> 29);
+}
+
+static CODS_INLINE int8_t hm_h2(const uint64_t h) {
+	return (int8_t)(h & 0x7F);
+}
+
+/* The bit i of the mask is set if the byte i of the group equals c */
+static CODS_INLINE unsigned hm_match(const int8_t *const group, const int8_t c) {
+#ifdef __SSE2__
+	const __m128i g = _mm_loadu_si128((const __m128i*)group);
+	return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(c)));
+#else
+	unsigned mask = 0;
+	for(unsigned i = 0; i < HM_GROUP; ++i) {
+		mask |= (unsigned)(group[i] == c) << i;
+	}
+	return mask;
+#endif
+}
+
+/* The bit i of the mask is set if the slot i of the group is empty or
+   removed */
+static CODS_INLINE unsigned hm_matchfree(const int8_t *const group) {
+#ifdef __SSE2__
+	const __m128i g = _mm_loadu_si128((const __m128i*)group);
+	return (unsigned)_mm_movemask_epi8(g);
+#else
+	unsigned mask = 0;
+	for(unsigned i = 0; i < HM_GROUP; ++i) {
+		mask |= (unsigned)(group[i] < 0) << i;
+	}
+	return mask;
+#endif
+}
+
+/* The index of the lowest bit set in a non-zero mask */
+static CODS_INLINE unsigned hm_lowest(const unsigned mask) {
+#ifdef __GNUC__
+	return (unsigned)__builtin_ctz(mask);
+#else
+	unsigned i = 0;
+	while(!(mask >> i & 1)) {
+		++i;
+	}
+	return i;
+#endif
+}
+
+/* The number of unset bits above the highest one set, in a group mask */
+static CODS_INLINE unsigned hm_leadingfree(const unsigned mask) {
+	unsigned n = 0;
+	while(n < HM_GROUP && !(mask >> (HM_GROUP - 1 - n) & 1)) {
+		++n;
+	}
+	return n;
+}
+
+static CODS_INLINE void hm_setctrl(HashMap *const self, const size_t i,
+                                   const int8_t c) {
+	self->ctrl[i] = c;
+	if(i < HM_GROUP) {
+		self->ctrl[self->capacity + i] = c;
+	}
+}
+
+/* Finds the slot of a key, or returns SIZE_MAX; the groups are probed in a
+   triangular sequence, which visits each of them once */
+static size_t hm_find(const HashMap *const self, const data_t *const key,
+                      const uint64_t h) {
+	const size_t mask = self->capacity - 1;
+	size_t pos = (size_t)(h >> 7) & mask;
+	for(size_t step = HM_GROUP;; step += HM_GROUP) {
+		const int8_t *const group = self->ctrl + pos;
+		for(unsigned m = hm_match(group, hm_h2(h)); m; m &= m - 1) {
+			const size_t i = (pos + hm_lowest(m)) & mask;
+			if(self->equal(self->slots[i].key, key)) {
+				return i;
+			}
+		}
+		if(hm_match(group, HM_EMPTY)) {
+			return SIZE_MAX;
+		}
+		pos = (pos + step) & mask;
+	}
+}
+
+/* Finds the first empty or removed slot on the probe sequence of a hash */
+static size_t hm_findfree(const HashMap *const self, const uint64_t h) {
+	const size_t mask = self->capacity - 1;
+	size_t pos = (size_t)(h >> 7) & mask;
+	for(size_t step = HM_GROUP;; step += HM_GROUP) {
+		const unsigned m = hm_matchfree(self->ctrl + pos);
+		if(m) {
+			return (pos + hm_lowest(m)) & mask;
+		}
+		pos = (pos + step) & mask;
+	}
+}
+
+static bool hm_alloc(HashMap *const self, const size_t capacity) {
+	int8_t *const ctrl = malloc(capacity + HM_GROUP);
+	struct hmslot *const slots = malloc(capacity * sizeof(struct hmslot));
+	if(!ctrl || !slots) {
+		free(ctrl);
+		free(slots);
+		errno = ENOMEM;
+		return false;
+	}
+	memset(ctrl, HM_EMPTY, capacity + HM_GROUP);
+	self->ctrl = ctrl;
+	self->slots = slots;
+	self->capacity = capacity;
+	self->growth = capacity - capacity / 8;
+	return true;
+}
+
+/* Moves the keys to a new table, twice as large unless most of the slots that
+   cannot be filled are removed ones */
+static bool hm_rehash(HashMap *const self) {
+	int8_t *const ctrl = self->ctrl;
+	struct hmslot *const slots = self->slots;
+	const size_t capacity = self->capacity;
+	const size_t target = 2 * self->size >= capacity - capacity / 8
+	                      ? 2 * capacity : capacity;
+	if(!hm_alloc(self, target)) {
+		self->ctrl = ctrl;
+		self->slots = slots;
+		return false;
+	}
+	for(size_t i = 0; i < capacity; ++i) {
+		if(ctrl[i] >= 0) {
+			const uint64_t h = hm_mix(self, slots[i].key);
+			const size_t j = hm_findfree(self, h);
+			hm_setctrl(self, j, hm_h2(h));
+			self->slots[j] = slots[i];
+		}
+	}
+	self->growth -= self->size;
+	free(ctrl);
+	free(slots);
+	return true;
+}
+
+
+HashMap *hm_new(const size_t size, size_t (*const hash)(const data_t*),
+                bool (*const equal)(const data_t*, const data_t*)) {
+	if(!size) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if(size > SIZE_MAX / 2 / sizeof(struct hmslot)) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	HashMap *const self = malloc(sizeof(HashMap));
+	if(!self) {
+		return NULL;
+	}
+	/* the smallest table whose load is at most 7/8 with size keys */
+	size_t capacity = HM_GROUP;
+	while(capacity - capacity / 8 < size) {
+		capacity *= 2;
+	}
+	if(!hm_alloc(self, capacity)) {
+		free(self);
+		return NULL;
+	}
+	self->hash = hash;
+	self->equal = equal;
+	self->size = 0;
+	errno = 0;
+	return self;
+}
+
+void hm_free(HashMap *const self) {
+	free(self->ctrl);
+	free(self->slots);
+	free(self);
+}
+
+size_t hm_size(const HashMap *const self) {
+	return self->size;
+}
+
+bool hm_put(HashMap *const self, data_t *const key, data_t *const value) {
+	const uint64_t h = hm_mix(self, key);
+	size_t i = hm_find(self, key, h);
+	if(i != SIZE_MAX) {
+		self->slots[i].value = value;
+		errno = 0;
+		return true;
+	}
+	i = hm_findfree(self, h);
+	/* a removed slot is reused without consuming the growth */
+	if(self->ctrl[i] == HM_EMPTY && !self->growth) {
+		if(!hm_rehash(self)) {
+			return false;
+		}
+		i = hm_findfree(self, h);
+	}
+	self->growth -= self->ctrl[i] == HM_EMPTY;
+	hm_setctrl(self, i, hm_h2(h));
+	self->slots[i].key = key;
+	self->slots[i].value = value;
+	++self->size;
+	errno = 0;
+	return true;
+}
+
+data_t *hm_get(const HashMap *const self, const data_t *const key) {
+	const size_t i = hm_find(self, key, hm_mix(self, key));
+	return i == SIZE_MAX ? NULL : self->slots[i].value;
+}
+extern data_t *hm_getd(const HashMap*, const data_t*, data_t*);
+
+bool hm_contains(const HashMap *const self, const data_t *const key) {
+	return hm_find(self, key, hm_mix(self, key)) != SIZE_MAX;
+}
+
+data_t *hm_remove(HashMap *const self, const data_t *const key) {
+	const size_t i = hm_find(self, key, hm_mix(self, key));
+	if(i == SIZE_MAX) {
+		return NULL;
+	}
+	/* the slot can be emptied only if no probe sequence ever went past it,
+	   i.e. if every group holding it also holds an empty slot */
+	const size_t before = (i - HM_GROUP) & (self->capacity - 1);
+	const unsigned empty_after = hm_match(self->ctrl + i, HM_EMPTY);
+	const unsigned empty_before = hm_match(self->ctrl + before, HM_EMPTY);
+	const bool never_full = empty_before && empty_after
+	                        && hm_lowest(empty_after)
+	                           + hm_leadingfree(empty_before) < HM_GROUP;
+	hm_setctrl(self, i, never_full ? HM_EMPTY : HM_DELETED);
+	self->growth += never_full;
+	--self->size;
+	return self->slots[i].value;
+}
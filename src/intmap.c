@@ -0,0 +1,300 @@
+#include "intmap.h"
+
+#include <errno.h> /* for errno, EINVAL, ENOMEM, ERANGE */
+#include <stdlib.h> /* for aligned_alloc(), malloc(), realloc(), free() */
+#include <string.h> /* for memcpy(), memmove() */
+
+#ifdef __AVX2__
+# include <immintrin.h>
+#endif
+
+
+
+extern int errno;
+
+/* The number of keys counted linearly at the end of a search: the range is
+   narrowed down to this many keys, i.e. four cache lines */
+#define IM_LINEAR (4 * CODS_CACHE_LINE / sizeof(int64_t))
+
+struct intmap {
+	int64_t *keys; /* aligned on a cache line */
+	data_t **values;
+	size_t size;
+	size_t capacity;
+	/* the search of the lower bound of a key, by halves or by interpolation */
+	size_t (*search)(const IntMap*, int64_t);
+};
+
+
+static int64_t *im_allockeys(const size_t capacity) {
+	size_t bytes = capacity * sizeof(int64_t);
+	/* aligned_alloc() requires a size multiple of the alignment */
+	bytes += (CODS_CACHE_LINE - bytes % CODS_CACHE_LINE) % CODS_CACHE_LINE;
+	return aligned_alloc(CODS_CACHE_LINE, bytes);
+}
+
+/* Ensures the map can hold n keys */
+static bool im_reserve(IntMap *const self, const size_t n) {
+	if(n <= self->capacity) {
+		return true;
+	}
+	const size_t capacity = 2 * self->capacity > n ? 2 * self->capacity : n;
+	int64_t *const keys = im_allockeys(capacity);
+	if(!keys) {
+		errno = ENOMEM;
+		return false;
+	}
+	data_t **const values = realloc(self->values, capacity * sizeof(data_t*));
+	if(!values) {
+		free(keys);
+		errno = ENOMEM;
+		return false;
+	}
+	memcpy(keys, self->keys, self->size * sizeof(int64_t));
+	free(self->keys);
+	self->keys = keys;
+	self->values = values;
+	self->capacity = capacity;
+	return true;
+}
+
+/* Counts the keys less than the given one, among n keys */
+static CODS_INLINE size_t im_countless(const int64_t *const keys,
+                                       const size_t n, const int64_t key) {
+	size_t count = 0, i = 0;
+#ifdef __AVX2__
+	const __m256i k = _mm256_set1_epi64x(key);
+	__m256i acc = _mm256_setzero_si256();
+	for(; i + 4 <= n; i += 4) {
+		const __m256i v = _mm256_loadu_si256((const __m256i*)(keys + i));
+		/* the comparison yields -1 in the lanes where the key is greater */
+		acc = _mm256_sub_epi64(acc, _mm256_cmpgt_epi64(k, v));
+	}
+	int64_t lanes[4];
+	_mm256_storeu_si256((__m256i*)lanes, acc);
+	count = (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+#endif
+	/* without AVX2, the compiler vectorizes this loop as it can */
+	for(; i < n; ++i) {
+		count += keys[i] < key;
+	}
+	return count;
+}
+
+/* Finds the lower bound of a key by halving the range, without branching */
+static size_t im_search_halves(const IntMap *const self, const int64_t key) {
+	const int64_t *base = self->keys;
+	size_t n = self->size;
+	while(n > IM_LINEAR) {
+		const size_t half = n / 2;
+		CODS_PREFETCH(base + half / 2);
+		CODS_PREFETCH(base + half + half / 2);
+		base += (base[half - 1] < key) * half;
+		n -= half;
+	}
+	return base - self->keys + im_countless(base, n, key);
+}
+
+/* Finds the lower bound of a key by interpolating its position between the
+   keys at both ends of the range */
+static size_t im_search_interpolation(const IntMap *const self,
+                                      const int64_t key) {
+	const int64_t *const keys = self->keys;
+	/* the lower bound is in [lo, hi] */
+	size_t lo = 0, hi = self->size;
+	while(hi - lo > IM_LINEAR) {
+		const int64_t first = keys[lo], last = keys[hi - 1];
+		if(key <= first) {
+			return lo;
+		} else if(key > last) {
+			return hi;
+		}
+		const size_t span = hi - lo;
+		const double ratio = ((double)key - (double)first)
+		                     / ((double)last - (double)first);
+		size_t p = lo + (size_t)(ratio * (double)(span - 1));
+		if(p >= hi) {
+			p = hi - 1;
+		}
+		if(keys[p] < key) {
+			lo = p + 1;
+		} else {
+			hi = p;
+		}
+		if(2 * (hi - lo) > span) {
+			/* the guess was poor: halve the range as well */
+			const size_t m = lo + (hi - lo) / 2;
+			if(keys[m] < key) {
+				lo = m + 1;
+			} else {
+				hi = m;
+			}
+		}
+	}
+	return lo + im_countless(keys + lo, hi - lo, key);
+}
+
+
+IntMap *im_new(const size_t size) {
+	if(!size) {
+		errno = EINVAL;
+		return NULL;
+	}
+	IntMap *const self = malloc(sizeof(IntMap));
+	if(!self) {
+		return NULL;
+	}
+	self->keys = im_allockeys(size);
+	self->values = malloc(size * sizeof(data_t*));
+	if(!self->keys || !self->values) {
+		free(self->keys);
+		free(self->values);
+		free(self);
+		errno = ENOMEM;
+		return NULL;
+	}
+	self->size = 0;
+	self->capacity = size;
+	self->search = im_search_halves;
+	errno = 0;
+	return self;
+}
+
+void im_free(IntMap *const self) {
+	free(self->keys);
+	free(self->values);
+	free(self);
+}
+
+size_t im_size(const IntMap *const self) {
+	return self->size;
+}
+
+void im_set_interpolation(IntMap *const self, const bool interpolate) {
+	self->search = interpolate ? im_search_interpolation : im_search_halves;
+}
+
+bool im_put(IntMap *const self, const int64_t key, data_t *const value) {
+	const size_t index = self->search(self, key);
+	if(index < self->size && self->keys[index] == key) {
+		self->values[index] = value;
+		errno = 0;
+		return true;
+	}
+	if(!im_reserve(self, self->size + 1)) {
+		return false;
+	}
+	memmove(self->keys + index + 1, self->keys + index,
+	        (self->size - index) * sizeof(int64_t));
+	memmove(self->values + index + 1, self->values + index,
+	        (self->size - index) * sizeof(data_t*));
+	self->keys[index] = key;
+	self->values[index] = value;
+	++self->size;
+	errno = 0;
+	return true;
+}
+
+bool im_put_sorted(IntMap *const self, const int64_t keys[],
+                   data_t *const values[], const size_t n) {
+	size_t added = 0;
+	for(size_t j = 0; j < n; ++j) {
+		if(j > 0 && keys[j - 1] >= keys[j]) {
+			errno = EINVAL;
+			return false;
+		}
+		const size_t index = self->search(self, keys[j]);
+		added += index == self->size || self->keys[index] != keys[j];
+	}
+	if(!im_reserve(self, self->size + added)) {
+		return false;
+	}
+	/* from the end, move the run of keys greater than the last key of the
+	   batch at once, then place the key of the batch */
+	size_t r = self->size, w = self->size + added;
+	const int64_t *base = self->keys;
+	for(size_t j = n; j-- > 0;) {
+		size_t s = 0, e = r;
+		while(s < e) {
+			const size_t m = s + (e - s) / 2;
+			if(base[m] <= keys[j]) {
+				s = m + 1;
+			} else {
+				e = m;
+			}
+		}
+		const size_t run = r - s;
+		w -= run;
+		memmove(self->keys + w, self->keys + s, run * sizeof(int64_t));
+		memmove(self->values + w, self->values + s, run * sizeof(data_t*));
+		r = s;
+		if(r > 0 && self->keys[r - 1] == keys[j]) {
+			/* already present: the key is moved with the next run */
+			self->values[r - 1] = values[j];
+		} else {
+			--w;
+			self->keys[w] = keys[j];
+			self->values[w] = values[j];
+		}
+	}
+	self->size += added;
+	errno = 0;
+	return true;
+}
+
+data_t *im_get(const IntMap *const self, const int64_t key) {
+	const size_t index = self->search(self, key);
+	if(index < self->size && self->keys[index] == key) {
+		return self->values[index];
+	}
+	return NULL;
+}
+
+bool im_contains(const IntMap *const self, const int64_t key) {
+	const size_t index = self->search(self, key);
+	return index < self->size && self->keys[index] == key;
+}
+
+ssize_t im_indexof(const IntMap *const self, const int64_t key) {
+	const size_t index = self->search(self, key);
+	if(index < self->size && self->keys[index] == key) {
+		return index;
+	}
+	return -1;
+}
+
+size_t im_lower_bound(const IntMap *const self, const int64_t key) {
+	return self->search(self, key);
+}
+
+int64_t im_key(const IntMap *const self, const size_t index) {
+	if(index >= self->size) {
+		errno = ERANGE;
+		return 0;
+	}
+	errno = 0;
+	return self->keys[index];
+}
+
+data_t *im_value(const IntMap *const self, const size_t index) {
+	if(index >= self->size) {
+		errno = ERANGE;
+		return NULL;
+	}
+	errno = 0;
+	return self->values[index];
+}
+
+data_t *im_remove(IntMap *const self, const int64_t key) {
+	const size_t index = self->search(self, key);
+	if(index == self->size || self->keys[index] != key) {
+		return NULL;
+	}
+	data_t *const value = self->values[index];
+	--self->size;
+	memmove(self->keys + index, self->keys + index + 1,
+	        (self->size - index) * sizeof(int64_t));
+	memmove(self->values + index, self->values + index + 1,
+	        (self->size - index) * sizeof(data_t*));
+	return value;
+}
@@ -0,0 +1,105 @@
+#include "intrusivelist.h"
+
+#include <stdlib.h> /* for NULL */
+
+
+
+static CODS_INLINE void il_link(IntrusiveNode *const prev,
+                                IntrusiveNode *const next,
+                                IntrusiveNode *const node) {
+	node->prev = prev;
+	node->next = next;
+	prev->next = node;
+	next->prev = node;
+}
+
+static CODS_INLINE void il_unlink(IntrusiveNode *const node) {
+	node->prev->next = node->next;
+	node->next->prev = node->prev;
+}
+
+
+void il_init(IntrusiveList *const self) {
+	self->head.prev = &self->head;
+	self->head.next = &self->head;
+	self->len = 0;
+}
+
+void il_node_init(IntrusiveNode *const node) {
+	node->prev = NULL;
+	node->next = NULL;
+}
+extern bool il_linked(const IntrusiveNode*);
+
+size_t il_len(const IntrusiveList *const self) {
+	return self->len;
+}
+
+IntrusiveNode *il_first(const IntrusiveList *const self) {
+	return self->len ? self->head.next : NULL;
+}
+
+IntrusiveNode *il_last(const IntrusiveList *const self) {
+	return self->len ? self->head.prev : NULL;
+}
+
+IntrusiveNode *il_next(const IntrusiveList *const self,
+                       const IntrusiveNode *const node) {
+	return node->next == &self->head ? NULL : node->next;
+}
+
+IntrusiveNode *il_prev(const IntrusiveList *const self,
+                       const IntrusiveNode *const node) {
+	return node->prev == &self->head ? NULL : node->prev;
+}
+
+void il_insert_before(IntrusiveList *const self, IntrusiveNode *const pos,
+                      IntrusiveNode *const node) {
+	il_link(pos->prev, pos, node);
+	++self->len;
+}
+
+void il_insert_after(IntrusiveList *const self, IntrusiveNode *const pos,
+                     IntrusiveNode *const node) {
+	il_link(pos, pos->next, node);
+	++self->len;
+}
+extern void il_push_front(IntrusiveList*, IntrusiveNode*);
+extern void il_push_back(IntrusiveList*, IntrusiveNode*);
+
+void il_remove(IntrusiveList *const self, IntrusiveNode *const node) {
+	il_unlink(node);
+	node->prev = NULL;
+	node->next = NULL;
+	--self->len;
+}
+
+IntrusiveNode *il_pop_front(IntrusiveList *const self) {
+	IntrusiveNode *const node = il_first(self);
+	if(node) {
+		il_remove(self, node);
+	}
+	return node;
+}
+
+IntrusiveNode *il_pop_back(IntrusiveList *const self) {
+	IntrusiveNode *const node = il_last(self);
+	if(node) {
+		il_remove(self, node);
+	}
+	return node;
+}
+
+void il_move_front(IntrusiveList *const self, IntrusiveNode *const node) {
+	if(self->head.next != node) {
+		il_unlink(node);
+		il_link(&self->head, self->head.next, node);
+	}
+}
+
+void il_move_back(IntrusiveList *const self, IntrusiveNode *const node) {
+	if(self->head.prev != node) {
+		il_unlink(node);
+		il_link(self->head.prev, &self->head, node);
+	}
+}
@@ -1,6 +1,6 @@
 #include "linkedlist.h"
 
-#include <errno.h> /* errno, ERANGE */
+#include <errno.h> /* errno, EINVAL, ERANGE */
 
 
 
@@ -14,6 +14,7 @@ struct node {
 
 struct llist {
 	Node *head;
+	Node *tail;
 	size_t len;
 };
 
@@ -43,20 +44,18 @@ LinkedList *ll_new(void) {
 	}
 	ll->len = 0;
 	ll->head = NULL;
+	ll->tail = NULL;
 	return ll;
 }
 
 void ll_freer(LinkedList *const ll, void (*const f)(data_t*)) {
-	if(ll->head) {
-		Node *item = ll->head, *next;
-		if(f != NULL)
-			for(next = ll->head->next; next != NULL; item = next, next = next->next) {
-				f(item->value);
-				free(item);
-			}
-		else
-			for(next = ll->head->next; next != NULL; item = next, next = next->next)
-				free(item);
+	Node *item = ll->head;
+	while(item) {
+		Node *const next = item->next;
+		if(f)
+			f(item->value);
+		free(item);
+		item = next;
 	}
 	free(ll);
 }
@@ -94,9 +93,18 @@ ssize_t ll_add(LinkedList *const ll, const size_t i, data_t *const d) {
 		return -1;
 	} else {
 		Node **plug;
-		plug = i == 0 ? &ll->head : &ll_goto(ll, i - 1)->next;
+		if(i == 0) {
+			plug = &ll->head;
+		} else if(i == ll->len) {
+			plug = &ll->tail->next;
+		} else {
+			plug = &ll_goto(ll, i - 1)->next;
+		}
 		item->next = *plug;
 		*plug = item;
+		if(i == ll->len) {
+			ll->tail = item;
+		}
 		++ll->len;
 		errno = 0;
 		return i;
@@ -109,14 +117,104 @@ data_t *ll_drop(LinkedList *const ll, const size_t i) {
 		errno = ERANGE;
 		return NULL;
 	}
-	Node *item, **plug;
+	Node *item, *prev, **plug;
 	data_t *d;
-	plug = i == 0 ? &ll->head : &ll_goto(ll, i - 1)->next;
+	prev = i == 0 ? NULL : ll_goto(ll, i - 1);
+	plug = prev ? &prev->next : &ll->head;
 	item = *plug;
 	d = item->value;
 	*plug = item->next;
+	if(item == ll->tail) {
+		ll->tail = prev;
+	}
 	--ll->len;
 	free(item);
 	errno = 0;
 	return d;
 }
+
+
+/* Merges two sorted chains of nodes; on equivalent values the node from a is
+   taken first, which makes the sort stable. */
+static Node *ll_merge(Node *a, Node *b,
+                      int (*const cmp)(const data_t*, const data_t*)) {
+	Node *head = NULL, **plug = &head;
+	while(a && b) {
+		if(cmp(a->value, b->value) <= 0) {
+			*plug = a;
+			a = a->next;
+		} else {
+			*plug = b;
+			b = b->next;
+		}
+		plug = &(*plug)->next;
+	}
+	*plug = a ? a : b;
+	return head;
+}
+
+void ll_sort(LinkedList *const ll,
+             int (*const cmp)(const data_t*, const data_t*)) {
+	/* bins[k] holds a sorted run of 2^k nodes, or NULL; the higher the bin,
+	   the older its nodes in the list order */
+	Node *bins[sizeof(size_t) * 8] = {NULL};
+	size_t used = 0;
+	Node *item = ll->head;
+	while(item) {
+		Node *carry = item;
+		item = item->next;
+		carry->next = NULL;
+		size_t k = 0;
+		for(; bins[k]; ++k) {
+			carry = ll_merge(bins[k], carry, cmp);
+			bins[k] = NULL;
+		}
+		bins[k] = carry;
+		if(k >= used) {
+			used = k + 1;
+		}
+	}
+	Node *sorted = NULL;
+	for(size_t k = 0; k < used; ++k) {
+		sorted = ll_merge(bins[k], sorted, cmp);
+	}
+	ll->head = sorted;
+	ll->tail = sorted;
+	if(sorted) {
+		while(ll->tail->next)
+			ll->tail = ll->tail->next;
+	}
+}
+
+void ll_splice(LinkedList *const dst, const size_t i, LinkedList *const src) {
+	if(dst == src) {
+		errno = EINVAL;
+		return;
+	}
+	if(i > dst->len) {
+		errno = ERANGE;
+		return;
+	}
+	errno = 0;
+	if(!src->head) {
+		return;
+	}
+	Node **plug;
+	if(i == 0) {
+		plug = &dst->head;
+	} else if(i == dst->len) {
+		plug = &dst->tail->next;
+	} else {
+		plug = &ll_goto(dst, i - 1)->next;
+	}
+	src->tail->next = *plug;
+	*plug = src->head;
+	if(i == dst->len) {
+		dst->tail = src->tail;
+	}
+	dst->len += src->len;
+	src->head = NULL;
+	src->tail = NULL;
+	src->len = 0;
+}
+extern void ll_concat(LinkedList*, LinkedList*);
@@ -0,0 +1,440 @@
+#include "persistentvector.h"
+
+#include <errno.h> /* for errno, ENOMEM, ERANGE */
+#include <stdint.h> /* for SIZE_MAX */
+#include <stdlib.h> /* for malloc(), calloc(), free() */
+#include <string.h> /* for memcpy() */
+
+
+
+extern int errno;
+
+/* The number of bits of an index used at each level of the trie, and the
+   number of slots of a node */
+#define PV_BITS 5
+#define PV_WIDTH (1 << PV_BITS)
+#define PV_MASK (PV_WIDTH - 1)
+
+/* The largest number of levels of the trie, the leaves excluded */
+#define PV_MAX_DEPTH ((sizeof(size_t) * 8 + PV_BITS - 1) / PV_BITS)
+
+/* A node holds elements if it is a leaf, i.e. at level 0, or else children */
+struct pvnode {
+	size_t refs; /* the number of versions, transients and nodes using it */
+	union {
+		struct pvnode *children[PV_WIDTH];
+		data_t *items[PV_WIDTH];
+	};
+};
+
+/* The elements before the tail are in the trie under root, whose level is
+   shift; both root and tail are NULL while empty */
+struct persistentvector {
+	struct pvnode *root;
+	struct pvnode *tail;
+	size_t size;
+	size_t shift;
+};
+
+/* A transient is laid out as a version, so that publishing it costs nothing */
+struct pvtransient {
+	PersistentVector vector;
+};
+
+
+/* The index of the first element of the tail */
+static CODS_INLINE size_t pv_tailoff(const size_t size) {
+	return size ? (size - 1) & ~(size_t)PV_MASK : 0;
+}
+
+/* A new node, used once, with no child */
+static struct pvnode *pv_node(void) {
+	struct pvnode *const node = calloc(1, sizeof(struct pvnode));
+	if(!node) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	node->refs = 1;
+	return node;
+}
+
+static void pv_release(struct pvnode *const node, const size_t level) {
+	if(!node || --node->refs) {
+		return;
+	}
+	if(level) {
+		for(size_t i = 0; i < PV_WIDTH; ++i) {
+			pv_release(node->children[i], level - PV_BITS);
+		}
+	}
+	free(node);
+}
+
+/* Makes the node in a slot owned by its holder alone, copying it if shared;
+   the holder itself must be owned */
+static struct pvnode *pv_own(struct pvnode **const slot, const size_t level) {
+	struct pvnode *const node = *slot;
+	if(node->refs == 1) {
+		return node;
+	}
+	struct pvnode *const copy = malloc(sizeof(struct pvnode));
+	if(!copy) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	copy->refs = 1;
+	memcpy(copy->children, node->children, sizeof(node->children));
+	if(level) {
+		for(size_t i = 0; i < PV_WIDTH; ++i) {
+			if(copy->children[i]) {
+				++copy->children[i]->refs;
+			}
+		}
+	}
+	--node->refs;
+	*slot = copy;
+	return copy;
+}
+
+/* The leaf holding an element of the trie */
+static const struct pvnode *pv_leaf(const PersistentVector *const self,
+                                    const size_t index) {
+	const struct pvnode *node = self->root;
+	for(size_t level = self->shift; level; level -= PV_BITS) {
+		node = node->children[(index >> level) & PV_MASK];
+	}
+	return node;
+}
+
+/* A branch of new nodes from a level down to a leaf */
+static struct pvnode *pv_path(const size_t level, struct pvnode *const leaf) {
+	if(!level) {
+		return leaf;
+	}
+	struct pvnode *const top = pv_node();
+	struct pvnode *node = top;
+	for(size_t l = level; node && l > PV_BITS; l -= PV_BITS) {
+		node = node->children[0] = pv_node();
+	}
+	if(!node) {
+		for(struct pvnode *next = top; next;) {
+			node = next;
+			next = node->children[0];
+			free(node);
+		}
+		return NULL;
+	}
+	node->children[0] = leaf;
+	return top;
+}
+
+/* Moves the full tail into the trie, at its end; the tail is left in place on
+   failure */
+static bool pv_pushtail(PersistentVector *const self) {
+	struct pvnode *const leaf = self->tail;
+	const size_t last = self->size - 1;
+	if(!self->root) {
+		struct pvnode *const root = pv_node();
+		if(!root) {
+			return false;
+		}
+		root->children[0] = leaf;
+		self->root = root;
+		self->shift = PV_BITS;
+		return true;
+	}
+	/* the trie is full: it becomes the first child of a new root */
+	if((self->size >> PV_BITS) > ((size_t)1 << self->shift)) {
+		struct pvnode *const root = pv_node();
+		struct pvnode *const path = root ? pv_path(self->shift, leaf) : NULL;
+		if(!path) {
+			free(root);
+			return false;
+		}
+		root->children[0] = self->root;
+		root->children[1] = path;
+		self->root = root;
+		self->shift += PV_BITS;
+		return true;
+	}
+	struct pvnode **slot = &self->root;
+	for(size_t level = self->shift;; level -= PV_BITS) {
+		struct pvnode *const node = pv_own(slot, level);
+		if(!node) {
+			return false;
+		}
+		slot = &node->children[(last >> level) & PV_MASK];
+		if(level == PV_BITS) {
+			*slot = leaf;
+			return true;
+		}
+		if(!*slot) {
+			*slot = pv_path(level - PV_BITS, leaf);
+			return *slot != NULL;
+		}
+	}
+}
+
+/* Moves the last leaf of the trie to the tail, in place of the tail holding a
+   single element; the trie is left unchanged on failure */
+static bool pv_poptail(PersistentVector *const self) {
+	const size_t last = self->size - 2;
+	struct pvnode *path[PV_MAX_DEPTH];
+	struct pvnode **slot = &self->root;
+	size_t depth = 0;
+	for(size_t level = self->shift;; level -= PV_BITS) {
+		if(!(path[depth++] = pv_own(slot, level))) {
+			return false;
+		}
+		if(level == PV_BITS) {
+			break;
+		}
+		slot = &path[depth - 1]->children[(last >> level) & PV_MASK];
+	}
+	pv_release(self->tail, 0);
+	self->tail = path[depth - 1]->children[last >> PV_BITS & PV_MASK];
+	path[depth - 1]->children[last >> PV_BITS & PV_MASK] = NULL;
+	/* the nodes whose first child was removed are now empty */
+	size_t level = PV_BITS;
+	while(depth && !((last >> level) & PV_MASK)) {
+		free(path[--depth]);
+		if(depth) {
+			level += PV_BITS;
+			path[depth - 1]->children[(last >> level) & PV_MASK] = NULL;
+		}
+	}
+	if(!depth) {
+		self->root = NULL;
+		self->shift = PV_BITS;
+	} else if(self->shift > PV_BITS && !self->root->children[1]) {
+		struct pvnode *const root = self->root;
+		self->root = root->children[0];
+		self->shift -= PV_BITS;
+		free(root);
+	}
+	return true;
+}
+
+static PersistentVector *pv_share(const PersistentVector *const self,
+                                  const size_t size) {
+	PersistentVector *const copy = malloc(size);
+	if(!copy) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	*copy = *self;
+	if(copy->root) {
+		++copy->root->refs;
+	}
+	if(copy->tail) {
+		++copy->tail->refs;
+	}
+	errno = 0;
+	return copy;
+}
+
+
+PersistentVector *pv_new(void) {
+	PersistentVector *const self = malloc(sizeof(PersistentVector));
+	if(!self) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	self->root = NULL;
+	self->tail = NULL;
+	self->size = 0;
+	self->shift = PV_BITS;
+	errno = 0;
+	return self;
+}
+
+PersistentVector *pv_from_array(const Array *const array) {
+	PersistentVector *const empty = pv_new();
+	if(!empty) {
+		return NULL;
+	}
+	PVTransient *const transient = pv_transient(empty);
+	pv_free(empty);
+	if(!transient) {
+		return NULL;
+	}
+	for(size_t i = 0; i < a_size(array); ++i) {
+		if(!pv_transient_push(transient, a_get(array, i))) {
+			pv_transient_free(transient);
+			errno = ENOMEM;
+			return NULL;
+		}
+	}
+	return pv_persistent(transient);
+}
+
+void pv_free(PersistentVector *const self) {
+	pv_release(self->root, self->shift);
+	pv_release(self->tail, 0);
+	free(self);
+}
+
+PersistentVector *pv_copy(const PersistentVector *const self) {
+	return pv_share(self, sizeof(PersistentVector));
+}
+
+size_t pv_size(const PersistentVector *const self) {
+	return self->size;
+}
+
+data_t *pv_get(const PersistentVector *const self, const size_t index) {
+	if(index >= self->size) {
+		errno = ERANGE;
+		return NULL;
+	}
+	errno = 0;
+	if(index >= pv_tailoff(self->size)) {
+		return self->tail->items[index & PV_MASK];
+	}
+	return pv_leaf(self, index)->items[index & PV_MASK];
+}
+
+PersistentVector *pv_set(const PersistentVector *const self, const size_t index,
+                         data_t *const element) {
+	PVTransient *const transient = pv_transient(self);
+	if(!transient) {
+		return NULL;
+	}
+	if(!pv_transient_set(transient, index, element)) {
+		const int error = errno;
+		pv_transient_free(transient);
+		errno = error;
+		return NULL;
+	}
+	return pv_persistent(transient);
+}
+
+PersistentVector *pv_push(const PersistentVector *const self,
+                          data_t *const element) {
+	PVTransient *const transient = pv_transient(self);
+	if(!transient) {
+		return NULL;
+	}
+	if(!pv_transient_push(transient, element)) {
+		pv_transient_free(transient);
+		errno = ENOMEM;
+		return NULL;
+	}
+	return pv_persistent(transient);
+}
+
+PersistentVector *pv_pop(const PersistentVector *const self) {
+	PVTransient *const transient = pv_transient(self);
+	if(!transient) {
+		return NULL;
+	}
+	pv_transient_pop(transient);
+	if(errno) {
+		const int error = errno;
+		pv_transient_free(transient);
+		errno = error;
+		return NULL;
+	}
+	return pv_persistent(transient);
+}
+
+PVTransient *pv_transient(const PersistentVector *const self) {
+	return (PVTransient*)pv_share(self, sizeof(PVTransient));
+}
+
+PersistentVector *pv_persistent(PVTransient *const self) {
+	return &self->vector;
+}
+
+void pv_transient_free(PVTransient *const self) {
+	pv_free(&self->vector);
+}
+
+size_t pv_transient_size(const PVTransient *const self) {
+	return self->vector.size;
+}
+
+data_t *pv_transient_get(const PVTransient *const self, const size_t index) {
+	return pv_get(&self->vector, index);
+}
+
+bool pv_transient_set(PVTransient *const self, const size_t index,
+                      data_t *const element) {
+	PersistentVector *const vector = &self->vector;
+	if(index >= vector->size) {
+		errno = ERANGE;
+		return false;
+	}
+	if(index >= pv_tailoff(vector->size)) {
+		struct pvnode *const tail = pv_own(&vector->tail, 0);
+		if(!tail) {
+			return false;
+		}
+		tail->items[index & PV_MASK] = element;
+		errno = 0;
+		return true;
+	}
+	struct pvnode **slot = &vector->root;
+	for(size_t level = vector->shift;; level -= PV_BITS) {
+		struct pvnode *const node = pv_own(slot, level);
+		if(!node) {
+			return false;
+		}
+		if(!level) {
+			node->items[index & PV_MASK] = element;
+			errno = 0;
+			return true;
+		}
+		slot = &node->children[(index >> level) & PV_MASK];
+	}
+}
+
+bool pv_transient_push(PVTransient *const self, data_t *const element) {
+	PersistentVector *const vector = &self->vector;
+	const size_t count = vector->size - pv_tailoff(vector->size);
+	if(vector->size == SIZE_MAX) {
+		errno = ENOMEM;
+		return false;
+	}
+	if(vector->tail && count < PV_WIDTH) {
+		struct pvnode *const tail = pv_own(&vector->tail, 0);
+		if(!tail) {
+			return false;
+		}
+		tail->items[count] = element;
+	} else {
+		struct pvnode *const tail = pv_node();
+		if(!tail) {
+			return false;
+		}
+		if(vector->tail && !pv_pushtail(vector)) {
+			free(tail);
+			return false;
+		}
+		tail->items[0] = element;
+		vector->tail = tail;
+	}
+	++vector->size;
+	errno = 0;
+	return true;
+}
+
+data_t *pv_transient_pop(PVTransient *const self) {
+	PersistentVector *const vector = &self->vector;
+	if(!vector->size) {
+		errno = ERANGE;
+		return NULL;
+	}
+	const size_t count = vector->size - pv_tailoff(vector->size);
+	data_t *const element = vector->tail->items[count - 1];
+	/* the tail is left as is, even if shared: the size hides the element */
+	if(vector->size == 1) {
+		pv_release(vector->tail, 0);
+		vector->tail = NULL;
+	} else if(count == 1 && !pv_poptail(vector)) {
+		return NULL;
+	}
+	--vector->size;
+	errno = 0;
+	return element;
+}
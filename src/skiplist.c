@@ -0,0 +1,317 @@
+#include "skiplist.h"
+
+#include <errno.h> /* for errno, EINVAL, ENOMEM, ERANGE */
+#include <stdbool.h>
+#include <stdint.h> /* for uint64_t, SIZE_MAX */
+
+
+
+extern int errno;
+
+/* The maximal number of levels of a node; with a probability of 1/4 to rise a
+   level, this is enough for any list that fits in memory */
+#define SL_MAX_LEVEL 32
+
+/* The size of the first chunk of the pool, when no size hint is usable */
+#define SL_MIN_CHUNK 4096
+
+typedef struct slnode SLNode;
+
+struct sllink {
+	SLNode *next;
+	size_t span; /* the number of positions between the node and next */
+};
+
+struct slnode {
+	data_t *value;
+	size_t level;
+	struct sllink links[];
+};
+
+/* A chunk of memory the nodes are carved from */
+struct slchunk {
+	struct slchunk *next;
+	size_t size;
+	size_t used;
+	size_t data[]; /* size_t has the alignment of the nodes */
+};
+
+/* The head node stands at position 0; an element at index i is at position
+   i + 1. The span of a link whose next is NULL is the number of positions
+   remaining until the end of the list. */
+struct skiplist {
+	int (*cmp)(const data_t*, const data_t*);
+	size_t size;
+	size_t level;
+	uint64_t seed;
+	SLNode *head;
+	struct slchunk *chunks;
+	SLNode *recycled[SL_MAX_LEVEL]; /* free nodes, by level */
+};
+
+
+static CODS_INLINE size_t sl_nodesize(const size_t level) {
+	return sizeof(SLNode) + level * sizeof(struct sllink);
+}
+
+static size_t sl_randomlevel(SkipList *const self) {
+	/* xorshift64* */
+	self->seed ^= self->seed >> 12;
+	self->seed ^= self->seed << 25;
+	self->seed ^= self->seed >> 27;
+	uint64_t r = self->seed * UINT64_C(2685821657736338717);
+	size_t level = 1;
+	while(!(r & 3) && level < SL_MAX_LEVEL) {
+		++level;
+		r >>= 2;
+	}
+	return level;
+}
+
+static bool sl_grow(SkipList *const self, const size_t bytes) {
+	size_t size = self->chunks ? 2 * self->chunks->size : SL_MIN_CHUNK;
+	if(size < bytes) {
+		size = bytes;
+	}
+	struct slchunk *const chunk = malloc(sizeof(struct slchunk) + size);
+	if(!chunk) {
+		return false;
+	}
+	chunk->next = self->chunks;
+	chunk->size = size;
+	chunk->used = 0;
+	self->chunks = chunk;
+	return true;
+}
+
+static SLNode *sl_newnode(SkipList *const self, const size_t level) {
+	SLNode *node = self->recycled[level - 1];
+	if(node) {
+		self->recycled[level - 1] = node->links[0].next;
+		return node;
+	}
+	const size_t bytes = sl_nodesize(level);
+	if((!self->chunks || self->chunks->size - self->chunks->used < bytes)
+	   && !sl_grow(self, bytes)) {
+		return NULL;
+	}
+	node = (SLNode*)((char*)self->chunks->data + self->chunks->used);
+	self->chunks->used += bytes;
+	node->level = level;
+	return node;
+}
+
+static CODS_INLINE void sl_recycle(SkipList *const self, SLNode *const node) {
+	node->links[0].next = self->recycled[node->level - 1];
+	self->recycled[node->level - 1] = node;
+}
+
+/* Finds the last node of each level preceding the given value, and its
+   position. Returns the node following the one at level 0. */
+static SLNode *sl_search(const SkipList *const self, const data_t *const value,
+                         SLNode *update[], size_t positions[]) {
+	SLNode *node = self->head;
+	size_t pos = 0;
+	for(size_t i = self->level; i-- > 0;) {
+		SLNode *next;
+		while((next = node->links[i].next)
+		      && self->cmp(next->value, value) < 0) {
+			pos += node->links[i].span;
+			node = next;
+		}
+		if(update) {
+			update[i] = node;
+			positions[i] = pos;
+		}
+	}
+	return node->links[0].next;
+}
+
+/* Finds the last node of each level preceding the given position */
+static void sl_seek(const SkipList *const self, const size_t target,
+                    SLNode *update[]) {
+	SLNode *node = self->head;
+	size_t pos = 0;
+	for(size_t i = self->level; i-- > 0;) {
+		while(node->links[i].next && pos + node->links[i].span < target) {
+			pos += node->links[i].span;
+			node = node->links[i].next;
+		}
+		update[i] = node;
+	}
+}
+
+static void sl_unlink(SkipList *const self, SLNode *const node,
+                      SLNode *update[]) {
+	for(size_t i = 0; i < self->level; ++i) {
+		if(update[i]->links[i].next == node) {
+			update[i]->links[i].span += node->links[i].span - 1;
+			update[i]->links[i].next = node->links[i].next;
+		} else {
+			--update[i]->links[i].span;
+		}
+	}
+	while(self->level > 1 && !self->head->links[self->level - 1].next) {
+		--self->level;
+	}
+	--self->size;
+	sl_recycle(self, node);
+}
+
+
+SkipList *sl_new(const size_t size,
+                 int (*const cmp)(const data_t*, const data_t*)) {
+	if(!size) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if(size > (SIZE_MAX - sizeof(struct slchunk)) / sl_nodesize(2)) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	SkipList *const self = malloc(sizeof(SkipList));
+	if(!self) {
+		return NULL;
+	}
+	self->head = malloc(sl_nodesize(SL_MAX_LEVEL));
+	if(!self->head) {
+		free(self);
+		return NULL;
+	}
+	self->head->value = NULL;
+	self->head->level = SL_MAX_LEVEL;
+	for(size_t i = 0; i < SL_MAX_LEVEL; ++i) {
+		self->head->links[i].next = NULL;
+		self->head->links[i].span = 0;
+		self->recycled[i] = NULL;
+	}
+	self->chunks = NULL;
+	/* a node has 4/3 links on average */
+	if(!sl_grow(self, size * sl_nodesize(2))) {
+		free(self->head);
+		free(self);
+		return NULL;
+	}
+	self->cmp = cmp;
+	self->size = 0;
+	self->level = 1;
+	self->seed = UINT64_C(0x9E3779B97F4A7C15);
+	errno = 0;
+	return self;
+}
+
+void sl_free(SkipList *const self) {
+	struct slchunk *chunk = self->chunks;
+	while(chunk) {
+		struct slchunk *const next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+	free(self->head);
+	free(self);
+}
+
+size_t sl_size(const SkipList *const self) {
+	return self->size;
+}
+
+ssize_t sl_add(SkipList *const self, data_t *const item) {
+	SLNode *update[SL_MAX_LEVEL];
+	size_t positions[SL_MAX_LEVEL];
+	const SLNode *const found = sl_search(self, item, update, positions);
+	if(found && self->cmp(found->value, item) == 0) {
+		return -1;
+	}
+	const size_t level = sl_randomlevel(self);
+	SLNode *const node = sl_newnode(self, level);
+	if(!node) {
+		return -1;
+	}
+	for(size_t i = self->level; i < level; ++i) {
+		update[i] = self->head;
+		positions[i] = 0;
+		self->head->links[i].span = self->size;
+	}
+	if(level > self->level) {
+		self->level = level;
+	}
+	node->value = item;
+	for(size_t i = 0; i < level; ++i) {
+		const size_t before = positions[0] - positions[i];
+		node->links[i].next = update[i]->links[i].next;
+		node->links[i].span = update[i]->links[i].span - before;
+		update[i]->links[i].next = node;
+		update[i]->links[i].span = before + 1;
+	}
+	for(size_t i = level; i < self->level; ++i) {
+		++update[i]->links[i].span;
+	}
+	++self->size;
+	errno = 0;
+	return positions[0];
+}
+
+data_t *sl_get(const SkipList *const self, const size_t index) {
+	if(index >= self->size) {
+		errno = ERANGE;
+		return NULL;
+	}
+	const size_t target = index + 1;
+	const SLNode *node = self->head;
+	size_t pos = 0;
+	for(size_t i = self->level; i-- > 0;) {
+		while(node->links[i].next && pos + node->links[i].span <= target) {
+			pos += node->links[i].span;
+			node = node->links[i].next;
+		}
+		if(pos == target) {
+			break;
+		}
+	}
+	errno = 0;
+	return node->value;
+}
+
+ssize_t sl_indexof(const SkipList *const self, const data_t *const value) {
+	SLNode *update[SL_MAX_LEVEL];
+	size_t positions[SL_MAX_LEVEL];
+	const SLNode *const found = sl_search(self, value, update, positions);
+	if(found && self->cmp(found->value, value) == 0) {
+		return positions[0];
+	}
+	return -1;
+}
+
+data_t *sl_geteq(const SkipList *const self, const data_t *const other) {
+	const SLNode *const found = sl_search(self, other, NULL, NULL);
+	if(found && self->cmp(found->value, other) == 0) {
+		return found->value;
+	}
+	return NULL;
+}
+
+data_t *sl_drop(SkipList *const self, const size_t index) {
+	if(index >= self->size) {
+		errno = ERANGE;
+		return NULL;
+	}
+	SLNode *update[SL_MAX_LEVEL];
+	sl_seek(self, index + 1, update);
+	SLNode *const node = update[0]->links[0].next;
+	data_t *const value = node->value;
+	sl_unlink(self, node, update);
+	errno = 0;
+	return value;
+}
+
+data_t *sl_remove(SkipList *const self, const data_t *const other) {
+	SLNode *update[SL_MAX_LEVEL];
+	size_t positions[SL_MAX_LEVEL];
+	SLNode *const found = sl_search(self, other, update, positions);
+	if(!found || self->cmp(found->value, other) != 0) {
+		return NULL;
+	}
+	data_t *const value = found->value;
+	sl_unlink(self, found, update);
+	return value;
+}
@@ -1,20 +1,237 @@
 #include "sortedarray.h"
 
 #include <clog.h>
+#include <errno.h> /* for errno, EINVAL, ENOMEM, ERANGE */
+#include <stdint.h> /* for uint64_t, SIZE_MAX */
+#include <stdlib.h> /* for aligned_alloc(), calloc(), free() */
+#include <string.h> /* for memcpy(), memmove(), memset() */
 
 #include "array.h"
+#include "bitarray.h"
 
 
 
+/* The number of levels of the frozen layout loaded ahead of the search: the
+   descendants of a slot this many levels below span two cache lines */
+#define SA_PREFETCH_LEVELS 4
+#define SA_PREFETCH_SLOTS ((size_t)1 << SA_PREFETCH_LEVELS)
+
 struct sortedarray {
 	Array *array;
 	int (*cmp)(const data_t*, const data_t*);
+	data_t **frozen; /* the elements in Eytzinger order, or NULL */
+	size_t *indices; /* the index in the array of each slot of frozen */
+	uint64_t (*prefix)(const data_t*); /* the key prefix function, or NULL */
+	uint64_t *prefixes; /* the key prefix of each element, or NULL */
+	size_t capacity; /* the number of prefixes allocated */
+	data_t **pending; /* the sorted insert buffer, or NULL */
+	size_t *pending_at; /* the index in the array each pending item goes to */
+	BitArray *dead; /* a bit set for each removed element of the array */
+	size_t *deadtree; /* the removed elements by block, as a Fenwick tree */
+	size_t npending, ntombstones;
+	size_t threshold; /* npending + ntombstones that triggers a merge */
+	size_t deadratio; /* the percentage of removed slots that triggers a
+	                     compaction, or 0 without lazy removal */
 };
 
+/* The number of slots of the array counted together in the Fenwick tree of the
+   removed elements; inside a block, the marks are counted in the BitArray */
+#define SA_DEAD_BLOCK 64
+
+/* Finds the index of the first prefix not less than the key, among n prefixes
+   (n > 0); the loop only computes the next base, without branching, and loads
+   both possible next probes ahead */
+static CODS_INLINE size_t _sa_prefixlower(const uint64_t *const prefixes,
+                                          size_t n, const uint64_t key) {
+	const uint64_t *base = prefixes;
+	while(n > 1) {
+		const size_t half = n / 2;
+		CODS_PREFETCH(base + half / 2);
+		CODS_PREFETCH(base + half + half / 2);
+		base += (base[half - 1] < key) * half;
+		n -= half;
+	}
+	return base - prefixes + (*base < key);
+}
+
+/* Finds the index of the first prefix greater than the key, among n prefixes
+   whose first one is not less than the key; since few prefixes are expected to
+   be equal, the search gallops from the start */
+static size_t _sa_prefixupper(const uint64_t *const prefixes, const size_t n,
+                              const uint64_t key) {
+	size_t lo = 0, hi = 0, step = 1;
+	while(hi < n && prefixes[hi] <= key) {
+		lo = hi + 1;
+		hi += step;
+		step *= 2;
+	}
+	if(hi > n) {
+		hi = n;
+	}
+	while(lo < hi) {
+		const size_t m = lo + (hi - lo) / 2;
+		if(prefixes[m] <= key) {
+			lo = m + 1;
+		} else {
+			hi = m;
+		}
+	}
+	return lo;
+}
+
+/* Narrows the range [*s, *e) of the elements to compare with the item to the
+   elements whose key prefix equals the prefix of the item */
+static void _sa_prefixrange(const SortedArray *const self,
+                            const data_t *const item, size_t *const s,
+                            size_t *const e) {
+	if(!self->prefixes || *s == *e) {
+		return;
+	}
+	const uint64_t key = self->prefix(item);
+	*s += _sa_prefixlower(self->prefixes + *s, *e - *s, key);
+	*e = *s + _sa_prefixupper(self->prefixes + *s, *e - *s, key);
+}
+
+/* Ensures the prefixes can hold n elements */
+static bool _sa_reserve(SortedArray *const self, const size_t n) {
+	if(!self->prefixes || n <= self->capacity) {
+		return true;
+	}
+	const size_t capacity = 2 * self->capacity > n ? 2 * self->capacity : n;
+	uint64_t *const prefixes = realloc(self->prefixes,
+	                                   capacity * sizeof(uint64_t));
+	if(!prefixes) {
+		errno = ENOMEM;
+		return false;
+	}
+	self->prefixes = prefixes;
+	self->capacity = capacity;
+	return true;
+}
+
+/* Inserts an element at the given index of the array, and its key prefix */
+static ssize_t _sa_insert(SortedArray *const self, const size_t index,
+                          data_t *const item) {
+	const size_t size = a_size(self->array);
+	if(!_sa_reserve(self, size + 1) || a_add(self->array, index, item) < 0) {
+		return -1;
+	}
+	if(self->prefixes) {
+		memmove(self->prefixes + index + 1, self->prefixes + index,
+		        (size - index) * sizeof(uint64_t));
+		self->prefixes[index] = self->prefix(item);
+	}
+	return index;
+}
+
+static CODS_INLINE size_t _sa_deadblocks(const SortedArray *const self) {
+	return (ba_size(self->dead) + SA_DEAD_BLOCK - 1) / SA_DEAD_BLOCK;
+}
+
+/* Counts the removed elements of the array before the given index */
+static size_t _sa_tombsbefore(const SortedArray *const self, const size_t i) {
+	if(!self->ntombstones) {
+		return 0;
+	}
+	const size_t block = i / SA_DEAD_BLOCK;
+	size_t count = ba_count_range(self->dead, block * SA_DEAD_BLOCK, i);
+	for(size_t b = block; b > 0; b &= b - 1) {
+		count += self->deadtree[b];
+	}
+	return count;
+}
+
+static CODS_INLINE bool _sa_istomb(const SortedArray *const self,
+                                   const size_t i) {
+	return self->ntombstones && i < ba_size(self->dead)
+	       && ba_get(self->dead, i);
+}
+
+/* The number of the elements of the array before the given index that are not
+   removed; with the insert buffer, the index of an element of the array in the
+   sorted array is its live index plus the number of pending items before it */
+static CODS_INLINE size_t _sa_live(const SortedArray *const self,
+                                   const size_t i) {
+	return i - _sa_tombsbefore(self, i);
+}
+
+/* Finds the index of the k-th element of the array that is not removed */
+static size_t _sa_selectlive(const SortedArray *const self, size_t k) {
+	if(!self->ntombstones) {
+		return k;
+	}
+	/* descend the Fenwick tree to the block holding the element, each node
+	   covering as many blocks as its lowest bit */
+	const size_t nblocks = _sa_deadblocks(self);
+	size_t step = 1, block = 0;
+	while(2 * step <= nblocks) {
+		step *= 2;
+	}
+	for(; step; step /= 2) {
+		const size_t next = block + step;
+		if(next <= nblocks) {
+			const size_t live = step * SA_DEAD_BLOCK - self->deadtree[next];
+			if(live <= k) {
+				block = next;
+				k -= live;
+			}
+		}
+	}
+	size_t i = block * SA_DEAD_BLOCK;
+	while(ba_get(self->dead, i) || k--) {
+		++i;
+	}
+	return i;
+}
+
+/* The index of the first element of the array not removed from the given
+   index on, or the size of the array */
+static size_t _sa_nextlive(const SortedArray *const self, const size_t i) {
+	if(!_sa_istomb(self, i)) {
+		return i;
+	}
+	const size_t k = _sa_live(self, i);
+	return k < a_size(self->array) - self->ntombstones ? _sa_selectlive(self, k)
+	                                                   : a_size(self->array);
+}
+
+/* Finds the index of the first element of the array not removed and not less
+   than the item, and whether it is equivalent to the item; a removed element
+   may have been freed, so the probes are moved onto the following element not
+   removed, and no removed element is ever compared */
+static size_t _sa_livebound(const SortedArray *const self,
+                            const data_t *const item, bool *const found) {
+	size_t s = 0, e = a_size(self->array);
+	_sa_prefixrange(self, item, &s, &e);
+	while(s < e) {
+		const size_t m = _sa_nextlive(self, s + (e - s) / 2);
+		if(m >= e) {
+			/* the upper half of the range is only removed elements */
+			e = s + (e - s) / 2;
+		} else if(self->cmp(a_get(self->array, m), item) < 0) {
+			s = m + 1;
+		} else {
+			e = m;
+		}
+	}
+	s = _sa_nextlive(self, s);
+	*found = s < a_size(self->array)
+	         && self->cmp(a_get(self->array, s), item) == 0;
+	return s;
+}
+
 static ssize_t _sa_binsearch(const SortedArray *const self,
                              const data_t *const item, size_t *const end) {
+	if(self->ntombstones) {
+		bool found;
+		const size_t s = _sa_livebound(self, item, &found);
+		if(end)
+			*end = s;
+		return found ? (ssize_t)s : -1;
+	}
 	size_t s = 0, e = a_size(self->array);
 	ssize_t i = -1;
+	_sa_prefixrange(self, item, &s, &e);
 	while (i < 0 && s < e) {
 		const size_t m = (s + e) / 2;
 		const int d = self->cmp(item, a_get(self->array, m));
@@ -31,6 +248,535 @@ static ssize_t _sa_binsearch(const SortedArray *const self,
 	return i;
 }
 
+/* Fills the slots of the subtree rooted at k with the elements from index i,
+   in order; returns the index following the last element used */
+static size_t _sa_eytzinger(const SortedArray *const self,
+                            data_t **const slots, size_t *const indices,
+                            size_t i,
+                            const size_t k, const size_t n) {
+	if(k <= n) {
+		i = _sa_eytzinger(self, slots, indices, i, 2 * k, n);
+		slots[k] = a_get(self->array, i);
+		indices[k] = i;
+		i = _sa_eytzinger(self, slots, indices, i + 1, 2 * k + 1, n);
+	}
+	return i;
+}
+
+/* Searches the frozen layout for the index of the first element not less than
+   the item, and whether it is equivalent; the descent has no branch depending
+   on the comparisons, and the slots a few levels below are fetched ahead */
+static size_t _sa_frozenbound(const SortedArray *const self,
+                              const data_t *const item, bool *const found) {
+	data_t *const *const slots = self->frozen;
+	const size_t n = a_size(self->array);
+	size_t k = 1;
+	while(k <= n) {
+		/* only the slots of the layout are loaded ahead, the deepest levels
+		   having no descendants that far down */
+		if(k <= n / SA_PREFETCH_SLOTS) {
+			const size_t ahead = k * SA_PREFETCH_SLOTS;
+			CODS_PREFETCH(slots + ahead);
+			if(ahead + SA_PREFETCH_SLOTS / 2 <= n) {
+				CODS_PREFETCH(slots + ahead + SA_PREFETCH_SLOTS / 2);
+			}
+		}
+		k = 2 * k + (self->cmp(slots[k], item) < 0);
+	}
+	/* undo the right turns following the last left turn, which leads to the
+	   first slot not less than the item */
+	while(k & 1) {
+		k >>= 1;
+	}
+	k >>= 1;
+	if(!k) {
+		*found = false;
+		return n;
+	}
+	*found = self->cmp(slots[k], item) == 0;
+	return self->indices[k];
+}
+
+/* Finds the index of the first element of the array not less than the item,
+   and whether it is equivalent to the item, ignoring the insert buffer */
+static size_t _sa_arraybound(const SortedArray *const self,
+                             const data_t *const item, bool *const found) {
+	if(self->frozen) {
+		return _sa_frozenbound(self, item, found);
+	}
+	if(self->ntombstones) {
+		return _sa_livebound(self, item, found);
+	}
+	size_t s = 0, e = a_size(self->array);
+	_sa_prefixrange(self, item, &s, &e);
+	while(s < e) {
+		const size_t m = s + (e - s) / 2;
+		if(self->cmp(a_get(self->array, m), item) < 0) {
+			s = m + 1;
+		} else {
+			e = m;
+		}
+	}
+	*found = s < a_size(self->array)
+	         && self->cmp(a_get(self->array, s), item) == 0;
+	return s;
+}
+
+/* Marks the element of the array at the given index as removed; the marks are
+   allocated along with the first one, when the array has none */
+static bool _sa_mark(SortedArray *const self, const size_t i) {
+	const size_t size = a_size(self->array);
+	if(!self->ntombstones && (!self->dead || ba_size(self->dead) < size)) {
+		if(self->dead) {
+			ba_free(self->dead);
+		}
+		free(self->deadtree);
+		self->deadtree = NULL;
+		self->dead = ba_new(size);
+		if(self->dead) {
+			self->deadtree = calloc(_sa_deadblocks(self) + 1, sizeof(size_t));
+		}
+		if(!self->deadtree) {
+			ba_free(self->dead);
+			self->dead = NULL;
+			errno = ENOMEM;
+			return false;
+		}
+	}
+	ba_set(self->dead, i);
+	const size_t nblocks = _sa_deadblocks(self);
+	for(size_t b = i / SA_DEAD_BLOCK + 1; b <= nblocks; b += b & -b) {
+		++self->deadtree[b];
+	}
+	++self->ntombstones;
+	return true;
+}
+
+/* Places an element in a removed slot of the array, whose neighbors keep the
+   array sorted */
+static void _sa_revive(SortedArray *const self, const size_t i,
+                       data_t *const item) {
+	a_set(self->array, i, item);
+	if(self->prefixes) {
+		self->prefixes[i] = self->prefix(item);
+	}
+	ba_unset(self->dead, i);
+	const size_t nblocks = _sa_deadblocks(self);
+	for(size_t b = i / SA_DEAD_BLOCK + 1; b <= nblocks; b += b & -b) {
+		--self->deadtree[b];
+	}
+	--self->ntombstones;
+}
+
+/* Finds the index of the first pending item not less than the item */
+static size_t _sa_pendingbound(const SortedArray *const self,
+                               const data_t *const item, bool *const found) {
+	size_t s = 0, e = self->npending;
+	while(s < e) {
+		const size_t m = s + (e - s) / 2;
+		if(self->cmp(self->pending[m], item) < 0) {
+			s = m + 1;
+		} else {
+			e = m;
+		}
+	}
+	*found = s < self->npending && self->cmp(self->pending[s], item) == 0;
+	return s;
+}
+
+/* Counts the pending items before the element of the given index in the sorted
+   array, or finds the pending item with this index; the index of the j-th
+   pending item is j plus the number of live elements of the array before it */
+static size_t _sa_pendingrank(const SortedArray *const self,
+                              const size_t index, bool *const pending) {
+	size_t s = 0, e = self->npending;
+	while(s < e) {
+		const size_t m = s + (e - s) / 2;
+		if(m + _sa_live(self, self->pending_at[m]) < index) {
+			s = m + 1;
+		} else {
+			e = m;
+		}
+	}
+	*pending = s < self->npending
+	           && s + _sa_live(self, self->pending_at[s]) == index;
+	return s;
+}
+
+/* Finds the index of the first element not less than the item, and whether it
+   is equivalent to the item */
+static size_t _sa_lowerbound(const SortedArray *const self,
+                             const data_t *const item, bool *const found) {
+	const size_t i = _sa_arraybound(self, item, found);
+	if(!self->npending && !self->ntombstones) {
+		return i;
+	}
+	bool pending;
+	const size_t j = _sa_pendingbound(self, item, &pending);
+	*found = pending || (*found && !_sa_istomb(self, i));
+	return _sa_live(self, i) + j;
+}
+
+/* Merges sorted items, none of them equivalent to an element, into the array in
+   a single pass; on failure, the array is left unchanged */
+static bool _sa_merge(SortedArray *const self, data_t *const items[],
+                      const size_t n) {
+	/* make room at the end of the array, then merge from the end */
+	const size_t size = a_size(self->array);
+	if(!_sa_reserve(self, size + n)) {
+		return false;
+	}
+	for(size_t k = 0; k < n; ++k) {
+		if(a_append(self->array, items[k]) < 0) {
+			while(k-- > 0) {
+				a_drop(self->array, size + k);
+			}
+			errno = ENOMEM;
+			return false;
+		}
+	}
+	size_t w = size + n, r = size, k = n;
+	while(k > 0) {
+		data_t *const last = r ? a_get(self->array, r - 1) : NULL;
+		if(r && self->cmp(last, items[k - 1]) > 0) {
+			a_set(self->array, --w, last);
+			if(self->prefixes) {
+				self->prefixes[w] = self->prefixes[r - 1];
+			}
+			--r;
+		} else {
+			a_set(self->array, --w, items[--k]);
+			if(self->prefixes) {
+				self->prefixes[w] = self->prefix(items[k]);
+			}
+		}
+	}
+	return true;
+}
+
+/* Moves the elements of the array over the removed ones, in a single pass */
+static void _sa_compact(SortedArray *const self) {
+	if(!self->ntombstones) {
+		return;
+	}
+	/* the pending items go to the same elements, about to be shifted */
+	for(size_t j = 0; j < self->npending; ++j) {
+		self->pending_at[j] = _sa_live(self, self->pending_at[j]);
+	}
+	const size_t size = a_size(self->array);
+	size_t w = 0;
+	for(size_t r = 0; r < size; ++r) {
+		if(ba_get(self->dead, r)) {
+			ba_unset(self->dead, r);
+			continue;
+		}
+		if(w < r) {
+			a_set(self->array, w, a_get(self->array, r));
+			if(self->prefixes) {
+				self->prefixes[w] = self->prefixes[r];
+			}
+		}
+		++w;
+	}
+	while(a_size(self->array) > w) {
+		a_drop(self->array, a_size(self->array) - 1);
+	}
+	memset(self->deadtree, 0, (_sa_deadblocks(self) + 1) * sizeof(size_t));
+	self->ntombstones = 0;
+}
+
+/* Merges the insert buffer into the array, after compacting the removed
+   elements away */
+static bool _sa_flush(SortedArray *const self) {
+	_sa_compact(self);
+	if(self->npending) {
+		if(!_sa_merge(self, self->pending, self->npending)) {
+			return false;
+		}
+		self->npending = 0;
+	}
+	return true;
+}
+
+/* The number of searches interleaved by sa_indexof_many */
+#define SA_SEARCH_LANES 16
+
+/* Searches a group of at most SA_SEARCH_LANES values at once: at each step,
+   the elements probed by all the searches are first loaded, then compared, so
+   that their cache misses overlap instead of following each other */
+static size_t _sa_indexof_lanes(const SortedArray *const self,
+                                data_t *const values[], const size_t n,
+                                ssize_t indices[]) {
+	const size_t size = a_size(self->array);
+	size_t base[SA_SEARCH_LANES];
+	const data_t *probe[SA_SEARCH_LANES];
+	size_t found = 0;
+	for(size_t l = 0; l < n; ++l) {
+		base[l] = 0;
+	}
+	/* all the searches share the same sequence of lengths, so they end
+	   together */
+	for(size_t len = size; len > 1; len -= len / 2) {
+		const size_t half = len / 2;
+		for(size_t l = 0; l < n; ++l) {
+			probe[l] = a_get(self->array, base[l] + half - 1);
+			CODS_PREFETCH(probe[l]);
+		}
+		for(size_t l = 0; l < n; ++l) {
+			base[l] += (self->cmp(probe[l], values[l]) < 0) * half;
+		}
+	}
+	for(size_t l = 0; l < n; ++l) {
+		indices[l] = -1;
+		if(!size) {
+			continue;
+		}
+		int d = self->cmp(a_get(self->array, base[l]), values[l]);
+		if(d < 0 && base[l] + 1 < size) {
+			d = self->cmp(a_get(self->array, ++base[l]), values[l]);
+		}
+		if(d == 0) {
+			indices[l] = base[l];
+			++found;
+		}
+	}
+	return found;
+}
+
+/* The parts of two sets a set operation keeps */
+enum sa_setparts {
+	SA_ONLY_A = 1, /* the elements of a not in b */
+	SA_ONLY_B = 2, /* the elements of b not in a */
+	SA_BOTH = 4 /* the elements in both a and b, as found in a */
+};
+
+/* The ratio of sizes above which the elements of the smaller set are searched
+   in the larger one by galloping, rather than merged linearly */
+#define SA_GALLOP_RATIO 16
+
+/* Finds the index of the first element not less than the item, from lo on, by
+   exponential then binary search: O(log d) for a distance d from lo */
+static size_t _sa_gallop(const Array *const array, size_t lo,
+                         const data_t *const item,
+                         int (*const cmp)(const data_t*, const data_t*)) {
+	const size_t n = a_size(array);
+	size_t hi = lo, step = 1;
+	while(hi < n && cmp(a_get(array, hi), item) < 0) {
+		lo = hi + 1;
+		hi += step;
+		step *= 2;
+	}
+	if(hi > n) {
+		hi = n;
+	}
+	while(lo < hi) {
+		const size_t m = lo + (hi - lo) / 2;
+		if(cmp(a_get(array, m), item) < 0) {
+			lo = m + 1;
+		} else {
+			hi = m;
+		}
+	}
+	return lo;
+}
+
+/* Appends the elements of src in [from, to) to out, if not NULL; returns the
+   number of elements, or SIZE_MAX if an allocation failed */
+static size_t _sa_emitrange(Array *const out, const Array *const src,
+                            const size_t from, const size_t to) {
+	if(out) {
+		for(size_t i = from; i < to; ++i) {
+			if(a_append(out, a_get(src, i)) < 0) {
+				return SIZE_MAX;
+			}
+		}
+	}
+	return to - from;
+}
+
+/* A read-only walk over the elements of a sorted array in order, through the
+   array and the insert buffer, skipping the removed elements: the set
+   operations read their operands without merging their buffers */
+struct sawalk {
+	const SortedArray *set;
+	size_t i; /* the next element of the array */
+	size_t j; /* the next pending item */
+};
+
+/* Moves the walk past the removed elements of the array */
+static void _sa_walkskip(struct sawalk *const walk) {
+	const SortedArray *const set = walk->set;
+	while(walk->i < a_size(set->array) && _sa_istomb(set, walk->i)) {
+		++walk->i;
+	}
+}
+
+static void _sa_walkstart(struct sawalk *const walk,
+                          const SortedArray *const set) {
+	walk->set = set;
+	walk->i = 0;
+	walk->j = 0;
+	_sa_walkskip(walk);
+}
+
+static CODS_INLINE bool _sa_walkend(const struct sawalk *const walk) {
+	return walk->i == a_size(walk->set->array)
+	       && walk->j == walk->set->npending;
+}
+
+/* Whether the next element is a pending item; a pending item goes before the
+   element of the array at its index */
+static CODS_INLINE bool _sa_walkpending(const struct sawalk *const walk) {
+	return walk->j < walk->set->npending
+	       && walk->set->pending_at[walk->j] <= walk->i;
+}
+
+static CODS_INLINE data_t *_sa_walkget(const struct sawalk *const walk) {
+	return _sa_walkpending(walk) ? walk->set->pending[walk->j]
+	                             : a_get(walk->set->array, walk->i);
+}
+
+static void _sa_walknext(struct sawalk *const walk) {
+	if(_sa_walkpending(walk)) {
+		++walk->j;
+	} else {
+		++walk->i;
+		_sa_walkskip(walk);
+	}
+}
+
+/* Appends the elements left in the walk to out, if not NULL; returns the
+   number of elements, or SIZE_MAX if an allocation failed */
+static size_t _sa_emitwalk(Array *const out, struct sawalk *const walk) {
+	size_t count = 0;
+	for(; !_sa_walkend(walk); _sa_walknext(walk)) {
+		if(out && a_append(out, _sa_walkget(walk)) < 0) {
+			return SIZE_MAX;
+		}
+		++count;
+	}
+	return count;
+}
+
+/* Computes the given parts of the sets a and b in order, appending the elements
+   to out if it is not NULL; returns the number of elements, or SIZE_MAX if an
+   allocation failed, which cannot happen without out */
+static size_t _sa_setop(const SortedArray *const a, const SortedArray *const b,
+                        const unsigned parts, Array *const out) {
+	const size_t na = sa_size(a), nb = sa_size(b);
+	int (*const cmp)(const data_t*, const data_t*) = a->cmp;
+	size_t count = 0, n;
+	/* galloping searches the array of the larger set, which thus must hold all
+	   its elements, without a pending or removed one */
+	const bool a_small = na < nb;
+	const SortedArray *const larger = a_small ? b : a;
+	if((na > SA_GALLOP_RATIO * nb || nb > SA_GALLOP_RATIO * na)
+	   && !larger->npending && !larger->ntombstones) {
+		/* search the elements of the small set in the large one */
+		const Array *const large = larger->array;
+		const unsigned only_small = a_small ? SA_ONLY_A : SA_ONLY_B;
+		const unsigned only_large = a_small ? SA_ONLY_B : SA_ONLY_A;
+		size_t p = 0;
+		struct sawalk small;
+		for(_sa_walkstart(&small, a_small ? a : b); !_sa_walkend(&small);
+		    _sa_walknext(&small)) {
+			data_t *const item = _sa_walkget(&small);
+			const size_t lb = _sa_gallop(large, p, item, cmp);
+			if(parts & only_large) {
+				if((n = _sa_emitrange(out, large, p, lb)) == SIZE_MAX) {
+					return SIZE_MAX;
+				}
+				count += n;
+			}
+			const bool both = lb < a_size(large)
+			                  && cmp(a_get(large, lb), item) == 0;
+			p = both ? lb + 1 : lb;
+			if(parts & (both ? SA_BOTH : only_small)) {
+				data_t *const kept = both && !a_small ? a_get(large, lb) : item;
+				if(out && a_append(out, kept) < 0) {
+					return SIZE_MAX;
+				}
+				++count;
+			}
+		}
+		if(parts & only_large) {
+			if((n = _sa_emitrange(out, large, p, a_size(large))) == SIZE_MAX) {
+				return SIZE_MAX;
+			}
+			count += n;
+		}
+		return count;
+	}
+	struct sawalk wa, wb;
+	_sa_walkstart(&wa, a);
+	_sa_walkstart(&wb, b);
+	while(!_sa_walkend(&wa) && !_sa_walkend(&wb)) {
+		data_t *const x = _sa_walkget(&wa), *const y = _sa_walkget(&wb);
+		const int d = cmp(x, y);
+		const unsigned part = d < 0 ? SA_ONLY_A : d > 0 ? SA_ONLY_B : SA_BOTH;
+		if(parts & part) {
+			if(out && a_append(out, d > 0 ? y : x) < 0) {
+				return SIZE_MAX;
+			}
+			++count;
+		}
+		if(d <= 0) {
+			_sa_walknext(&wa);
+		}
+		if(d >= 0) {
+			_sa_walknext(&wb);
+		}
+	}
+	if(parts & SA_ONLY_A) {
+		if((n = _sa_emitwalk(out, &wa)) == SIZE_MAX) {
+			return SIZE_MAX;
+		}
+		count += n;
+	}
+	if(parts & SA_ONLY_B) {
+		if((n = _sa_emitwalk(out, &wb)) == SIZE_MAX) {
+			return SIZE_MAX;
+		}
+		count += n;
+	}
+	return count;
+}
+
+static CODS_INLINE void _sa_thaw(SortedArray *const self) {
+	free(self->frozen);
+	self->frozen = NULL;
+	self->indices = NULL;
+}
+
+/* Stable bottom-up merge sort of an array of pointers, using tmp as buffer */
+static void _sa_sort(data_t **items, data_t **tmp, const size_t n,
+                     int (*const cmp)(const data_t*, const data_t*)) {
+	data_t **const orig = items;
+	for(size_t width = 1; width < n; width *= 2) {
+		for(size_t lo = 0; lo < n; lo += 2 * width) {
+			const size_t mid = lo + width < n ? lo + width : n;
+			const size_t hi = mid + width < n ? mid + width : n;
+			size_t i = lo, j = mid, k = lo;
+			while(i < mid && j < hi) {
+				tmp[k++] = cmp(items[j], items[i]) < 0 ? items[j++]
+				                                       : items[i++];
+			}
+			while(i < mid) {
+				tmp[k++] = items[i++];
+			}
+			while(j < hi) {
+				tmp[k++] = items[j++];
+			}
+		}
+		data_t **const swap = items;
+		items = tmp;
+		tmp = swap;
+	}
+	if(items != orig) {
+		memcpy(orig, items, n * sizeof(data_t*));
+	}
+}
+
 SortedArray *sa_new(const size_t size,
                     int (*const cmp)(const data_t *, const data_t*)) {
 	SortedArray *const self = malloc(sizeof(SortedArray));
@@ -42,49 +788,508 @@ SortedArray *sa_new(const size_t size,
 		return NULL;
 	}
 	self->cmp = cmp;
+	self->frozen = NULL;
+	self->indices = NULL;
+	self->prefix = NULL;
+	self->prefixes = NULL;
+	self->capacity = 0;
+	self->pending = NULL;
+	self->pending_at = NULL;
+	self->dead = NULL;
+	self->deadtree = NULL;
+	self->npending = 0;
+	self->ntombstones = 0;
+	self->threshold = 0;
+	self->deadratio = 0;
+	return self;
+}
+
+SortedArray *sa_new_prefixed(const size_t size,
+                             int (*const cmp)(const data_t*, const data_t*),
+                             uint64_t (*const prefix)(const data_t*)) {
+	SortedArray *const self = sa_new(size, cmp);
+	if(!self) {
+		return NULL;
+	}
+	self->prefixes = malloc(size * sizeof(uint64_t));
+	if(!self->prefixes) {
+		sa_free(self);
+		errno = ENOMEM;
+		return NULL;
+	}
+	self->prefix = prefix;
+	self->capacity = size;
 	return self;
 }
 
 void sa_free(SortedArray *const self) {
+	free(self->deadtree);
+	if(self->dead) {
+		ba_free(self->dead);
+	}
+	free(self->pending_at);
+	free(self->pending);
+	free(self->prefixes);
+	free(self->frozen);
 	a_free(self->array);
 	free(self);
 }
 
 size_t sa_size(const SortedArray *const self) {
-	return a_size(self->array);
+	return a_size(self->array) - self->ntombstones + self->npending;
+}
+
+/* Whether the insert buffer, and the marks unless they are compacted on their
+   own, are to be merged before the next insertion or removal */
+static CODS_INLINE bool _sa_bufferfull(const SortedArray *const self) {
+	const size_t marks = self->deadratio ? 0 : self->ntombstones;
+	return self->npending + marks >= self->threshold;
+}
+
+/* Adds an element in the insert buffer */
+static ssize_t _sa_bufferadd(SortedArray *const self, data_t *const item) {
+	if(_sa_bufferfull(self) && !_sa_flush(self)) {
+		return -1;
+	}
+	size_t at;
+	if(_sa_binsearch(self, item, &at) >= 0) {
+		return -1;
+	}
+	bool found;
+	const size_t j = _sa_pendingbound(self, item, &found);
+	if(found) {
+		return -1;
+	}
+	memmove(self->pending + j + 1, self->pending + j,
+	        (self->npending - j) * sizeof(data_t*));
+	memmove(self->pending_at + j + 1, self->pending_at + j,
+	        (self->npending - j) * sizeof(size_t));
+	self->pending[j] = item;
+	self->pending_at[j] = at;
+	++self->npending;
+	errno = 0;
+	return _sa_live(self, at) + j;
+}
+
+/* Adds an element in the array holding removed elements: the element takes
+   the slot of the removed element before its place, if any; otherwise, the
+   array is compacted first */
+static ssize_t _sa_lazyadd(SortedArray *const self, data_t *const item) {
+	size_t end;
+	if(_sa_binsearch(self, item, &end) >= 0) {
+		return -1;
+	}
+	/* the elements between the previous element not removed and end, the next
+	   one, are all removed */
+	if(end > 0 && _sa_istomb(self, end - 1)) {
+		_sa_revive(self, end - 1, item);
+		errno = 0;
+		return _sa_live(self, end - 1);
+	}
+	end = _sa_live(self, end);
+	_sa_compact(self);
+	return _sa_insert(self, end, item);
 }
 
 ssize_t sa_add(SortedArray *const self, data_t *const item) {
 	size_t end;
+	_sa_thaw(self);
+	if(self->threshold) {
+		return _sa_bufferadd(self, item);
+	} else if(self->ntombstones) {
+		return _sa_lazyadd(self, item);
+	}
 	if(!a_size(self->array)) {
-		return a_add(self->array, 0, item);
+		return _sa_insert(self, 0, item);
 	} else if(a_size(self->array) == 1) {
 		const int d = self->cmp(item, a_get(self->array, 0));
 		if(d < 0) {
-			return a_add(self->array, 0, item);
+			return _sa_insert(self, 0, item);
 		} else if(d > 0) {
-			return a_add(self->array, 1, item);
+			return _sa_insert(self, 1, item);
 		} else {
 			return -1;
 		}
 	}
 	if(_sa_binsearch(self, item, &end) < 0)
-		return a_add(self->array, end, item) < 0 ? -1 : (ssize_t)end;
+		return _sa_insert(self, end, item);
 	return -1;
 }
 
 data_t *sa_get(const SortedArray *const self, const size_t index) {
-	return a_get(self->array, index);
+	if(!self->npending && !self->ntombstones) {
+		return a_get(self->array, index);
+	}
+	if(index >= sa_size(self)) {
+		errno = ERANGE;
+		return NULL;
+	}
+	bool pending;
+	const size_t j = _sa_pendingrank(self, index, &pending);
+	if(pending) {
+		errno = 0;
+		return self->pending[j];
+	}
+	return a_get(self->array, _sa_selectlive(self, index - j));
 }
 
 ssize_t sa_indexof(const SortedArray *const self, const data_t *const value) {
+	if(self->npending || self->ntombstones) {
+		bool found;
+		const size_t index = _sa_lowerbound(self, value, &found);
+		return found ? (ssize_t)index : -1;
+	}
+	if(self->frozen) {
+		bool found;
+		const size_t index = _sa_frozenbound(self, value, &found);
+		return found ? (ssize_t)index : -1;
+	}
 	return _sa_binsearch(self, value, NULL);
 }
 
 extern data_t *sa_geteq(const SortedArray*, const data_t*);
 
+size_t sa_indexof_many(const SortedArray *const self,
+                       data_t *const values[], const size_t n,
+                       ssize_t indices[]) {
+	const size_t size = a_size(self->array);
+	size_t found = 0, l = 1;
+	/* galloping only pays when the values are close to each other */
+	const bool dense = n && n * SA_GALLOP_RATIO >= size && !self->npending
+	                   && !self->ntombstones;
+	while(dense && l < n && self->cmp(values[l - 1], values[l]) <= 0) {
+		++l;
+	}
+	if(dense && l == n) {
+		/* the values are sorted: walk the array once, galloping from one value
+		   to the next */
+		size_t p = 0;
+		for(size_t i = 0; i < n; ++i) {
+			p = _sa_gallop(self->array, p, values[i], self->cmp);
+			if(p < size && self->cmp(a_get(self->array, p), values[i]) == 0) {
+				indices[i] = p;
+				++found;
+			} else {
+				indices[i] = -1;
+			}
+		}
+	} else if(self->frozen || self->prefixes || self->threshold
+	          || self->ntombstones) {
+		/* these searches already avoid most misses, or have to look into the
+		   insert buffer */
+		for(size_t i = 0; i < n; ++i) {
+			indices[i] = sa_indexof(self, values[i]);
+			found += indices[i] >= 0;
+		}
+	} else {
+		for(size_t i = 0; i < n; i += SA_SEARCH_LANES) {
+			const size_t lanes = n - i < SA_SEARCH_LANES ? n - i
+			                                             : SA_SEARCH_LANES;
+			found += _sa_indexof_lanes(self, values + i, lanes, indices + i);
+		}
+	}
+	return found;
+}
+
+size_t sa_lower_bound(const SortedArray *const self,
+                      const data_t *const value) {
+	bool found;
+	return _sa_lowerbound(self, value, &found);
+}
+
+size_t sa_upper_bound(const SortedArray *const self,
+                      const data_t *const value) {
+	bool found;
+	const size_t index = _sa_lowerbound(self, value, &found);
+	return found ? index + 1 : index;
+}
+
+void sa_equal_range(const SortedArray *const self, const data_t *const value,
+                    size_t *const first, size_t *const last) {
+	bool found;
+	*first = _sa_lowerbound(self, value, &found);
+	*last = found ? *first + 1 : *first;
+}
+
+void sa_foreach_range(SortedArray *const self, const data_t *const lo,
+                      const data_t *const hi,
+                      void (*const apply)(data_t*, void*), void *const ctx) {
+	bool found;
+	/* walk the array and the insert buffer together from the first elements
+	   not less than lo, rather than finding each element by its index */
+	struct sawalk walk = {self, _sa_arraybound(self, lo, &found),
+	                      _sa_pendingbound(self, lo, &found)};
+	const size_t last = _sa_lowerbound(self, hi, &found);
+	for(size_t k = _sa_live(self, walk.i) + walk.j; k < last; ++k) {
+		apply(_sa_walkget(&walk), ctx);
+		_sa_walknext(&walk);
+	}
+}
+
+/* Removes an element from the insert buffer, or marks it removed in the
+   array */
+static data_t *_sa_lazydrop(SortedArray *const self, const size_t index) {
+	if(index >= sa_size(self)) {
+		errno = ERANGE;
+		return NULL;
+	}
+	if(self->threshold && _sa_bufferfull(self) && !_sa_flush(self)) {
+		return NULL;
+	}
+	bool pending;
+	const size_t j = _sa_pendingrank(self, index, &pending);
+	errno = 0;
+	if(pending) {
+		data_t *const item = self->pending[j];
+		--self->npending;
+		memmove(self->pending + j, self->pending + j + 1,
+		        (self->npending - j) * sizeof(data_t*));
+		memmove(self->pending_at + j, self->pending_at + j + 1,
+		        (self->npending - j) * sizeof(size_t));
+		return item;
+	}
+	const size_t i = _sa_selectlive(self, index - j);
+	if(!_sa_mark(self, i)) {
+		return NULL;
+	}
+	data_t *const item = a_get(self->array, i);
+	if(self->deadratio
+	   && self->ntombstones * 100 >= self->deadratio * a_size(self->array)) {
+		_sa_compact(self);
+	}
+	errno = 0;
+	return item;
+}
+
 data_t *sa_drop(SortedArray *const self, const size_t index) {
+	const size_t size = a_size(self->array);
+	_sa_thaw(self);
+	if(self->threshold || self->deadratio) {
+		return _sa_lazydrop(self, index);
+	}
+	if(self->prefixes && index < size) {
+		memmove(self->prefixes + index, self->prefixes + index + 1,
+		        (size - index - 1) * sizeof(uint64_t));
+	}
 	return a_drop(self->array, index);
 }
 
 extern data_t *sa_remove(SortedArray*, const data_t*);
+
+ssize_t sa_add_many(SortedArray *const self, data_t *const items[],
+                    const size_t n, data_t *rejected[]) {
+	if(!n) {
+		return 0;
+	}
+	_sa_thaw(self);
+	if(!_sa_flush(self)) {
+		return -1;
+	}
+	data_t **const batch = malloc(2 * n * sizeof(data_t*));
+	if(!batch) {
+		errno = ENOMEM;
+		return -1;
+	}
+	memcpy(batch, items, n * sizeof(data_t*));
+	_sa_sort(batch, batch + n, n, self->cmp);
+
+	/* keep, at the start of the batch, the items neither repeated in the batch
+	   nor already in the array */
+	const size_t size = a_size(self->array);
+	size_t kept = 0, i = 0;
+	for(size_t j = 0; j < n; ++j) {
+		data_t *const item = batch[j];
+		int d = 1;
+		if(j > 0 && self->cmp(item, batch[j - 1]) == 0) {
+			d = 0;
+		} else {
+			while(i < size
+			      && (d = self->cmp(item, a_get(self->array, i))) > 0) {
+				++i;
+			}
+		}
+		if(d) {
+			batch[kept++] = item;
+		} else if(rejected) {
+			*rejected++ = item;
+		}
+	}
+
+	if(!_sa_merge(self, batch, kept)) {
+		free(batch);
+		return -1;
+	}
+	free(batch);
+	errno = 0;
+	return kept;
+}
+
+SortedArray *sa_from_unsorted(data_t *const items[], const size_t n,
+                              int (*const cmp)(const data_t*, const data_t*)) {
+	SortedArray *const self = sa_new(n, cmp);
+	if(!self) {
+		return NULL;
+	}
+	if(sa_add_many(self, items, n, NULL) < 0) {
+		sa_free(self);
+		return NULL;
+	}
+	return self;
+}
+
+bool sa_freeze(SortedArray *const self) {
+	_sa_thaw(self);
+	if(!_sa_flush(self)) {
+		return false;
+	}
+	const size_t n = a_size(self->array);
+	if(!n) {
+		errno = 0;
+		return true;
+	}
+	/* slot 0 is unused, so that the children of slot k are 2k and 2k + 1, and
+	   the descendants loaded ahead together are aligned on the cache lines;
+	   the indices, only read once a search ends, are stored after the slots */
+	size_t bytes = (n + 1) * sizeof(data_t*);
+	bytes += (CODS_CACHE_LINE - bytes % CODS_CACHE_LINE) % CODS_CACHE_LINE;
+	const size_t offset = bytes;
+	bytes += (n + 1) * sizeof(size_t);
+	bytes += (CODS_CACHE_LINE - bytes % CODS_CACHE_LINE) % CODS_CACHE_LINE;
+	data_t **const slots = aligned_alloc(CODS_CACHE_LINE, bytes);
+	if(!slots) {
+		errno = ENOMEM;
+		return false;
+	}
+	size_t *const indices = (size_t*)((char*)slots + offset);
+	_sa_eytzinger(self, slots, indices, 0, 1, n);
+	self->frozen = slots;
+	self->indices = indices;
+	errno = 0;
+	return true;
+}
+
+void sa_thaw(SortedArray *const self) {
+	_sa_thaw(self);
+}
+
+/* Builds a new sorted array from the given parts of the sets a and b */
+static SortedArray *_sa_newsetop(const SortedArray *const a,
+                                 const SortedArray *const b,
+                                 const unsigned parts, size_t capacity) {
+	if(!capacity) {
+		capacity = 1;
+	}
+	SortedArray *const self = a->prefix
+	                          ? sa_new_prefixed(capacity, a->cmp, a->prefix)
+	                          : sa_new(capacity, a->cmp);
+	if(!self) {
+		return NULL;
+	}
+	if(_sa_setop(a, b, parts, self->array) == SIZE_MAX
+	   || !_sa_reserve(self, a_size(self->array))) {
+		sa_free(self);
+		errno = ENOMEM;
+		return NULL;
+	}
+	if(self->prefixes) {
+		for(size_t i = 0; i < a_size(self->array); ++i) {
+			self->prefixes[i] = self->prefix(a_get(self->array, i));
+		}
+	}
+	errno = 0;
+	return self;
+}
+
+SortedArray *sa_union(const SortedArray *const a, const SortedArray *const b) {
+	return _sa_newsetop(a, b, SA_ONLY_A | SA_ONLY_B | SA_BOTH,
+	                    sa_size(a) + sa_size(b));
+}
+
+SortedArray *sa_intersection(const SortedArray *const a,
+                             const SortedArray *const b) {
+	const size_t na = sa_size(a), nb = sa_size(b);
+	return _sa_newsetop(a, b, SA_BOTH, na < nb ? na : nb);
+}
+
+SortedArray *sa_difference(const SortedArray *const a,
+                           const SortedArray *const b) {
+	return _sa_newsetop(a, b, SA_ONLY_A, sa_size(a));
+}
+
+SortedArray *sa_symdiff(const SortedArray *const a,
+                        const SortedArray *const b) {
+	return _sa_newsetop(a, b, SA_ONLY_A | SA_ONLY_B,
+	                    sa_size(a) + sa_size(b));
+}
+
+size_t sa_union_count(const SortedArray *const a, const SortedArray *const b) {
+	return _sa_setop(a, b, SA_ONLY_A | SA_ONLY_B | SA_BOTH, NULL);
+}
+
+size_t sa_intersection_count(const SortedArray *const a,
+                             const SortedArray *const b) {
+	return _sa_setop(a, b, SA_BOTH, NULL);
+}
+
+size_t sa_difference_count(const SortedArray *const a,
+                           const SortedArray *const b) {
+	return _sa_setop(a, b, SA_ONLY_A, NULL);
+}
+
+size_t sa_symdiff_count(const SortedArray *const a,
+                        const SortedArray *const b) {
+	return _sa_setop(a, b, SA_ONLY_A | SA_ONLY_B, NULL);
+}
+
+bool sa_set_buffer(SortedArray *const self, const size_t threshold) {
+	if(!_sa_flush(self)) {
+		return false;
+	}
+	free(self->pending_at);
+	free(self->pending);
+	self->pending = NULL;
+	self->pending_at = NULL;
+	self->threshold = 0;
+	if(threshold) {
+		self->pending = malloc(threshold * sizeof(data_t*));
+		self->pending_at = malloc(threshold * sizeof(size_t));
+		if(!self->pending || !self->pending_at) {
+			free(self->pending_at);
+			free(self->pending);
+			self->pending = NULL;
+			self->pending_at = NULL;
+			errno = ENOMEM;
+			return false;
+		}
+		self->threshold = threshold;
+	}
+	errno = 0;
+	return true;
+}
+
+bool sa_flush(SortedArray *const self) {
+	_sa_thaw(self);
+	if(!_sa_flush(self)) {
+		return false;
+	}
+	errno = 0;
+	return true;
+}
+
+bool sa_set_lazy_drop(SortedArray *const self, const unsigned percent) {
+	if(percent > 100) {
+		errno = EINVAL;
+		return false;
+	}
+	self->deadratio = percent;
+	if(!percent
+	   || self->ntombstones * 100 >= self->deadratio * a_size(self->array)) {
+		_sa_compact(self);
+	}
+	errno = 0;
+	return true;
+}
+
+void sa_compact(SortedArray *const self) {
+	_sa_compact(self);
+}
@@ -0,0 +1,149 @@
+#include "spscqueue.h"
+
+#include <errno.h> /* for errno, EAGAIN, EINVAL */
+#include <stdatomic.h>
+#include <stdint.h> /* for SIZE_MAX */
+#include <stdlib.h> /* for NULL, aligned_alloc(), free() */
+#include <string.h> /* for memcpy() */
+
+
+
+extern int errno;
+
+/* The indices are free-running counters: they are only masked when accessing
+   the slots, and their difference is the number of elements in the queue. */
+struct spscqueue {
+	/* Written by the consumer only */
+	_Alignas(CODS_CACHE_LINE) atomic_size_t head;
+	size_t cached_tail; /* the last value of tail seen by the consumer */
+	char consumer_pad[CODS_CACHE_LINE - sizeof(atomic_size_t) - sizeof(size_t)];
+	/* Written by the producer only */
+	atomic_size_t tail;
+	size_t cached_head; /* the last value of head seen by the producer */
+	char producer_pad[CODS_CACHE_LINE - sizeof(atomic_size_t) - sizeof(size_t)];
+	/* Read-only after creation */
+	size_t mask;
+	char shared_pad[CODS_CACHE_LINE - sizeof(size_t)];
+	data_t *items[];
+};
+
+
+SPSCQueue *spsc_new(const size_t capacity) {
+	const size_t max = (SIZE_MAX - sizeof(SPSCQueue) - CODS_CACHE_LINE)
+	                   / sizeof(data_t*);
+	if(!capacity || capacity > max || capacity > SIZE_MAX / 2 + 1) {
+		errno = EINVAL;
+		return NULL;
+	}
+	size_t c = 1;
+	while(c < capacity) {
+		c <<= 1;
+	}
+	size_t bytes = sizeof(SPSCQueue) + c * sizeof(data_t*);
+	/* aligned_alloc() requires a size multiple of the alignment */
+	bytes += (CODS_CACHE_LINE - bytes % CODS_CACHE_LINE) % CODS_CACHE_LINE;
+	SPSCQueue *const self = aligned_alloc(CODS_CACHE_LINE, bytes);
+	if(!self) {
+		return NULL;
+	}
+	atomic_init(&self->head, 0);
+	self->cached_tail = 0;
+	atomic_init(&self->tail, 0);
+	self->cached_head = 0;
+	self->mask = c - 1;
+	errno = 0;
+	return self;
+}
+
+void spsc_free(SPSCQueue *const self) {
+	free(self);
+}
+
+size_t spsc_capacity(const SPSCQueue *const self) {
+	return self->mask + 1;
+}
+
+size_t spsc_size(const SPSCQueue *const self) {
+	const size_t head = atomic_load_explicit(&self->head, memory_order_acquire);
+	const size_t tail = atomic_load_explicit(&self->tail, memory_order_acquire);
+	return tail - head;
+}
+
+
+bool spsc_push(SPSCQueue *const self, data_t *const item) {
+	const size_t tail = atomic_load_explicit(&self->tail, memory_order_relaxed);
+	if(CODS_UNLIKELY(tail - self->cached_head > self->mask)) {
+		self->cached_head = atomic_load_explicit(&self->head,
+		                                         memory_order_acquire);
+		if(tail - self->cached_head > self->mask) {
+			errno = EAGAIN;
+			return false;
+		}
+	}
+	self->items[tail & self->mask] = item;
+	atomic_store_explicit(&self->tail, tail + 1, memory_order_release);
+	errno = 0;
+	return true;
+}
+
+size_t spsc_push_n(SPSCQueue *const self, data_t *const items[],
+                   const size_t n) {
+	const size_t capacity = self->mask + 1;
+	const size_t tail = atomic_load_explicit(&self->tail, memory_order_relaxed);
+	size_t room = capacity - (tail - self->cached_head);
+	if(room < n) {
+		self->cached_head = atomic_load_explicit(&self->head,
+		                                         memory_order_acquire);
+		room = capacity - (tail - self->cached_head);
+	}
+	const size_t count = room < n ? room : n;
+	if(!count) {
+		return 0;
+	}
+	/* copy in at most two runs: up to the end of the storage, then from its
+	   start */
+	const size_t start = tail & self->mask;
+	const size_t first = capacity - start < count ? capacity - start : count;
+	memcpy(self->items + start, items, first * sizeof(data_t*));
+	memcpy(self->items, items + first, (count - first) * sizeof(data_t*));
+	atomic_store_explicit(&self->tail, tail + count, memory_order_release);
+	return count;
+}
+
+
+data_t *spsc_pop(SPSCQueue *const self) {
+	const size_t head = atomic_load_explicit(&self->head, memory_order_relaxed);
+	if(CODS_UNLIKELY(head == self->cached_tail)) {
+		self->cached_tail = atomic_load_explicit(&self->tail,
+		                                         memory_order_acquire);
+		if(head == self->cached_tail) {
+			errno = EAGAIN;
+			return NULL;
+		}
+	}
+	data_t *const item = self->items[head & self->mask];
+	atomic_store_explicit(&self->head, head + 1, memory_order_release);
+	errno = 0;
+	return item;
+}
+
+size_t spsc_pop_n(SPSCQueue *const self, data_t *items[], const size_t n) {
+	const size_t capacity = self->mask + 1;
+	const size_t head = atomic_load_explicit(&self->head, memory_order_relaxed);
+	size_t avail = self->cached_tail - head;
+	if(avail < n) {
+		self->cached_tail = atomic_load_explicit(&self->tail,
+		                                         memory_order_acquire);
+		avail = self->cached_tail - head;
+	}
+	const size_t count = avail < n ? avail : n;
+	if(!count) {
+		return 0;
+	}
+	const size_t start = head & self->mask;
+	const size_t first = capacity - start < count ? capacity - start : count;
+	memcpy(items, self->items + start, first * sizeof(data_t*));
+	memcpy(items + first, self->items, (count - first) * sizeof(data_t*));
+	atomic_store_explicit(&self->head, head + count, memory_order_release);
+	return count;
+}
@@ -0,0 +1,207 @@
+#include "stringmap.h"
+
+#include <errno.h> /* for errno, EINVAL, ENOMEM */
+#include <stdint.h> /* for uint32_t, uint64_t, UINT32_MAX, SIZE_MAX */
+#include <stdlib.h> /* for malloc(), calloc(), free() */
+#include <string.h> /* for memcmp(), strlen() */
+
+
+
+extern int errno;
+
+/* The smallest number of slots of the table */
+#define SM_MIN_CAPACITY 16
+
+/* The largest number of slots, as a slot finds its place from 32 bits of the
+   hash of its key */
+#define SM_MAX_CAPACITY ((size_t)UINT32_MAX / 2 + 1)
+
+/* A key, along with 32 bits of its hash and of its length, so that most
+   mismatches are rejected without reading the key */
+struct smslot {
+	const char *key; /* interned, or NULL if the slot is empty */
+	data_t *value;
+	uint32_t hash;
+	uint32_t length;
+};
+
+struct stringmap {
+	StringPool *pool;
+	struct smslot *slots;
+	size_t capacity; /* a power of 2 */
+	size_t size;
+};
+
+
+/* The slot of a string not interned, or SIZE_MAX */
+static size_t sm_find(const StringMap *const self, const char *const key) {
+	const size_t length = strlen(key), mask = self->capacity - 1;
+	const uint32_t tag = (uint32_t)sp_hash_bytes(key, length);
+	for(size_t i = tag & mask;; i = (i + 1) & mask) {
+		const struct smslot *const slot = &self->slots[i];
+		if(!slot->key) {
+			return SIZE_MAX;
+		}
+		if(slot->key == key
+		   || (slot->hash == tag && slot->length == (uint32_t)length
+		       && (length <= UINT32_MAX || sp_length(slot->key) == length)
+		       && memcmp(slot->key, key, length) == 0)) {
+			return i;
+		}
+	}
+}
+
+/* The slot of an interned string, or the empty slot it is to be placed in */
+static size_t sm_search(const StringMap *const self,
+                        const char *const interned) {
+	const size_t mask = self->capacity - 1;
+	for(size_t i = (uint32_t)sp_hash(interned) & mask;; i = (i + 1) & mask) {
+		if(!self->slots[i].key || self->slots[i].key == interned) {
+			return i;
+		}
+	}
+}
+
+static bool sm_alloc(StringMap *const self, const size_t capacity) {
+	struct smslot *const slots = capacity <= SM_MAX_CAPACITY
+	                             ? calloc(capacity, sizeof(struct smslot))
+	                             : NULL;
+	if(!slots) {
+		errno = ENOMEM;
+		return false;
+	}
+	self->slots = slots;
+	self->capacity = capacity;
+	return true;
+}
+
+/* Doubles the table, placing the keys from the hashes in their slots */
+static bool sm_grow(StringMap *const self) {
+	struct smslot *const slots = self->slots;
+	const size_t capacity = self->capacity;
+	if(!sm_alloc(self, 2 * capacity)) {
+		return false;
+	}
+	const size_t mask = self->capacity - 1;
+	for(size_t i = 0; i < capacity; ++i) {
+		if(slots[i].key) {
+			size_t j = slots[i].hash & mask;
+			while(self->slots[j].key) {
+				j = (j + 1) & mask;
+			}
+			self->slots[j] = slots[i];
+		}
+	}
+	free(slots);
+	return true;
+}
+
+/* Empties a slot, moving back the following keys that may fill it */
+static void sm_erase(StringMap *const self, size_t i) {
+	const size_t mask = self->capacity - 1;
+	for(size_t j = (i + 1) & mask; self->slots[j].key; j = (j + 1) & mask) {
+		const size_t home = self->slots[j].hash & mask;
+		/* the key at j may move to i if i is between its place and j */
+		if(((j - home) & mask) >= ((j - i) & mask)) {
+			self->slots[i] = self->slots[j];
+			i = j;
+		}
+	}
+	self->slots[i].key = NULL;
+	--self->size;
+}
+
+
+StringMap *sm_new(const size_t size, StringPool *const pool) {
+	if(!size) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if(size > SM_MAX_CAPACITY / 2) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	StringMap *const self = malloc(sizeof(StringMap));
+	if(!self) {
+		return NULL;
+	}
+	/* the smallest table whose load is at most 3/4 with size keys */
+	size_t capacity = SM_MIN_CAPACITY;
+	while(capacity - capacity / 4 < size) {
+		capacity *= 2;
+	}
+	if(!sm_alloc(self, capacity)) {
+		free(self);
+		return NULL;
+	}
+	self->pool = pool;
+	self->size = 0;
+	errno = 0;
+	return self;
+}
+
+void sm_free(StringMap *const self) {
+	free(self->slots);
+	free(self);
+}
+
+size_t sm_size(const StringMap *const self) {
+	return self->size;
+}
+
+StringPool *sm_pool(const StringMap *const self) {
+	return self->pool;
+}
+
+bool sm_put(StringMap *const self, const char *const key,
+            data_t *const value) {
+	const char *const interned = sp_intern(self->pool, key);
+	if(!interned) {
+		return false;
+	}
+	size_t i = sm_search(self, interned);
+	if(self->slots[i].key) {
+		self->slots[i].value = value;
+		errno = 0;
+		return true;
+	}
+	if(self->size + 1 > self->capacity - self->capacity / 4) {
+		if(!sm_grow(self)) {
+			return false;
+		}
+		i = sm_search(self, interned);
+	}
+	self->slots[i].key = interned;
+	self->slots[i].value = value;
+	self->slots[i].hash = (uint32_t)sp_hash(interned);
+	self->slots[i].length = (uint32_t)sp_length(interned);
+	++self->size;
+	errno = 0;
+	return true;
+}
+
+data_t *sm_get(const StringMap *const self, const char *const key) {
+	const size_t i = sm_find(self, key);
+	return i == SIZE_MAX ? NULL : self->slots[i].value;
+}
+
+data_t *sm_get_interned(const StringMap *const self,
+                        const char *const interned) {
+	const struct smslot *const slot = &self->slots[sm_search(self, interned)];
+	return slot->key ? slot->value : NULL;
+}
+extern data_t *sm_getd(const StringMap*, const char*, data_t*);
+
+bool sm_contains(const StringMap *const self, const char *const key) {
+	return sm_find(self, key) != SIZE_MAX;
+}
+
+data_t *sm_remove(StringMap *const self, const char *const key) {
+	const size_t i = sm_find(self, key);
+	if(i == SIZE_MAX) {
+		return NULL;
+	}
+	data_t *const value = self->slots[i].value;
+	sm_erase(self, i);
+	return value;
+}
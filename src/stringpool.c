@@ -0,0 +1,250 @@
+#include "stringpool.h"
+
+#include <errno.h> /* for errno, EINVAL, ENOMEM */
+#include <stdbool.h>
+#include <stdint.h> /* for uint32_t, uint64_t, SIZE_MAX */
+#include <stdlib.h> /* for malloc(), calloc(), free() */
+#include <string.h> /* for memcpy(), memcmp(), strlen() */
+
+
+
+extern int errno;
+
+/* The smallest number of bytes of a block of strings */
+#define SP_BLOCK 4096
+
+/* The smallest number of slots of the index */
+#define SP_MIN_CAPACITY 16
+
+/* Precedes the bytes of each interned string */
+struct spheader {
+	uint64_t hash;
+	size_t length;
+};
+
+/* A block of strings, each one after its header and aligned as it */
+struct spblock {
+	struct spblock *next;
+	size_t used;
+	size_t size;
+};
+
+/* A string, along with 32 bits of its hash and of its length, so that most
+   mismatches are rejected without reading the string */
+struct spslot {
+	const char *string;
+	uint32_t hash;
+	uint32_t length;
+};
+
+struct stringpool {
+	struct spslot *slots;
+	struct spblock *blocks; /* the block strings are added to first */
+	size_t capacity; /* a power of 2 */
+	size_t size;
+};
+
+
+static CODS_INLINE
+const struct spheader *sp_header(const char *const interned) {
+	return (const struct spheader*)interned - 1;
+}
+
+/* The slot of a string, or the empty slot it is to be placed in; the table is
+   probed linearly, as it is at most 3/4 full */
+static size_t sp_search(const StringPool *const self, const char *const string,
+                        const size_t length, const uint64_t h) {
+	const size_t mask = self->capacity - 1;
+	const uint32_t tag = (uint32_t)(h >> 32);
+	for(size_t i = (size_t)h & mask;; i = (i + 1) & mask) {
+		const struct spslot *const slot = &self->slots[i];
+		if(!slot->string
+		   || (slot->hash == tag && slot->length == (uint32_t)length
+		       && sp_header(slot->string)->length == length
+		       && memcmp(slot->string, string, length) == 0)) {
+			return i;
+		}
+	}
+}
+
+/* Doubles the index, placing the strings from their stored hash */
+static bool sp_grow(StringPool *const self) {
+	const size_t capacity = 2 * self->capacity;
+	struct spslot *const slots = capacity <= SIZE_MAX / sizeof(struct spslot)
+	                             ? calloc(capacity, sizeof(struct spslot))
+	                             : NULL;
+	if(!slots) {
+		errno = ENOMEM;
+		return false;
+	}
+	for(size_t i = 0; i < self->capacity; ++i) {
+		const struct spslot slot = self->slots[i];
+		if(slot.string) {
+			size_t j = (size_t)sp_header(slot.string)->hash & (capacity - 1);
+			while(slots[j].string) {
+				j = (j + 1) & (capacity - 1);
+			}
+			slots[j] = slot;
+		}
+	}
+	free(self->slots);
+	self->slots = slots;
+	self->capacity = capacity;
+	return true;
+}
+
+/* Copies a string into the last block, or into a new one */
+static const char *sp_store(StringPool *const self, const char *const string,
+                            const size_t length, const uint64_t h) {
+	const size_t align = sizeof(struct spheader);
+	if(length > SIZE_MAX - sizeof(struct spblock) - 2 * align) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	/* the header, the bytes and a null byte, rounded up to the alignment */
+	const size_t bytes = (sizeof(struct spheader) + length + align)
+	                     / align * align;
+	struct spblock *block = self->blocks;
+	if(!block || block->size - block->used < bytes) {
+		const size_t size = bytes > SP_BLOCK ? bytes : SP_BLOCK;
+		block = malloc(sizeof(struct spblock) + size);
+		if(!block) {
+			errno = ENOMEM;
+			return NULL;
+		}
+		block->used = 0;
+		block->size = size;
+		/* a block for a single large string is kept behind the current one */
+		if(bytes > SP_BLOCK && self->blocks) {
+			block->next = self->blocks->next;
+			self->blocks->next = block;
+		} else {
+			block->next = self->blocks;
+			self->blocks = block;
+		}
+	}
+	struct spheader *const header = (struct spheader*)((char*)(block + 1)
+	                                                   + block->used);
+	block->used += bytes;
+	header->hash = h;
+	header->length = length;
+	char *const copy = (char*)(header + 1);
+	memcpy(copy, string, length);
+	copy[length] = '\0';
+	return copy;
+}
+
+
+StringPool *sp_new(const size_t size) {
+	if(!size) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if(size > SIZE_MAX / 2 / sizeof(struct spslot)) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	StringPool *const self = malloc(sizeof(StringPool));
+	if(!self) {
+		return NULL;
+	}
+	/* the smallest index whose load is at most 3/4 with size strings */
+	size_t capacity = SP_MIN_CAPACITY;
+	while(capacity - capacity / 4 < size) {
+		capacity *= 2;
+	}
+	self->slots = calloc(capacity, sizeof(struct spslot));
+	if(!self->slots) {
+		free(self);
+		errno = ENOMEM;
+		return NULL;
+	}
+	self->blocks = NULL;
+	self->capacity = capacity;
+	self->size = 0;
+	errno = 0;
+	return self;
+}
+
+void sp_free(StringPool *const self) {
+	struct spblock *block = self->blocks;
+	while(block) {
+		struct spblock *const next = block->next;
+		free(block);
+		block = next;
+	}
+	free(self->slots);
+	free(self);
+}
+
+size_t sp_size(const StringPool *const self) {
+	return self->size;
+}
+
+const char *sp_intern(StringPool *const self, const char *const string) {
+	return sp_intern_n(self, string, strlen(string));
+}
+
+const char *sp_intern_n(StringPool *const self, const char *const string,
+                        const size_t length) {
+	const uint64_t h = sp_hash_bytes(string, length);
+	size_t i = sp_search(self, string, length, h);
+	if(self->slots[i].string) {
+		errno = 0;
+		return self->slots[i].string;
+	}
+	if(self->size + 1 > self->capacity - self->capacity / 4) {
+		if(!sp_grow(self)) {
+			return NULL;
+		}
+		i = sp_search(self, string, length, h);
+	}
+	const char *const copy = sp_store(self, string, length, h);
+	if(!copy) {
+		return NULL;
+	}
+	self->slots[i].string = copy;
+	self->slots[i].hash = (uint32_t)(h >> 32);
+	self->slots[i].length = (uint32_t)length;
+	++self->size;
+	errno = 0;
+	return copy;
+}
+
+const char *sp_find(const StringPool *const self, const char *const string) {
+	const size_t length = strlen(string);
+	return self->slots[sp_search(self, string, length,
+	                             sp_hash_bytes(string, length))].string;
+}
+
+/* Reads 8 bytes at a time, then mixes the result as the finalizer of
+   SplitMix64 does */
+uint64_t sp_hash_bytes(const char *const string, const size_t length) {
+	const uint64_t k = UINT64_C(0x9E3779B97F4A7C15);
+	uint64_t h = (uint64_t)length * k;
+	size_t i = 0;
+	for(; i + 8 <= length; i += 8) {
+		uint64_t w;
+		memcpy(&w, string + i, 8);
+		h = (h ^ w) * k;
+		h ^= h >> 32;
+	}
+	if(i < length) {
+		uint64_t w = 0;
+		memcpy(&w, string + i, length - i);
+		h = (h ^ w) * k;
+	}
+	h ^= h >> 30;
+	h *= UINT64_C(0xBF58476D1CE4E5B9);
+	h ^= h >> 27;
+	h *= UINT64_C(0x94D049BB133111EB);
+	return h ^ (h >> 31);
+}
+
+uint64_t sp_hash(const char *const interned) {
+	return sp_header(interned)->hash;
+}
+
+size_t sp_length(const char *const interned) {
+	return sp_header(interned)->length;
+}
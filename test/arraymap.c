@@ -47,13 +47,256 @@ static void test_am_new__0_null(void) {
 	verbose("OK");
 }
 
+static void test_am_get_many(void) {
+	int missing = 5;
+	key_t *keys[ARRAY_MAP_SIZE + 1];
+	value_t *values[ARRAY_MAP_SIZE + 1];
+	size_t got;
+	notice("test am_get_many");
+	for(unsigned int i = 0; i < ARRAY_MAP_SIZE; ++i) {
+		keys[i] = &KEYS[i];
+	}
+	keys[ARRAY_MAP_SIZE] = &missing;
+	verbose("am_get_many(arraymap, KEYS + {5}, %u, values)", ARRAY_MAP_SIZE + 1);
+	info("expected: %u", ARRAY_MAP_SIZE);
+	got = am_get_many(arraymap, keys, ARRAY_MAP_SIZE + 1, values);
+	info("got     : %zu", got);
+	CUTE_assertEquals(got, ARRAY_MAP_SIZE);
+	for(unsigned int i = 0; i < ARRAY_MAP_SIZE; ++i) {
+		CUTE_assertEquals(values[i], &VALUES[i]);
+	}
+	CUTE_assertEquals(values[ARRAY_MAP_SIZE], NULL);
+	verbose("OK");
+}
+
+static value_t *make_value(const key_t *const key, void *const ctx) {
+	float *const made = ctx;
+	*made = (float)*(const int*)key;
+	return made;
+}
+
+static void test_am_put__override(void) {
+	static float value = 1.5;
+	notice("test am_put -- an equal key overrides the value");
+	verbose("am_put(arraymap, &(%d), &(%f))", KEYS[3], value);
+	CUTE_assertEquals(am_put(arraymap, &KEYS[3], &value), true);
+	CUTE_assertNoError();
+	CUTE_assertEquals(am_get(arraymap, &KEYS[3]), &value);
+	verbose("OK");
+}
+
+static void test_am_upsert(void) {
+	static int key = 50;
+	static float value = 1.5;
+	float *got;
+	notice("test am_upsert -- former value or NULL");
+	verbose("am_upsert(arraymap, &(%d), &(%f))", KEYS[0], value);
+	got = am_upsert(arraymap, &KEYS[0], &value);
+	CUTE_assertEquals(got, &VALUES[0]);
+	CUTE_assertEquals(am_get(arraymap, &KEYS[0]), &value);
+	verbose("am_upsert(arraymap, &(%d), &(%f))", key, value);
+	got = am_upsert(arraymap, &key, &value);
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertNoError();
+	CUTE_assertEquals(am_get(arraymap, &key), &value);
+	verbose("OK");
+}
+
+static void test_am_get_or_insert(void) {
+	static int key = -5;
+	static float made;
+	float *got;
+	notice("test am_get_or_insert -- the factory is only called when absent");
+	got = am_get_or_insert(arraymap, &KEYS[1], make_value, &made);
+	CUTE_assertEquals(got, &VALUES[1]);
+	verbose("am_get_or_insert(arraymap, &(%d), make_value, &made)", key);
+	got = am_get_or_insert(arraymap, &key, make_value, &made);
+	CUTE_assertEquals(got, &made);
+	CUTE_assertEquals(made, -5.0f);
+	CUTE_assertEquals(am_get(arraymap, &key), &made);
+	verbose("OK");
+}
+
+static void test_am_entry(void) {
+	static int key = 29;
+	static float value = 1.5;
+	AMEntry entry;
+	notice("test am_entry -- a single search for reading then writing");
+	entry = am_entry(arraymap, &KEYS[5]);
+	CUTE_assertEquals(am_entry_occupied(&entry), true);
+	CUTE_assertEquals(am_entry_get(&entry), &VALUES[5]);
+	CUTE_assertEquals(am_entry_insert(&entry, &value), false);
+	CUTE_assertNoError();
+	CUTE_assertEquals(am_entry_replace(&entry, &value), &VALUES[5]);
+	CUTE_assertEquals(am_get(arraymap, &KEYS[5]), &value);
+	verbose("am_entry(arraymap, &(%d))", key);
+	entry = am_entry(arraymap, &key);
+	CUTE_assertEquals(am_entry_occupied(&entry), false);
+	CUTE_assertEquals(am_entry_get(&entry), NULL);
+	CUTE_assertEquals(am_entry_replace(&entry, &value), NULL);
+	CUTE_assertEquals(am_entry_insert(&entry, &value), true);
+	CUTE_assertEquals(am_entry_occupied(&entry), true);
+	CUTE_assertEquals(am_entry_get(&entry), &value);
+	CUTE_assertEquals(am_get(arraymap, &key), &value);
+	CUTE_assertEquals(am_get(arraymap, &KEYS[9]), &VALUES[9]);
+	verbose("OK");
+}
+
+/* The keys given to collect_key, in order */
+static int *visited[10];
+static size_t nvisited;
+
+static void collect_key(key_t *const key, value_t *const value,
+                        void *const ctx) {
+	(void)value;
+	CUTE_runTimeAssert(ctx == &nvisited && nvisited < ARRAY_MAP_SIZE);
+	visited[nvisited++] = key;
+}
+
+static void test_am_foreach_range(void) {
+	static int lo = 8, hi = 34, after = 1000;
+	notice("test am_foreach_range -- the keys in [lo, hi) are visited in order");
+	nvisited = 0;
+	verbose("am_foreach_range(arraymap, &(%d), &(%d), collect_key, &nvisited)",
+	        lo, hi);
+	am_foreach_range(arraymap, &lo, &hi, collect_key, &nvisited);
+	CUTE_assertEquals(nvisited, 4);
+	CUTE_assertEquals(visited[0], &KEYS[8]);
+	CUTE_assertEquals(visited[1], &KEYS[5]);
+	CUTE_assertEquals(visited[2], &KEYS[3]);
+	CUTE_assertEquals(visited[3], &KEYS[9]);
+	nvisited = 0;
+	am_foreach_range(arraymap, &hi, &lo, collect_key, &nvisited);
+	am_foreach_range(arraymap, &after, &after, collect_key, &nvisited);
+	CUTE_assertEquals(nvisited, 0);
+	verbose("am_foreach(arraymap, collect_key, &nvisited)");
+	am_foreach(arraymap, collect_key, &nvisited);
+	CUTE_assertEquals(nvisited, ARRAY_MAP_SIZE);
+	for(size_t i = 1; i < ARRAY_MAP_SIZE; ++i) {
+		CUTE_runTimeAssert(*visited[i - 1] < *visited[i]);
+	}
+	verbose("OK");
+}
+
+static void test_am_cursor(void) {
+	static int key = 29;
+	AMCursor cursor;
+	notice("test am_seek -- the cursor walks the keys both ways");
+	verbose("am_seek(arraymap, &(%d))", key);
+	cursor = am_seek(arraymap, &key);
+	CUTE_assertEquals(am_cursor_key(&cursor), &KEYS[9]);
+	CUTE_assertEquals(am_cursor_value(&cursor), &VALUES[9]);
+	CUTE_assertEquals(am_cursor_next(&cursor), true);
+	CUTE_assertEquals(am_cursor_key(&cursor), &KEYS[4]);
+	CUTE_assertEquals(am_cursor_prev(&cursor), true);
+	CUTE_assertEquals(am_cursor_prev(&cursor), true);
+	CUTE_assertEquals(am_cursor_key(&cursor), &KEYS[3]);
+	cursor = am_seek_last(arraymap);
+	CUTE_assertEquals(am_cursor_key(&cursor), &KEYS[7]);
+	CUTE_assertEquals(am_cursor_next(&cursor), false);
+	CUTE_assertEquals(am_cursor_value(&cursor), NULL);
+	CUTE_assertEquals(am_cursor_prev(&cursor), true);
+	CUTE_assertEquals(am_cursor_key(&cursor), &KEYS[7]);
+	cursor = am_seek_first(arraymap);
+	CUTE_assertEquals(am_cursor_key(&cursor), &KEYS[6]);
+	CUTE_assertEquals(am_cursor_prev(&cursor), false);
+	CUTE_assertEquals(am_cursor_valid(&cursor), false);
+	CUTE_assertEquals(am_cursor_next(&cursor), true);
+	CUTE_assertEquals(am_cursor_key(&cursor), &KEYS[6]);
+	verbose("OK");
+}
+
+/* Writes the sum of the values at the place given as context, and moves it to
+   the next place */
+static value_t *add_values(const key_t *const key, value_t *const first,
+                           value_t *const last, void *const ctx) {
+	float **const sum = ctx;
+	(void)key;
+	**sum = *(float*)first + *(float*)last;
+	return (*sum)++;
+}
+
+static void test_am_put_many(void) {
+	static int keys[] = {50, 13, -30, 50, 592};
+	static float values[] = {1.0, 2.0, 3.0, 4.0, 5.0};
+	key_t *batch[5];
+	value_t *vals[5];
+	notice("test am_put_many -- a key met several times keeps one value");
+	for(size_t i = 0; i < 5; ++i) {
+		batch[i] = &keys[i];
+		vals[i] = &values[i];
+	}
+	verbose("am_put_many(arraymap, batch, vals, 5, AM_KEEP_FIRST, NULL, NULL)");
+	CUTE_assertEquals(am_put_many(arraymap, batch, vals, 5, AM_KEEP_FIRST,
+	                              NULL, NULL), 2);
+	CUTE_assertNoError();
+	CUTE_assertEquals(am_get(arraymap, &keys[0]), &values[0]);
+	CUTE_assertEquals(am_get(arraymap, &keys[2]), &values[2]);
+	CUTE_assertEquals(am_get(arraymap, &KEYS[5]), &VALUES[5]);
+	CUTE_assertEquals(am_get(arraymap, &KEYS[7]), &VALUES[7]);
+	verbose("am_put_many(arraymap, batch, vals, 5, AM_KEEP_LAST, NULL, NULL)");
+	CUTE_assertEquals(am_put_many(arraymap, batch, vals, 5, AM_KEEP_LAST,
+	                              NULL, NULL), 0);
+	CUTE_assertEquals(am_get(arraymap, &keys[0]), &values[3]);
+	CUTE_assertEquals(am_get(arraymap, &KEYS[5]), &values[1]);
+	CUTE_assertEquals(am_get(arraymap, &KEYS[7]), &values[4]);
+	CUTE_assertEquals(am_get(arraymap, &KEYS[0]), &VALUES[0]);
+	verbose("OK");
+}
+
+static void test_am_from_pairs(void) {
+	static int keys[] = {7, 3, 7, 1, 3};
+	static float values[] = {1.0, 2.0, 4.0, 8.0, 16.0};
+	static float sums[2];
+	static int missing = 5;
+	float *sum = sums;
+	key_t *batch[5];
+	value_t *vals[5];
+	ArrayMap *got;
+	AMCursor cursor;
+	notice("test am_from_pairs -- the values of a key are merged in order");
+	for(size_t i = 0; i < 5; ++i) {
+		batch[i] = &keys[i];
+		vals[i] = &values[i];
+	}
+	verbose("am_from_pairs(batch, vals, 5, %s, AM_MERGE, add_values, &sum)",
+	        cmp_as_ints_repr);
+	got = am_from_pairs(batch, vals, 5, cmp_as_ints, AM_MERGE, add_values,
+	                    &sum);
+	CUTE_assertNotEquals(got, NULL);
+	cursor = am_seek_first(got);
+	CUTE_assertEquals(am_cursor_key(&cursor), &keys[3]);
+	CUTE_assertEquals(am_cursor_next(&cursor), true);
+	CUTE_assertEquals(am_cursor_key(&cursor), &keys[1]);
+	CUTE_assertEquals(am_cursor_next(&cursor), true);
+	CUTE_assertEquals(am_cursor_key(&cursor), &keys[0]);
+	CUTE_assertEquals(am_cursor_next(&cursor), false);
+	CUTE_assertEquals(am_get(got, &keys[1]), &sums[0]);
+	CUTE_assertEquals(sums[0], 18.0f);
+	CUTE_assertEquals(am_get(got, &keys[0]), &sums[1]);
+	CUTE_assertEquals(sums[1], 5.0f);
+	CUTE_assertEquals(am_get(got, &keys[3]), &values[3]);
+	CUTE_assertEquals(am_get(got, &missing), NULL);
+	am_free(got);
+	verbose("OK");
+}
+
 // TODO
 
 
 void build_case_arraymap(void) {
-	case_arraymap = CUTE_newTestCase("Tests for ArrayMap", 1);
+	case_arraymap = CUTE_newTestCase("Tests for ArrayMap", 10);
 	CUTE_setCaseBefore(case_arraymap, init);
 	CUTE_setCaseAfter(case_arraymap, cleanup);
 	CUTE_addCaseTest(case_arraymap ,CUTE_makeTest(test_am_new__0_null));
+	CUTE_addCaseTest(case_arraymap, CUTE_makeTest(test_am_get_many));
+	CUTE_addCaseTest(case_arraymap, CUTE_makeTest(test_am_put__override));
+	CUTE_addCaseTest(case_arraymap, CUTE_makeTest(test_am_upsert));
+	CUTE_addCaseTest(case_arraymap, CUTE_makeTest(test_am_get_or_insert));
+	CUTE_addCaseTest(case_arraymap, CUTE_makeTest(test_am_entry));
+	CUTE_addCaseTest(case_arraymap, CUTE_makeTest(test_am_foreach_range));
+	CUTE_addCaseTest(case_arraymap, CUTE_makeTest(test_am_cursor));
+	CUTE_addCaseTest(case_arraymap, CUTE_makeTest(test_am_put_many));
+	CUTE_addCaseTest(case_arraymap, CUTE_makeTest(test_am_from_pairs));
 	// TODO
 }
@@ -144,9 +144,32 @@ static void test_ba_count(void) {
 	verbose("OK");
 }
 
+static void test_ba_count_range(void) {
+	size_t got;
+	notice("test ba_count_range -- compared to counting with ba_get");
+	for(size_t from = 0; from <= BIT_ARRAY_SIZE; ++from) {
+		size_t expected = 0;
+		for(size_t to = from; to <= BIT_ARRAY_SIZE; ++to) {
+			if(to > from && VALUES[to - 1]) {
+				++expected;
+			}
+			verbose("ba_count_range(barray, %zu, %zu)", from, to);
+			got = ba_count_range(barray, from, to);
+			CUTE_assertEquals(got, expected);
+		}
+	}
+	verbose("ba_count_range(barray, 0, %zu)", BIT_ARRAY_SIZE + 1);
+	info("expected: 0");
+	got = ba_count_range(barray, 0, BIT_ARRAY_SIZE + 1);
+	info("got     : %zu", got);
+	CUTE_assertEquals(got, 0);
+	CUTE_assertErrnoEquals(ERANGE);
+	verbose("OK");
+}
+
 
 void build_case_bitarray(void) {
-	case_bitarray = CUTE_newTestCase("Tests for BitArray", 7);
+	case_bitarray = CUTE_newTestCase("Tests for BitArray", 8);
 	CUTE_setCaseBefore(case_bitarray, init);
 	CUTE_setCaseAfter(case_bitarray, cleanup);
 	CUTE_addCaseTest(case_bitarray, CUTE_makeTest(test_ba_new__0_null));
@@ -156,4 +179,5 @@ void build_case_bitarray(void) {
 	CUTE_addCaseTest(case_bitarray, CUTE_makeTest(test_ba_get__valid));
 	CUTE_addCaseTest(case_bitarray, CUTE_makeTest(test_ba_get__invalid));
 	CUTE_addCaseTest(case_bitarray, CUTE_makeTest(test_ba_count));
+	CUTE_addCaseTest(case_bitarray, CUTE_makeTest(test_ba_count_range));
 }
@@ -0,0 +1,269 @@
+#include "bplustree.h"
+
+
+#include <CUTE/cute.h>
+#include <clog.h> /* for logging macros */
+#include <stddef.h> /* for size_t */
+#include <stdlib.h> /* for NULL */
+
+
+
+/* The instance of test case */
+CUTE_TestCase *case_bplustree;
+
+
+
+static BPlusTree *bptree;
+
+extern int cmp_as_ints(const data_t*, const data_t*);
+extern const char cmp_as_ints_repr[];
+
+static const size_t INT_BPLUS_TREE_SIZE = 10;
+static int VALUES[] = {9 ,7, 1, 5, 40, 95, 65, 13, 27, 82};
+static int VALUES_SORTED[] = {1, 5, 7, 9, 13, 27, 40, 65, 82, 95};
+
+
+static void init(void) {
+	verbose("bptree = bpt_new(%s)", cmp_as_ints_repr);
+	bptree = bpt_new(cmp_as_ints);
+	CUTE_assertNotEquals(bptree, NULL);
+	for(size_t i = 0; i < INT_BPLUS_TREE_SIZE; ++i) {
+		const ssize_t r = bpt_add(bptree, &VALUES[i]);
+		CUTE_runTimeAssert(r >= 0);
+	}
+}
+
+static void cleanup(void) {
+	verbose("bpt_free(bptree)");
+	bpt_free(bptree);
+}
+
+
+static void test_bpt_many(void) {
+	static int values[2000];
+	BPlusTree *big_btree;
+	const size_t n = sizeof(values) / sizeof(*values);
+	notice("test BPlusTree -- enough elements to split and merge nodes");
+	verbose("big_btree = bpt_new(%s)", cmp_as_ints_repr);
+	big_btree = bpt_new(cmp_as_ints);
+	for(size_t i = 0; i < n; ++i) {
+		/* 7 is coprime with the size: all the values are added, shuffled */
+		values[i] = (int)(i * 7 % n);
+		bpt_add(big_btree, &values[i]);
+	}
+	CUTE_assertEquals(bpt_size(big_btree), n);
+	for(size_t i = 0; i < n; ++i) {
+		const int *const got = bpt_get(big_btree, i);
+		CUTE_assertEquals(*got, (int)i);
+	}
+	verbose("removing the even values");
+	for(size_t i = 0; i < n; i += 2) {
+		const int value = (int)i;
+		CUTE_assertNotEquals(bpt_remove(big_btree, &value), NULL);
+	}
+	CUTE_assertEquals(bpt_size(big_btree), n / 2);
+	for(size_t i = 0; i < n / 2; ++i) {
+		const int *const got = bpt_get(big_btree, i);
+		CUTE_assertEquals(*got, (int)(2 * i + 1));
+	}
+	bpt_free(big_btree);
+	verbose("OK");
+}
+
+static void test_bpt_drop__free(void) {
+	int *values[2000];
+	BPlusTree *big_btree;
+	const size_t n = sizeof(values) / sizeof(*values);
+	notice("test bpt_drop -- the tree never reads the elements dropped");
+	verbose("big_btree = bpt_new(%s)", cmp_as_ints_repr);
+	big_btree = bpt_new(cmp_as_ints);
+	for(size_t i = 0; i < n; ++i) {
+		values[i] = malloc(sizeof(int));
+		CUTE_runTimeAssert(values[i] != NULL);
+		*values[i] = (int)i;
+		CUTE_runTimeAssert(bpt_add(big_btree, values[i]) >= 0);
+	}
+	verbose("dropping and freeing every 15th element");
+	for(size_t i = 0; i < n; i += 15) {
+		free(bpt_drop(big_btree, i - i / 15));
+		values[i] = NULL;
+	}
+	for(size_t i = 0; i < n; ++i) {
+		const int value = (int)i;
+		CUTE_assertEquals(bpt_indexof(big_btree, &value) >= 0, i % 15 != 0);
+	}
+	verbose("dropping and freeing the first elements of the tree");
+	for(size_t i = 0; i < n; ++i) {
+		if(values[i] && i % 4 != 3) {
+			free(bpt_remove(big_btree, values[i]));
+			values[i] = NULL;
+		}
+	}
+	for(size_t i = 0; i < n; ++i) {
+		const int value = (int)i;
+		CUTE_assertEquals(bpt_geteq(big_btree, &value), values[i]);
+		if(!values[i]) {
+			values[i] = malloc(sizeof(int));
+			CUTE_runTimeAssert(values[i] != NULL);
+			*values[i] = (int)i;
+			CUTE_assertEquals(bpt_add(big_btree, values[i]), (ssize_t)i);
+		}
+	}
+	CUTE_assertEquals(bpt_size(big_btree), n);
+	bpt_free(big_btree);
+	for(size_t i = 0; i < n; ++i) {
+		free(values[i]);
+	}
+	verbose("OK");
+}
+
+static void test_bpt_size__empty(void) {
+	BPlusTree *empty_btree;
+	size_t got;
+	notice("test bpt_size -- empty BPlusTree == 0");
+	info("empty_btree = bpt_new(%s)", cmp_as_ints_repr);
+	empty_btree = bpt_new(cmp_as_ints);
+	verbose("bpt_size(empty_btree)");
+	info("expected: 0");
+	got = bpt_size(empty_btree);
+	info("got     : %zu", got);
+	CUTE_assertEquals(got, 0);
+	bpt_free(empty_btree);
+	verbose("OK");
+}
+
+static void test_bpt_size(void) {
+	size_t got;
+	notice("test bpt_size(bptree) == %zu", INT_BPLUS_TREE_SIZE);
+	verbose("bpt_size(bptree)");
+	info("expected: %zu", INT_BPLUS_TREE_SIZE);
+	got = bpt_size(bptree);
+	info("got     : %zu", got);
+	CUTE_assertEquals(got, INT_BPLUS_TREE_SIZE);
+	verbose("OK");
+}
+
+static void test_is_sorted__bpt_get(void) {
+	const size_t s = bpt_size(bptree);
+	int *expected, *got;
+	notice("test bptree is actually sorted");
+	for(size_t i = 0; i < s; ++i) {
+		verbose("bpt_get(bptree, %zu)", i);
+		expected = &VALUES_SORTED[i];
+		info("expected: %d", *expected);
+		got = bpt_get(bptree, i);
+		info("got     : %d", *got);
+		CUTE_assertEqualsUsing(got, expected, cmp_as_ints, 0);
+	}
+	verbose("OK");
+}
+
+static void test_bpt_indexof(void) {
+	ssize_t expected, got;
+	notice("test bpt_indexof");
+	for(size_t i = 0; i < INT_BPLUS_TREE_SIZE; ++i) {
+		verbose("bpt_indexof(bptree, %zu)", i);
+		expected = (ssize_t)i;
+		info("expected: %zd", expected);
+		got = bpt_indexof(bptree, &VALUES_SORTED[i]);
+		info("got     : %zd", got);
+		CUTE_assertEquals(got, expected);
+	}
+	verbose("OK");
+}
+
+static void test_bpt_add__last(void) {
+	static int value = 1024;
+	ssize_t expected, got;
+	notice("test bpt_add() -- add item last in array");
+	verbose("bpt_add(bptree, &(%d))", value);
+	expected = INT_BPLUS_TREE_SIZE;
+	info("expected: %zu", expected);
+	got = bpt_add(bptree, &value);
+	info("got     : %zu", got);
+	CUTE_assertEquals(got, expected);
+	verbose("OK");
+	// a-posteriori check of the value actually set
+	info("A posteriori validity check: bpt_get(bptree, %zu) == %d",
+	     INT_BPLUS_TREE_SIZE, value);
+	CUTE_assertEquals(bpt_get(bptree, INT_BPLUS_TREE_SIZE), &value);
+}
+
+static void test_bpt_add_dup(void) {
+	static int value = 13;
+	ssize_t expected, got;
+	notice("test bpt_add() -- duplicate item is not added");
+	verbose("bpt_add(bptree, &(%d))", value);
+	expected = -1;
+	info("expected: %zu", expected);
+	got = bpt_add(bptree, &value);
+	info("got     : %zu", got);
+	CUTE_assertEquals(got, expected);
+	verbose("OK");
+}
+
+static void test_bpt_get__invalid(void) {
+	data_t *got;
+	notice("test bpt_get -- invalid index");
+	verbose("bpt_get(bptree, %zu)", INT_BPLUS_TREE_SIZE);
+	info("expected: (nil)");
+	got = bpt_get(bptree, INT_BPLUS_TREE_SIZE);
+	info("got     : %p", got);
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertErrnoEquals(ERANGE);
+	verbose("OK");
+}
+
+static void test_bpt_drop(void) {
+	const size_t index = 4;
+	int *expected, *got;
+	notice("test bpt_drop -- the following elements move down");
+	verbose("bpt_drop(bptree, %zu)", index);
+	expected = &VALUES_SORTED[index];
+	info("expected: %d", *expected);
+	got = bpt_drop(bptree, index);
+	info("got     : %d", *got);
+	CUTE_assertEqualsUsing(got, expected, cmp_as_ints, 0);
+	CUTE_assertEquals(bpt_size(bptree), INT_BPLUS_TREE_SIZE - 1);
+	for(size_t i = index; i < INT_BPLUS_TREE_SIZE - 1; ++i) {
+		got = bpt_get(bptree, i);
+		CUTE_assertEqualsUsing(got, &VALUES_SORTED[i + 1], cmp_as_ints, 0);
+	}
+	verbose("OK");
+}
+
+static void test_bpt_remove(void) {
+	static int value = 65;
+	int *got;
+	notice("test bpt_remove -- remove an equivalent element");
+	verbose("bpt_remove(bptree, &(%d))", value);
+	info("expected: %d", value);
+	got = bpt_remove(bptree, &value);
+	info("got     : %d", *got);
+	CUTE_assertEqualsUsing(got, &value, cmp_as_ints, 0);
+	CUTE_assertEquals(bpt_indexof(bptree, &value), -1);
+	verbose("bpt_remove(bptree, &(%d))", value);
+	info("expected: (nil)");
+	got = bpt_remove(bptree, &value);
+	info("got     : %p", (void*)got);
+	CUTE_assertEquals(got, NULL);
+	verbose("OK");
+}
+
+
+void build_case_bplustree(void) {
+	case_bplustree = CUTE_newTestCase("Tests for BPlusTree", 11);
+	CUTE_setCaseBefore(case_bplustree, init);
+	CUTE_setCaseAfter(case_bplustree, cleanup);
+	CUTE_addCaseTest(case_bplustree, CUTE_makeTest(test_bpt_many));
+	CUTE_addCaseTest(case_bplustree, CUTE_makeTest(test_bpt_drop__free));
+	CUTE_addCaseTest(case_bplustree, CUTE_makeTest(test_bpt_size__empty));
+	CUTE_addCaseTest(case_bplustree, CUTE_makeTest(test_bpt_size));
+	CUTE_addCaseTest(case_bplustree, CUTE_makeTest(test_is_sorted__bpt_get));
+	CUTE_addCaseTest(case_bplustree, CUTE_makeTest(test_bpt_indexof));
+	CUTE_addCaseTest(case_bplustree, CUTE_makeTest(test_bpt_add__last));
+	CUTE_addCaseTest(case_bplustree, CUTE_makeTest(test_bpt_add_dup));
+	CUTE_addCaseTest(case_bplustree, CUTE_makeTest(test_bpt_get__invalid));
+	CUTE_addCaseTest(case_bplustree, CUTE_makeTest(test_bpt_drop));
+	CUTE_addCaseTest(case_bplustree, CUTE_makeTest(test_bpt_remove));
+}
@@ -0,0 +1,164 @@
+#include "cache.h"
+
+#include <CUTE/cute.h>
+#include <clog.h> /* for logging macros */
+#include <stddef.h> /* for size_t */
+#include <stdlib.h> /* for NULL */
+
+
+
+/* The instance of test case */
+CUTE_TestCase *case_cache;
+
+
+
+static Cache *cache;
+
+extern bool equal_as_ints(const data_t*, const data_t*);
+extern const char equal_as_ints_repr[];
+extern size_t hash_as_ints(const data_t*);
+extern const char hash_as_ints_repr[];
+
+static const size_t CACHE_CAPACITY = 3;
+static int KEYS[] = {10, 20, 30, 40, 50, 60};
+static int VALUES[] = {0, 1, 2, 3, 4, 5};
+
+/* The keys given to the eviction callback, in order */
+static int *evicted[8];
+static size_t nevicted;
+
+
+static void record_eviction(data_t *const key, data_t *const value,
+                            void *const ctx) {
+	(void)value;
+	CUTE_runTimeAssert(ctx == &nevicted && nevicted < 8);
+	evicted[nevicted++] = key;
+}
+
+static Cache *new_cache(const CachePolicy policy) {
+	Cache *const c = ca_new(CACHE_CAPACITY, policy, hash_as_ints,
+	                        equal_as_ints);
+	CUTE_assertNotEquals(c, NULL);
+	ca_set_evict(c, record_eviction, &nevicted);
+	for(size_t i = 0; i < CACHE_CAPACITY; ++i) {
+		CUTE_runTimeAssert(ca_put(c, &KEYS[i], &VALUES[i]));
+	}
+	return c;
+}
+
+static void init(void) {
+	verbose("cache = ca_new(%zu, CA_LRU, %s, %s)", CACHE_CAPACITY,
+	        hash_as_ints_repr, equal_as_ints_repr);
+	nevicted = 0;
+	cache = new_cache(CA_LRU);
+}
+
+static void cleanup(void) {
+	verbose("ca_free(cache)");
+	ca_free(cache);
+}
+
+
+static void test_ca_new__0_null(void) {
+	Cache *got;
+	notice("test ca_new -- capacity 0 => NULL cache");
+	verbose("ca_new(0, CA_LRU, %s, %s)", hash_as_ints_repr, equal_as_ints_repr);
+	info("expected: (nil)");
+	got = ca_new(0, CA_LRU, hash_as_ints, equal_as_ints);
+	info("got     : %p", (void*)got); /* necessary cast because of GCC warning */
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertErrnoEquals(EINVAL);
+	verbose("OK");
+}
+
+static void test_ca_get(void) {
+	static int missing = 15;
+	CacheStats stats;
+	notice("test ca_get -- hits and misses are counted");
+	for(size_t i = 0; i < CACHE_CAPACITY; ++i) {
+		verbose("ca_get(cache, &(%d))", KEYS[i]);
+		CUTE_assertEquals(ca_get(cache, &KEYS[i]), &VALUES[i]);
+	}
+	verbose("ca_get(cache, &(%d))", missing);
+	CUTE_assertEquals(ca_get(cache, &missing), NULL);
+	CUTE_assertEquals(ca_contains(cache, &missing), false);
+	stats = ca_stats(cache);
+	info("got     : %zu hits, %zu misses", stats.hits, stats.misses);
+	CUTE_assertEquals(stats.hits, CACHE_CAPACITY);
+	CUTE_assertEquals(stats.misses, 1);
+	CUTE_assertEquals(stats.evictions, 0);
+	ca_reset_stats(cache);
+	CUTE_assertEquals(ca_stats(cache).hits, 0);
+	verbose("OK");
+}
+
+static void test_ca_put__lru(void) {
+	notice("test ca_put -- the least recently used entry is evicted");
+	CUTE_assertEquals(ca_get(cache, &KEYS[0]), &VALUES[0]);
+	verbose("ca_put(cache, &(%d), &(%d))", KEYS[3], VALUES[3]);
+	CUTE_assertEquals(ca_put(cache, &KEYS[3], &VALUES[3]), true);
+	CUTE_assertEquals(ca_put(cache, &KEYS[2], &VALUES[4]), true);
+	CUTE_assertEquals(ca_put(cache, &KEYS[4], &VALUES[4]), true);
+	CUTE_assertEquals(nevicted, 2);
+	CUTE_assertEquals(evicted[0], &KEYS[1]);
+	CUTE_assertEquals(evicted[1], &KEYS[0]);
+	CUTE_assertEquals(ca_size(cache), CACHE_CAPACITY);
+	CUTE_assertEquals(ca_get(cache, &KEYS[2]), &VALUES[4]);
+	CUTE_assertEquals(ca_stats(cache).evictions, 2);
+	verbose("OK");
+}
+
+static void test_ca_put__clock(void) {
+	Cache *clock;
+	notice("test ca_put -- the clock spares the referenced entries once");
+	verbose("clock = ca_new(%zu, CA_CLOCK, %s, %s)", CACHE_CAPACITY,
+	        hash_as_ints_repr, equal_as_ints_repr);
+	clock = new_cache(CA_CLOCK);
+	CUTE_assertEquals(ca_get(clock, &KEYS[0]), &VALUES[0]);
+	CUTE_assertEquals(ca_get(clock, &KEYS[2]), &VALUES[2]);
+	for(size_t i = 3; i < 6; ++i) {
+		verbose("ca_put(clock, &(%d), &(%d))", KEYS[i], VALUES[i]);
+		CUTE_assertEquals(ca_put(clock, &KEYS[i], &VALUES[i]), true);
+	}
+	/* the hand clears the bit of 10 and evicts 20, clears the bit of 30 and
+	   evicts 10, then evicts 40: unlike LRU, 30 gets a second chance */
+	CUTE_assertEquals(nevicted, 3);
+	CUTE_assertEquals(evicted[0], &KEYS[1]);
+	CUTE_assertEquals(evicted[1], &KEYS[0]);
+	CUTE_assertEquals(evicted[2], &KEYS[3]);
+	CUTE_assertEquals(ca_contains(clock, &KEYS[2]), true);
+	CUTE_assertEquals(ca_contains(clock, &KEYS[4]), true);
+	CUTE_assertEquals(ca_contains(clock, &KEYS[5]), true);
+	ca_free(clock);
+	verbose("OK");
+}
+
+static void test_ca_clear(void) {
+	notice("test ca_clear -- removals are not evictions, clearing is");
+	verbose("ca_remove(cache, &(%d))", KEYS[1]);
+	CUTE_assertEquals(ca_remove(cache, &KEYS[1]), &VALUES[1]);
+	CUTE_assertEquals(ca_remove(cache, &KEYS[1]), NULL);
+	CUTE_assertEquals(ca_size(cache), CACHE_CAPACITY - 1);
+	CUTE_assertEquals(ca_put(cache, &KEYS[3], &VALUES[3]), true);
+	CUTE_assertEquals(nevicted, 0);
+	verbose("ca_clear(cache)");
+	ca_clear(cache);
+	CUTE_assertEquals(nevicted, CACHE_CAPACITY);
+	CUTE_assertEquals(ca_size(cache), 0);
+	CUTE_assertEquals(ca_contains(cache, &KEYS[0]), false);
+	CUTE_assertEquals(ca_put(cache, &KEYS[0], &VALUES[0]), true);
+	CUTE_assertEquals(ca_get(cache, &KEYS[0]), &VALUES[0]);
+	verbose("OK");
+}
+
+
+void build_case_cache(void) {
+	case_cache = CUTE_newTestCase("Tests for Cache", 5);
+	CUTE_setCaseBefore(case_cache, init);
+	CUTE_setCaseAfter(case_cache, cleanup);
+	CUTE_addCaseTest(case_cache, CUTE_makeTest(test_ca_new__0_null));
+	CUTE_addCaseTest(case_cache, CUTE_makeTest(test_ca_get));
+	CUTE_addCaseTest(case_cache, CUTE_makeTest(test_ca_put__lru));
+	CUTE_addCaseTest(case_cache, CUTE_makeTest(test_ca_put__clock));
+	CUTE_addCaseTest(case_cache, CUTE_makeTest(test_ca_clear));
+}
@@ -21,6 +21,12 @@ bool equal_as_ints(const data_t *const e1, const data_t *const e2) {
 }
 const char equal_as_ints_repr[] = "(int *i, int *j) -> *i == *j";
 
+size_t hash_as_ints(const data_t *const e) {
+	CUTE_runTimeAssert(e != NULL);
+	return (size_t)*(int*)e;
+}
+const char hash_as_ints_repr[] = "(int *i) -> *i";
+
 void print_as_int(const data_t *const e) {
 	if(e)
 		printf("%d", *(int*)e);
@@ -48,6 +54,42 @@ extern void build_case_sortedarray(void);
 extern CUTE_TestCase *case_arraymap;
 extern void build_case_arraymap(void);
 
+extern CUTE_TestCase *case_spscqueue;
+extern void build_case_spscqueue(void);
+
+extern CUTE_TestCase *case_intrusivelist;
+extern void build_case_intrusivelist(void);
+
+extern CUTE_TestCase *case_skiplist;
+extern void build_case_skiplist(void);
+
+extern CUTE_TestCase *case_bplustree;
+extern void build_case_bplustree(void);
+
+extern CUTE_TestCase *case_intmap;
+extern void build_case_intmap(void);
+
+extern CUTE_TestCase *case_hashmap;
+extern void build_case_hashmap(void);
+
+extern CUTE_TestCase *case_concurrentmap;
+extern void build_case_concurrentmap(void);
+
+extern CUTE_TestCase *case_cache;
+extern void build_case_cache(void);
+
+extern CUTE_TestCase *case_frozenmap;
+extern void build_case_frozenmap(void);
+
+extern CUTE_TestCase *case_stringpool;
+extern void build_case_stringpool(void);
+
+extern CUTE_TestCase *case_stringmap;
+extern void build_case_stringmap(void);
+
+extern CUTE_TestCase *case_persistentvector;
+extern void build_case_persistentvector(void);
+
 
 int main(void) {
 
@@ -60,13 +102,30 @@ int main(void) {
 	build_case_linkedlist();
 	build_case_sortedarray();
 	build_case_arraymap();
-
-	CUTE_prepareTestSuite(6, case_fixedarray, case_array, case_bitarray,
-	                      case_linkedlist, case_sortedarray, case_arraymap);
+	build_case_spscqueue();
+	build_case_intrusivelist();
+	build_case_skiplist();
+	build_case_bplustree();
+	build_case_intmap();
+	build_case_hashmap();
+	build_case_concurrentmap();
+	build_case_cache();
+	build_case_frozenmap();
+	build_case_stringpool();
+	build_case_stringmap();
+	build_case_persistentvector();
+
+	CUTE_prepareTestSuite(18, case_fixedarray, case_array, case_bitarray,
+	                      case_linkedlist, case_sortedarray, case_arraymap,
+	                      case_spscqueue, case_intrusivelist, case_skiplist,
+	                      case_bplustree, case_intmap, case_hashmap,
+	                      case_concurrentmap, case_cache, case_frozenmap,
+	                      case_stringpool, case_stringmap,
+	                      case_persistentvector);
 
 	results = CUTE_runTestSuite();
 
-	CUTE_printResults(6, results);
+	CUTE_printResults(18, results);
 
 
 	return EXIT_SUCCESS;
@@ -0,0 +1,148 @@
+#include "concurrentmap.h"
+
+#include <CUTE/cute.h>
+#include <clog.h> /* for logging macros */
+#include <stddef.h> /* for size_t */
+#include <stdlib.h> /* for NULL */
+
+
+
+/* The instance of test case */
+CUTE_TestCase *case_concurrentmap;
+
+
+
+static ConcurrentMap *concurrentmap;
+static CMReader *reader;
+
+extern int cmp_as_ints(const key_t*, const key_t*);
+extern const char cmp_as_ints_repr[];
+
+static const size_t CONCURRENT_MAP_SIZE = 6;
+static int KEYS[] = {12, 4, 31, 7, 20, 2};
+static int VALUES[] = {0, 1, 2, 3, 4, 5};
+
+
+static void init(void) {
+	verbose("concurrentmap = cm_new(%zu, %s)", CONCURRENT_MAP_SIZE,
+	        cmp_as_ints_repr);
+	concurrentmap = cm_new(CONCURRENT_MAP_SIZE, cmp_as_ints);
+	CUTE_assertNotEquals(concurrentmap, NULL);
+	for(size_t i = 0; i < CONCURRENT_MAP_SIZE; ++i) {
+		CUTE_runTimeAssert(cm_put(concurrentmap, &KEYS[i], &VALUES[i]));
+	}
+	reader = cm_reader_new(concurrentmap);
+	CUTE_assertNotEquals(reader, NULL);
+}
+
+static void cleanup(void) {
+	verbose("cm_free(concurrentmap)");
+	cm_free(concurrentmap);
+}
+
+
+static void test_cm_new__0_null(void) {
+	ConcurrentMap *got;
+	notice("test cm_new -- size 0 => NULL concurrentmap");
+	verbose("cm_new(0, %s)", cmp_as_ints_repr);
+	info("expected: (nil)");
+	got = cm_new(0, cmp_as_ints);
+	info("got     : %p", (void*)got); /* necessary cast because of GCC warning */
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertErrnoEquals(EINVAL);
+	verbose("OK");
+}
+
+static void test_cm_get(void) {
+	static int missing = 5;
+	int *got;
+	notice("test cm_get -- present and missing keys");
+	for(size_t i = 0; i < CONCURRENT_MAP_SIZE; ++i) {
+		verbose("cm_get(reader, &(%d))", KEYS[i]);
+		info("expected: %d", VALUES[i]);
+		got = cm_get(reader, &KEYS[i]);
+		CUTE_assertNotEquals(got, NULL);
+		info("got     : %d", *got);
+		CUTE_assertEquals(got, &VALUES[i]);
+	}
+	verbose("cm_get(reader, &(%d))", missing);
+	info("expected: (nil)");
+	got = cm_get(reader, &missing);
+	info("got     : %p", (void*)got);
+	CUTE_assertEquals(got, NULL);
+	verbose("OK");
+}
+
+static void test_cm_enter(void) {
+	static int key = 9, value = 6;
+	const ArrayMap *snapshot;
+	notice("test cm_enter -- a version is unchanged by later commits");
+	verbose("snapshot = cm_enter(reader)");
+	snapshot = cm_enter(reader);
+	CUTE_assertEquals(cm_put(concurrentmap, &key, &value), true);
+	CUTE_assertEquals(cm_remove(concurrentmap, &KEYS[0]), &VALUES[0]);
+	CUTE_assertEquals(am_get(snapshot, &key), NULL);
+	CUTE_assertEquals(am_get(snapshot, &KEYS[0]), &VALUES[0]);
+	verbose("cm_leave(reader)");
+	cm_leave(reader);
+	CUTE_assertEquals(cm_get(reader, &key), &value);
+	CUTE_assertEquals(cm_get(reader, &KEYS[0]), NULL);
+	CUTE_assertEquals(cm_remove(concurrentmap, &KEYS[0]), NULL);
+	CUTE_assertNoError();
+	verbose("OK");
+}
+
+static void test_cm_begin(void) {
+	static int keys[] = {40, 41, 42};
+	ArrayMap *draft;
+	notice("test cm_begin -- several changes published at once, or discarded");
+	verbose("draft = cm_begin(concurrentmap)");
+	draft = cm_begin(concurrentmap);
+	CUTE_assertNotEquals(draft, NULL);
+	for(size_t i = 0; i < 3; ++i) {
+		CUTE_assertEquals(am_put(draft, &keys[i], &keys[i]), true);
+	}
+	CUTE_assertEquals(am_remove(draft, &KEYS[1]), &VALUES[1]);
+	CUTE_assertEquals(cm_get(reader, &keys[0]), NULL);
+	verbose("cm_commit(concurrentmap, draft)");
+	cm_commit(concurrentmap, draft);
+	for(size_t i = 0; i < 3; ++i) {
+		CUTE_assertEquals(cm_get(reader, &keys[i]), &keys[i]);
+	}
+	CUTE_assertEquals(cm_get(reader, &KEYS[1]), NULL);
+	verbose("draft = cm_begin(concurrentmap)");
+	draft = cm_begin(concurrentmap);
+	CUTE_assertNotEquals(draft, NULL);
+	CUTE_assertEquals(am_remove(draft, &keys[0]), &keys[0]);
+	verbose("cm_abort(concurrentmap, draft)");
+	cm_abort(concurrentmap, draft);
+	CUTE_assertEquals(cm_get(reader, &keys[0]), &keys[0]);
+	verbose("OK");
+}
+
+static void test_cm_reader_new(void) {
+	CMReader *other;
+	notice("test cm_reader_new -- a released reader is reused");
+	verbose("cm_reader_free(reader)");
+	cm_reader_free(reader);
+	verbose("other = cm_reader_new(concurrentmap)");
+	other = cm_reader_new(concurrentmap);
+	CUTE_assertEquals(other, reader);
+	other = cm_reader_new(concurrentmap);
+	CUTE_assertNotEquals(other, NULL);
+	CUTE_assertNotEquals(other, reader);
+	CUTE_assertEquals(cm_get(other, &KEYS[2]), &VALUES[2]);
+	verbose("OK");
+}
+
+
+void build_case_concurrentmap(void) {
+	case_concurrentmap = CUTE_newTestCase("Tests for ConcurrentMap", 5);
+	CUTE_setCaseBefore(case_concurrentmap, init);
+	CUTE_setCaseAfter(case_concurrentmap, cleanup);
+	CUTE_addCaseTest(case_concurrentmap, CUTE_makeTest(test_cm_new__0_null));
+	CUTE_addCaseTest(case_concurrentmap, CUTE_makeTest(test_cm_get));
+	CUTE_addCaseTest(case_concurrentmap, CUTE_makeTest(test_cm_enter));
+	CUTE_addCaseTest(case_concurrentmap, CUTE_makeTest(test_cm_begin));
+	CUTE_addCaseTest(case_concurrentmap, CUTE_makeTest(test_cm_reader_new));
+}
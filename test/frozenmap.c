@@ -0,0 +1,172 @@
+#include "arraymap.h"
+#include "frozenmap.h"
+
+#include <CUTE/cute.h>
+#include <clog.h> /* for logging macros */
+#include <stddef.h> /* for size_t */
+#include <stdlib.h> /* for NULL, malloc(), free() */
+
+
+
+/* The instance of test case */
+CUTE_TestCase *case_frozenmap;
+
+
+
+static FrozenMap *map;
+
+extern int cmp_as_ints(const data_t*, const data_t*);
+extern const char cmp_as_ints_repr[];
+extern size_t hash_as_ints(const data_t*);
+extern const char hash_as_ints_repr[];
+
+#define MAP_SIZE 6
+static int KEYS[MAP_SIZE] = {12, 3, 45, 7, 100, 21};
+static int VALUES[MAP_SIZE] = {0, 1, 2, 3, 4, 5};
+static data_t *KEY_PTRS[MAP_SIZE];
+static data_t *VALUE_PTRS[MAP_SIZE];
+
+
+/* Gives the same hash to every key */
+static size_t hash_constant(const data_t *const key) {
+	(void)key;
+	return 42;
+}
+
+
+static void init(void) {
+	for(size_t i = 0; i < MAP_SIZE; ++i) {
+		KEY_PTRS[i] = &KEYS[i];
+		VALUE_PTRS[i] = &VALUES[i];
+	}
+	verbose("map = fm_new(KEYS, VALUES, %d, %s, %s)", MAP_SIZE,
+	        hash_as_ints_repr, cmp_as_ints_repr);
+	map = fm_new(KEY_PTRS, VALUE_PTRS, MAP_SIZE, hash_as_ints, cmp_as_ints);
+	CUTE_assertNotEquals(map, NULL);
+}
+
+static void cleanup(void) {
+	verbose("fm_free(map)");
+	fm_free(map);
+}
+
+
+static void test_fm_new__same_hash(void) {
+	FrozenMap *got;
+	notice("test fm_new -- two keys of the same hash => NULL map");
+	verbose("fm_new(KEYS, VALUES, %d, hash_constant, %s)", MAP_SIZE,
+	        cmp_as_ints_repr);
+	info("expected: (nil)");
+	got = fm_new(KEY_PTRS, VALUE_PTRS, MAP_SIZE, hash_constant, cmp_as_ints);
+	info("got     : %p", (void*)got); /* necessary cast because of GCC warning */
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertErrnoEquals(EINVAL);
+	verbose("OK");
+}
+
+static void test_fm_get(void) {
+	static int missing[] = {0, 4, 13, 99};
+	notice("test fm_get -- each key is found, no other");
+	CUTE_assertEquals(fm_size(map), MAP_SIZE);
+	for(size_t i = 0; i < MAP_SIZE; ++i) {
+		verbose("fm_get(map, &(%d))", KEYS[i]);
+		CUTE_assertEquals(fm_get(map, &KEYS[i]), &VALUES[i]);
+	}
+	for(size_t i = 0; i < sizeof(missing) / sizeof(*missing); ++i) {
+		verbose("fm_get(map, &(%d))", missing[i]);
+		CUTE_assertEquals(fm_get(map, &missing[i]), NULL);
+		CUTE_assertEquals(fm_contains(map, &missing[i]), false);
+	}
+	verbose("OK");
+}
+
+static void test_am_freeze(void) {
+	static int other = 8;
+	ArrayMap *source;
+	FrozenMap *frozen;
+	notice("test am_freeze -- the frozen map holds the same mappings");
+	source = am_new(MAP_SIZE, cmp_as_ints);
+	CUTE_assertNotEquals(source, NULL);
+	for(size_t i = 0; i < MAP_SIZE; ++i) {
+		CUTE_runTimeAssert(am_put(source, &KEYS[i], &VALUES[i]));
+	}
+	verbose("am_freeze(source, %s)", hash_as_ints_repr);
+	frozen = am_freeze(source, hash_as_ints);
+	CUTE_assertNotEquals(frozen, NULL);
+	CUTE_assertEquals(fm_size(frozen), MAP_SIZE);
+	/* the source may change afterwards */
+	am_put(source, &other, &other);
+	for(size_t i = 0; i < MAP_SIZE; ++i) {
+		CUTE_assertEquals(fm_get(frozen, &KEYS[i]), &VALUES[i]);
+	}
+	CUTE_assertEquals(fm_getd(frozen, &other, &VALUES[0]), &VALUES[0]);
+	fm_free(frozen);
+	am_free(source);
+	verbose("OK");
+}
+
+static void test_fm_load(void) {
+	FrozenMap *loaded;
+	size_t size;
+	char *data;
+	notice("test fm_load -- a saved map is rebuilt from the same keys");
+	size = fm_save(map, NULL, 0);
+	data = malloc(size);
+	CUTE_runTimeAssert(data != NULL);
+	verbose("fm_save(map, data, %zu)", size);
+	CUTE_assertEquals(fm_save(map, data, size), size);
+	verbose("fm_load(data, %zu, KEYS, VALUES, %d, %s, %s)", size, MAP_SIZE,
+	        hash_as_ints_repr, cmp_as_ints_repr);
+	loaded = fm_load(data, size, KEY_PTRS, VALUE_PTRS, MAP_SIZE, hash_as_ints,
+	                 cmp_as_ints);
+	CUTE_assertNotEquals(loaded, NULL);
+	CUTE_assertErrnoEquals(0);
+	for(size_t i = 0; i < MAP_SIZE; ++i) {
+		CUTE_assertEquals(fm_get(loaded, &KEYS[i]), &VALUES[i]);
+	}
+	fm_free(loaded);
+	free(data);
+	verbose("OK");
+}
+
+static void test_fm_load__other_keys(void) {
+	static int other = 8;
+	FrozenMap *got;
+	size_t size;
+	char *data;
+	notice("test fm_load -- keys other than the saved ones => NULL map");
+	size = fm_save(map, NULL, 0);
+	data = malloc(size);
+	CUTE_runTimeAssert(data != NULL);
+	fm_save(map, data, size);
+	KEY_PTRS[0] = &other;
+	verbose("fm_load(data, %zu, OTHER_KEYS, VALUES, %d, %s, %s)", size,
+	        MAP_SIZE, hash_as_ints_repr, cmp_as_ints_repr);
+	info("expected: (nil)");
+	got = fm_load(data, size, KEY_PTRS, VALUE_PTRS, MAP_SIZE, hash_as_ints,
+	              cmp_as_ints);
+	info("got     : %p", (void*)got);
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertErrnoEquals(EINVAL);
+	verbose("fm_load(data, %zu, KEYS, VALUES, %d, %s, %s)", size - 1,
+	        MAP_SIZE, hash_as_ints_repr, cmp_as_ints_repr);
+	KEY_PTRS[0] = &KEYS[0];
+	got = fm_load(data, size - 1, KEY_PTRS, VALUE_PTRS, MAP_SIZE, hash_as_ints,
+	              cmp_as_ints);
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertErrnoEquals(EINVAL);
+	free(data);
+	verbose("OK");
+}
+
+
+void build_case_frozenmap(void) {
+	case_frozenmap = CUTE_newTestCase("Tests for FrozenMap", 5);
+	CUTE_setCaseBefore(case_frozenmap, init);
+	CUTE_setCaseAfter(case_frozenmap, cleanup);
+	CUTE_addCaseTest(case_frozenmap, CUTE_makeTest(test_fm_new__same_hash));
+	CUTE_addCaseTest(case_frozenmap, CUTE_makeTest(test_fm_get));
+	CUTE_addCaseTest(case_frozenmap, CUTE_makeTest(test_am_freeze));
+	CUTE_addCaseTest(case_frozenmap, CUTE_makeTest(test_fm_load));
+	CUTE_addCaseTest(case_frozenmap, CUTE_makeTest(test_fm_load__other_keys));
+}
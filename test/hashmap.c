@@ -0,0 +1,142 @@
+#include "hashmap.h"
+
+
+#include <CUTE/cute.h>
+#include <clog.h> /* for logging macros */
+#include <stddef.h> /* for size_t */
+#include <stdlib.h> /* for NULL */
+
+
+
+/* The instance of test case */
+CUTE_TestCase *case_hashmap;
+
+
+
+static HashMap *hashmap;
+
+extern bool equal_as_ints(const data_t*, const data_t*);
+extern const char equal_as_ints_repr[];
+extern size_t hash_as_ints(const data_t*);
+extern const char hash_as_ints_repr[];
+
+static const size_t INT_HASH_MAP_SIZE = 10;
+static int KEYS[] = {9, 7, 1, 5, 40, 95, 65, 13, 27, 82};
+static int VALUES[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+/* Enough keys for the map to grow several times */
+#define MANY_KEYS 1000
+static int MANY[MANY_KEYS];
+
+
+static void init(void) {
+	verbose("hashmap = hm_new(%zu, %s, %s)", INT_HASH_MAP_SIZE,
+	        hash_as_ints_repr, equal_as_ints_repr);
+	hashmap = hm_new(INT_HASH_MAP_SIZE, hash_as_ints, equal_as_ints);
+	CUTE_assertNotEquals(hashmap, NULL);
+	for(size_t i = 0; i < INT_HASH_MAP_SIZE; ++i) {
+		CUTE_runTimeAssert(hm_put(hashmap, &KEYS[i], &VALUES[i]));
+	}
+}
+
+static void cleanup(void) {
+	verbose("hm_free(hashmap)");
+	hm_free(hashmap);
+}
+
+
+static void test_hm_new__0_null(void) {
+	HashMap *got;
+	notice("test hm_new -- size 0 => NULL hashmap");
+	verbose("hm_new(0, %s, %s)", hash_as_ints_repr, equal_as_ints_repr);
+	info("expected: (nil)");
+	got = hm_new(0, hash_as_ints, equal_as_ints);
+	info("got     : %p", (void*)got); /* necessary cast because of GCC warning */
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertErrnoEquals(EINVAL);
+	verbose("OK");
+}
+
+static void test_hm_get(void) {
+	static int missing = 8, d_val = -1;
+	int *got;
+	notice("test hm_get -- present and missing keys");
+	CUTE_assertEquals(hm_size(hashmap), INT_HASH_MAP_SIZE);
+	for(size_t i = 0; i < INT_HASH_MAP_SIZE; ++i) {
+		verbose("hm_get(hashmap, &(%d))", KEYS[i]);
+		info("expected: %d", VALUES[i]);
+		got = hm_get(hashmap, &KEYS[i]);
+		CUTE_assertNotEquals(got, NULL);
+		info("got     : %d", *got);
+		CUTE_assertEquals(got, &VALUES[i]);
+		CUTE_assertEquals(hm_contains(hashmap, &KEYS[i]), true);
+	}
+	verbose("hm_get(hashmap, &(%d))", missing);
+	info("expected: (nil)");
+	got = hm_get(hashmap, &missing);
+	info("got     : %p", (void*)got);
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertEquals(hm_contains(hashmap, &missing), false);
+	CUTE_assertEquals(hm_getd(hashmap, &missing, &d_val), &d_val);
+	verbose("OK");
+}
+
+static void test_hm_put__override(void) {
+	static int key = 40, value = 100;
+	notice("test hm_put -- an equal key overrides the value");
+	verbose("hm_put(hashmap, &(%d), &(%d))", key, value);
+	CUTE_assertEquals(hm_put(hashmap, &key, &value), true);
+	CUTE_assertNoError();
+	CUTE_assertEquals(hm_size(hashmap), INT_HASH_MAP_SIZE);
+	CUTE_assertEquals(hm_get(hashmap, &KEYS[4]), &value);
+	verbose("OK");
+}
+
+static void test_hm_remove(void) {
+	int *got;
+	notice("test hm_remove -- remove a key");
+	verbose("hm_remove(hashmap, &(%d))", KEYS[6]);
+	info("expected: %d", VALUES[6]);
+	got = hm_remove(hashmap, &KEYS[6]);
+	CUTE_assertEquals(got, &VALUES[6]);
+	CUTE_assertEquals(hm_contains(hashmap, &KEYS[6]), false);
+	CUTE_assertEquals(hm_size(hashmap), INT_HASH_MAP_SIZE - 1);
+	verbose("hm_remove(hashmap, &(%d))", KEYS[6]);
+	info("expected: (nil)");
+	got = hm_remove(hashmap, &KEYS[6]);
+	info("got     : %p", (void*)got);
+	CUTE_assertEquals(got, NULL);
+	verbose("OK");
+}
+
+static void test_hm_put__grow(void) {
+	notice("test hm_put -- growing, then removing half of the keys");
+	for(size_t i = 0; i < MANY_KEYS; ++i) {
+		MANY[i] = (int)i * 1024;
+		CUTE_assertEquals(hm_put(hashmap, &MANY[i], &MANY[i]), true);
+	}
+	CUTE_assertEquals(hm_size(hashmap), INT_HASH_MAP_SIZE + MANY_KEYS);
+	for(size_t i = 0; i < MANY_KEYS; i += 2) {
+		CUTE_assertEquals(hm_remove(hashmap, &MANY[i]), &MANY[i]);
+	}
+	CUTE_assertEquals(hm_size(hashmap), INT_HASH_MAP_SIZE + MANY_KEYS / 2);
+	for(size_t i = 0; i < MANY_KEYS; ++i) {
+		CUTE_assertEquals(hm_get(hashmap, &MANY[i]), i % 2 ? &MANY[i] : NULL);
+	}
+	for(size_t i = 0; i < INT_HASH_MAP_SIZE; ++i) {
+		CUTE_assertEquals(hm_get(hashmap, &KEYS[i]), &VALUES[i]);
+	}
+	verbose("OK");
+}
+
+
+void build_case_hashmap(void) {
+	case_hashmap = CUTE_newTestCase("Tests for HashMap", 5);
+	CUTE_setCaseBefore(case_hashmap, init);
+	CUTE_setCaseAfter(case_hashmap, cleanup);
+	CUTE_addCaseTest(case_hashmap, CUTE_makeTest(test_hm_new__0_null));
+	CUTE_addCaseTest(case_hashmap, CUTE_makeTest(test_hm_get));
+	CUTE_addCaseTest(case_hashmap, CUTE_makeTest(test_hm_put__override));
+	CUTE_addCaseTest(case_hashmap, CUTE_makeTest(test_hm_remove));
+	CUTE_addCaseTest(case_hashmap, CUTE_makeTest(test_hm_put__grow));
+}
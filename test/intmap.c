@@ -0,0 +1,154 @@
+#include "intmap.h"
+
+
+#include <CUTE/cute.h>
+#include <clog.h> /* for logging macros */
+#include <stddef.h> /* for size_t */
+#include <stdint.h> /* for int64_t, INT64_MIN, INT64_MAX */
+#include <stdlib.h> /* for NULL */
+
+
+
+/* The instance of test case */
+CUTE_TestCase *case_intmap;
+
+
+
+static IntMap *intmap;
+
+static const size_t INT_INT_MAP_SIZE = 10;
+static int64_t KEYS[] = {9, 7, 1, 5, 40, 95, 65, 13, 27, 82};
+static int64_t KEYS_SORTED[] = {1, 5, 7, 9, 13, 27, 40, 65, 82, 95};
+static int VALUES[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+
+static void init(void) {
+	verbose("intmap = im_new(%zu)", INT_INT_MAP_SIZE);
+	intmap = im_new(INT_INT_MAP_SIZE);
+	CUTE_assertNotEquals(intmap, NULL);
+	for(size_t i = 0; i < INT_INT_MAP_SIZE; ++i) {
+		CUTE_runTimeAssert(im_put(intmap, KEYS[i], &VALUES[i]));
+	}
+}
+
+static void cleanup(void) {
+	verbose("im_free(intmap)");
+	im_free(intmap);
+}
+
+
+static void test_im_new__0_null(void) {
+	IntMap *got;
+	notice("test im_new -- size 0 => NULL intmap");
+	verbose("im_new(0)");
+	info("expected: (nil)");
+	got = im_new(0);
+	info("got     : %p", (void*)got); /* necessary cast because of GCC warning */
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertErrnoEquals(EINVAL);
+	verbose("OK");
+}
+
+static void test_is_sorted__im_key(void) {
+	int64_t got;
+	notice("test im_key -- keys are sorted");
+	for(size_t i = 0; i < INT_INT_MAP_SIZE; ++i) {
+		verbose("im_key(intmap, %zu)", i);
+		info("expected: %lld", (long long)KEYS_SORTED[i]);
+		got = im_key(intmap, i);
+		info("got     : %lld", (long long)got);
+		CUTE_assertEquals(got, KEYS_SORTED[i]);
+	}
+	verbose("im_key(intmap, %zu)", INT_INT_MAP_SIZE);
+	info("expected: 0");
+	got = im_key(intmap, INT_INT_MAP_SIZE);
+	info("got     : %lld", (long long)got);
+	CUTE_assertEquals(got, 0);
+	CUTE_assertErrnoEquals(ERANGE);
+	verbose("OK");
+}
+
+static void test_im_get(void) {
+	int *got;
+	notice("test im_get -- with both searches");
+	for(int interpolate = 0; interpolate < 2; ++interpolate) {
+		verbose("im_set_interpolation(intmap, %d)", interpolate);
+		im_set_interpolation(intmap, interpolate);
+		for(size_t i = 0; i < INT_INT_MAP_SIZE; ++i) {
+			verbose("im_get(intmap, %lld)", (long long)KEYS[i]);
+			info("expected: %d", VALUES[i]);
+			got = im_get(intmap, KEYS[i]);
+			CUTE_assertNotEquals(got, NULL);
+			info("got     : %d", *got);
+			CUTE_assertEquals(got, &VALUES[i]);
+		}
+		verbose("im_get(intmap, 8)");
+		info("expected: (nil)");
+		got = im_get(intmap, 8);
+		info("got     : %p", (void*)got);
+		CUTE_assertEquals(got, NULL);
+		CUTE_assertEquals(im_lower_bound(intmap, 8), 3);
+		CUTE_assertEquals(im_lower_bound(intmap, 100), INT_INT_MAP_SIZE);
+	}
+	verbose("OK");
+}
+
+static void test_im_put_sorted(void) {
+	static const int64_t keys[] = {INT64_MIN, 0, 5, 50, 95, INT64_MAX};
+	static int values[] = {-1, -2, -3, -4, -5, -6};
+	static data_t *const pointers[] = {&values[0], &values[1], &values[2],
+	                                   &values[3], &values[4], &values[5]};
+	static const int64_t expected[] = {INT64_MIN, 0, 1, 5, 7, 9, 13, 27, 40,
+	                                   50, 65, 82, 95, INT64_MAX};
+	const size_t n = sizeof(keys) / sizeof(*keys);
+	const size_t size = sizeof(expected) / sizeof(*expected);
+	bool got;
+	notice("test im_put_sorted -- merge keys, override present ones");
+	verbose("im_put_sorted(intmap, {...}, {...}, %zu)", n);
+	got = im_put_sorted(intmap, keys, pointers, n);
+	CUTE_assertEquals(got, true);
+	CUTE_assertEquals(im_size(intmap), size);
+	for(size_t i = 0; i < size; ++i) {
+		info("expected: %lld", (long long)expected[i]);
+		info("got     : %lld", (long long)im_key(intmap, i));
+		CUTE_assertEquals(im_key(intmap, i), expected[i]);
+	}
+	for(size_t i = 0; i < n; ++i) {
+		CUTE_assertEquals(im_get(intmap, keys[i]), &values[i]);
+	}
+	verbose("im_put_sorted(intmap, {5, 5}, {...}, 2)");
+	got = im_put_sorted(intmap, (const int64_t[]){5, 5}, pointers, 2);
+	CUTE_assertEquals(got, false);
+	CUTE_assertErrnoEquals(EINVAL);
+	CUTE_assertEquals(im_size(intmap), size);
+	verbose("OK");
+}
+
+static void test_im_remove(void) {
+	int *got;
+	notice("test im_remove -- remove a key");
+	verbose("im_remove(intmap, 65)");
+	info("expected: %d", VALUES[6]);
+	got = im_remove(intmap, 65);
+	CUTE_assertEquals(got, &VALUES[6]);
+	CUTE_assertEquals(im_indexof(intmap, 65), -1);
+	CUTE_assertEquals(im_size(intmap), INT_INT_MAP_SIZE - 1);
+	verbose("im_remove(intmap, 65)");
+	info("expected: (nil)");
+	got = im_remove(intmap, 65);
+	info("got     : %p", (void*)got);
+	CUTE_assertEquals(got, NULL);
+	verbose("OK");
+}
+
+
+void build_case_intmap(void) {
+	case_intmap = CUTE_newTestCase("Tests for IntMap", 5);
+	CUTE_setCaseBefore(case_intmap, init);
+	CUTE_setCaseAfter(case_intmap, cleanup);
+	CUTE_addCaseTest(case_intmap, CUTE_makeTest(test_im_new__0_null));
+	CUTE_addCaseTest(case_intmap, CUTE_makeTest(test_is_sorted__im_key));
+	CUTE_addCaseTest(case_intmap, CUTE_makeTest(test_im_get));
+	CUTE_addCaseTest(case_intmap, CUTE_makeTest(test_im_put_sorted));
+	CUTE_addCaseTest(case_intmap, CUTE_makeTest(test_im_remove));
+}
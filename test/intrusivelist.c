@@ -0,0 +1,111 @@
+#include "intrusivelist.h"
+
+#include <CUTE/cute.h>
+#include <clog.h> /* for logging macros */
+#include <stddef.h> /* for size_t */
+#include <stdlib.h> /* for NULL */
+
+
+
+/* The instance of test case */
+CUTE_TestCase *case_intrusivelist;
+
+
+
+struct item {
+	long value;
+	IntrusiveNode node;
+};
+
+static IntrusiveList ilist;
+
+static const size_t INT_INTRUSIVE_LIST_SIZE = 4;
+static struct item ITEMS[] = {{5, {NULL, NULL}}, {10, {NULL, NULL}},
+                              {15, {NULL, NULL}}, {20, {NULL, NULL}}};
+
+
+static void init(void) {
+	verbose("il_init(&ilist)");
+	il_init(&ilist);
+	for(size_t i = 0; i < INT_INTRUSIVE_LIST_SIZE; ++i) {
+		il_push_back(&ilist, &ITEMS[i].node);
+	}
+}
+
+static void cleanup(void) {
+	verbose("emptying ilist");
+	while(il_pop_front(&ilist))
+		;
+}
+
+
+static void test_il_len(void) {
+	size_t got;
+	notice("test il_len");
+	verbose("il_len(&ilist)");
+	info("expected: %zu", INT_INTRUSIVE_LIST_SIZE);
+	got = il_len(&ilist);
+	info("got     : %zu", got);
+	CUTE_assertEquals(got, INT_INTRUSIVE_LIST_SIZE);
+	verbose("OK");
+}
+
+static void test_il_order(void) {
+	const IntrusiveNode *node;
+	size_t i = 0;
+	notice("test il_first/il_next -- nodes are in insertion order");
+	for(node = il_first(&ilist); node; node = il_next(&ilist, node), ++i) {
+		info("expected: %ld", ITEMS[i].value);
+		info("got     : %ld", IL_ENTRY(node, struct item, node)->value);
+		CUTE_assertEquals(IL_ENTRY(node, struct item, node), &ITEMS[i]);
+	}
+	CUTE_assertEquals(i, INT_INTRUSIVE_LIST_SIZE);
+	verbose("OK");
+}
+
+static void test_il_remove(void) {
+	notice("test il_remove -- remove an element by its node");
+	verbose("il_remove(&ilist, &ITEMS[1].node)");
+	il_remove(&ilist, &ITEMS[1].node);
+	CUTE_assertEquals(il_len(&ilist), INT_INTRUSIVE_LIST_SIZE - 1);
+	CUTE_assertEquals(il_linked(&ITEMS[1].node), false);
+	CUTE_assertEquals(il_next(&ilist, &ITEMS[0].node), &ITEMS[2].node);
+	CUTE_assertEquals(il_prev(&ilist, &ITEMS[2].node), &ITEMS[0].node);
+	verbose("OK");
+}
+
+static void test_il_move_front(void) {
+	notice("test il_move_front -- move the last element first");
+	verbose("il_move_front(&ilist, &ITEMS[3].node)");
+	il_move_front(&ilist, &ITEMS[3].node);
+	CUTE_assertEquals(il_len(&ilist), INT_INTRUSIVE_LIST_SIZE);
+	CUTE_assertEquals(il_first(&ilist), &ITEMS[3].node);
+	CUTE_assertEquals(il_last(&ilist), &ITEMS[2].node);
+	CUTE_assertEquals(il_next(&ilist, &ITEMS[3].node), &ITEMS[0].node);
+	CUTE_assertEquals(il_prev(&ilist, &ITEMS[3].node), NULL);
+	verbose("OK");
+}
+
+static void test_il_pop_back(void) {
+	IntrusiveNode *got;
+	notice("test il_pop_back");
+	verbose("il_pop_back(&ilist)");
+	info("expected: %p", (void*)&ITEMS[3].node);
+	got = il_pop_back(&ilist);
+	info("got     : %p", (void*)got);
+	CUTE_assertEquals(got, &ITEMS[3].node);
+	CUTE_assertEquals(il_last(&ilist), &ITEMS[2].node);
+	verbose("OK");
+}
+
+
+void build_case_intrusivelist(void) {
+	case_intrusivelist = CUTE_newTestCase("Tests for IntrusiveList", 5);
+	CUTE_setCaseBefore(case_intrusivelist, init);
+	CUTE_setCaseAfter(case_intrusivelist, cleanup);
+	CUTE_addCaseTest(case_intrusivelist, CUTE_makeTest(test_il_len));
+	CUTE_addCaseTest(case_intrusivelist, CUTE_makeTest(test_il_order));
+	CUTE_addCaseTest(case_intrusivelist, CUTE_makeTest(test_il_remove));
+	CUTE_addCaseTest(case_intrusivelist, CUTE_makeTest(test_il_move_front));
+	CUTE_addCaseTest(case_intrusivelist, CUTE_makeTest(test_il_pop_back));
+}
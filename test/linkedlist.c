@@ -23,6 +23,9 @@ static const size_t INT_LINKED_LIST_SIZE = 5;
 extern _Bool equal_as_ints(const data_t*, const data_t*);
 extern const char equal_as_ints_repr[];
 
+extern int cmp_as_ints(const data_t*, const data_t*);
+extern const char cmp_as_ints_repr[];
+
 extern void print_as_int(const data_t*);
 
 
@@ -315,9 +318,115 @@ static void test_ll_remove__not_found(void) {
 	verbose("OK");
 }
 
+static void test_ll_sort(void) {
+	static int sorted[] = {3, 6, 7, 13, 42};
+	int *got;
+	notice("test ll_sort");
+	verbose("ll_sort(llist, %s)", cmp_as_ints_repr);
+	ll_sort(llist, cmp_as_ints);
+	for(size_t i = 0; i < INT_LINKED_LIST_SIZE; ++i) {
+		verbose("ll_get(llist, %zu)", i);
+		info("expected: %d", sorted[i]);
+		got = ll_get(llist, i);
+		info("got     : %d", *got);
+		CUTE_assertEqualsUsing(got, &sorted[i], cmp_as_ints, 0);
+	}
+	CUTE_assertEquals(ll_len(llist), INT_LINKED_LIST_SIZE);
+	verbose("OK");
+}
+
+static void test_ll_sort__stable(void) {
+	static int values[] = {2, 1, 2, 1};
+	LinkedList *stable_llist;
+	data_t *const expected[] = {&values[1], &values[3], &values[0], &values[2]};
+	data_t *got;
+	notice("test ll_sort -- equivalent elements keep their order");
+	verbose("stable_llist = ll_new()");
+	stable_llist = ll_new();
+	for(size_t i = 0; i < 4; ++i) {
+		ll_append(stable_llist, &values[i]);
+	}
+	verbose("ll_sort(stable_llist, %s)", cmp_as_ints_repr);
+	ll_sort(stable_llist, cmp_as_ints);
+	for(size_t i = 0; i < 4; ++i) {
+		verbose("ll_get(stable_llist, %zu)", i);
+		info("expected: %p", expected[i]);
+		got = ll_get(stable_llist, i);
+		info("got     : %p", got);
+		CUTE_assertEquals(got, expected[i]);
+	}
+	ll_free(stable_llist);
+	verbose("OK");
+}
+
+static void test_ll_splice(void) {
+	static int values[] = {-1, -2};
+	LinkedList *other;
+	const size_t index = 2;
+	notice("test ll_splice -- insert a list in the middle");
+	verbose("other = ll_new()");
+	other = ll_new();
+	ll_append(other, &values[0]);
+	ll_append(other, &values[1]);
+	verbose("ll_splice(llist, %zu, other)", index);
+	ll_splice(llist, index, other);
+	CUTE_assertNoError();
+	info("expected length: %zu", INT_LINKED_LIST_SIZE + 2);
+	info("got            : %zu", ll_len(llist));
+	CUTE_assertEquals(ll_len(llist), INT_LINKED_LIST_SIZE + 2);
+	CUTE_assertEquals(ll_len(other), 0);
+	CUTE_assertEquals(ll_get(llist, 1), &VALUES[1]);
+	CUTE_assertEquals(ll_get(llist, 2), &values[0]);
+	CUTE_assertEquals(ll_get(llist, 3), &values[1]);
+	CUTE_assertEquals(ll_get(llist, 4), &VALUES[2]);
+	ll_free(other);
+	verbose("OK");
+}
+
+static void test_ll_concat(void) {
+	static int value = 77;
+	LinkedList *other;
+	notice("test ll_concat -- the end of the list is kept up to date");
+	verbose("other = ll_new()");
+	other = ll_new();
+	ll_append(other, &value);
+	verbose("ll_concat(llist, other)");
+	ll_concat(llist, other);
+	CUTE_assertEquals(ll_len(llist), INT_LINKED_LIST_SIZE + 1);
+	CUTE_assertEquals(ll_get(llist, INT_LINKED_LIST_SIZE), &value);
+	verbose("ll_append(llist, &(%d))", VALUES[0]);
+	ll_append(llist, &VALUES[0]);
+	CUTE_assertEquals(ll_get(llist, INT_LINKED_LIST_SIZE + 1), &VALUES[0]);
+	ll_free(other);
+	verbose("OK");
+}
+
+static size_t freed_count;
+static void count_freed(data_t *const item) {
+	(void)item;
+	++freed_count;
+}
+
+static void test_ll_freer__all_items(void) {
+	LinkedList *freed_llist;
+	notice("test ll_freer -- every item is freed, the last one included");
+	verbose("freed_llist = ll_new()");
+	freed_llist = ll_new();
+	for(size_t i = 0; i < INT_LINKED_LIST_SIZE; ++i) {
+		ll_append(freed_llist, &VALUES[i]);
+	}
+	freed_count = 0;
+	verbose("ll_freer(freed_llist, count_freed)");
+	ll_freer(freed_llist, count_freed);
+	info("expected: %zu", INT_LINKED_LIST_SIZE);
+	info("got     : %zu", freed_count);
+	CUTE_assertEquals(freed_count, INT_LINKED_LIST_SIZE);
+	verbose("OK");
+}
+
 
 void build_case_linkedlist(void) {
-	case_linkedlist = CUTE_newTestCase("Tests for LinkedList", 17);
+	case_linkedlist = CUTE_newTestCase("Tests for LinkedList", 22);
 	CUTE_setCaseBefore(case_linkedlist, init);
 	CUTE_setCaseAfter(case_linkedlist, cleanup);
 	CUTE_addCaseTest(case_linkedlist, CUTE_makeTest(test_ll_len__empty));
@@ -337,4 +446,9 @@ void build_case_linkedlist(void) {
 	CUTE_addCaseTest(case_linkedlist, CUTE_makeTest(test_ll_cond__not_found));
 	CUTE_addCaseTest(case_linkedlist, CUTE_makeTest(test_ll_remove__found));
 	CUTE_addCaseTest(case_linkedlist, CUTE_makeTest(test_ll_remove__not_found));
+	CUTE_addCaseTest(case_linkedlist, CUTE_makeTest(test_ll_sort));
+	CUTE_addCaseTest(case_linkedlist, CUTE_makeTest(test_ll_sort__stable));
+	CUTE_addCaseTest(case_linkedlist, CUTE_makeTest(test_ll_splice));
+	CUTE_addCaseTest(case_linkedlist, CUTE_makeTest(test_ll_concat));
+	CUTE_addCaseTest(case_linkedlist, CUTE_makeTest(test_ll_freer__all_items));
 }
@@ -0,0 +1,170 @@
+#include "persistentvector.h"
+
+#include <CUTE/cute.h>
+#include <clog.h> /* for logging macros */
+#include <stddef.h> /* for size_t */
+#include <stdlib.h> /* for NULL */
+
+
+
+/* The instance of test case */
+CUTE_TestCase *case_persistentvector;
+
+
+
+static PersistentVector *vector;
+
+/* Enough elements for a trie of two levels, besides the tail */
+static const size_t VECTOR_SIZE = 1100;
+static int VALUES[1100];
+
+
+static void init(void) {
+	verbose("vector = pv_new()");
+	vector = pv_new();
+	CUTE_assertNotEquals(vector, NULL);
+	for(size_t i = 0; i < VECTOR_SIZE; ++i) {
+		VALUES[i] = (int)i;
+		PersistentVector *const next = pv_push(vector, &VALUES[i]);
+		CUTE_assertNotEquals(next, NULL);
+		pv_free(vector);
+		vector = next;
+	}
+}
+
+static void cleanup(void) {
+	verbose("pv_free(vector)");
+	pv_free(vector);
+}
+
+
+static void test_pv_get__out_of_range(void) {
+	const size_t invalid_indices[] = {VECTOR_SIZE, VECTOR_SIZE + 40,
+	                                  (size_t)-1};
+	data_t *got;
+	notice("test pv_get -- invalid index => ERANGE");
+	CUTE_assertEquals(pv_size(vector), VECTOR_SIZE);
+	for(size_t i = 0; i < 3; ++i) {
+		const size_t index = invalid_indices[i];
+		verbose("pv_get(vector, %zu)", index);
+		info("expected: (nil)");
+		got = pv_get(vector, index);
+		info("got     : %p", got);
+		CUTE_assertEquals(got, NULL);
+		CUTE_assertErrnoEquals(ERANGE);
+	}
+	verbose("OK");
+}
+
+static void test_pv_set__versions(void) {
+	static int value = -1;
+	const size_t indices[] = {0, 500, VECTOR_SIZE - 1};
+	notice("test pv_set -- the former version is left unchanged");
+	for(size_t i = 0; i < 3; ++i) {
+		const size_t index = indices[i];
+		verbose("pv_set(vector, %zu, &<%d>)", index, value);
+		PersistentVector *const next = pv_set(vector, index, &value);
+		CUTE_assertNotEquals(next, NULL);
+		CUTE_assertNoError();
+		CUTE_assertEquals(pv_size(next), VECTOR_SIZE);
+		for(size_t j = 0; j < VECTOR_SIZE; ++j) {
+			CUTE_assertEquals(pv_get(vector, j), &VALUES[j]);
+			CUTE_assertEquals(pv_get(next, j),
+			                  j == index ? &value : &VALUES[j]);
+		}
+		pv_free(next);
+	}
+	CUTE_assertEquals(pv_set(vector, VECTOR_SIZE, &value), NULL);
+	CUTE_assertErrnoEquals(ERANGE);
+	verbose("OK");
+}
+
+static void test_pv_pop(void) {
+	PersistentVector *current = pv_copy(vector);
+	CUTE_assertNotEquals(current, NULL);
+	notice("test pv_pop -- versions shrink down to empty, the first one kept");
+	for(size_t n = VECTOR_SIZE; n > 0; --n) {
+		PersistentVector *const next = pv_pop(current);
+		CUTE_assertNotEquals(next, NULL);
+		CUTE_assertEquals(pv_size(next), n - 1);
+		CUTE_assertEquals(pv_get(current, n - 1), &VALUES[n - 1]);
+		if(n > 1) {
+			CUTE_assertEquals(pv_get(next, n - 2), &VALUES[n - 2]);
+		}
+		pv_free(current);
+		current = next;
+	}
+	verbose("pv_pop(<empty vector>)");
+	CUTE_assertEquals(pv_pop(current), NULL);
+	CUTE_assertErrnoEquals(ERANGE);
+	pv_free(current);
+	for(size_t i = 0; i < VECTOR_SIZE; ++i) {
+		CUTE_assertEquals(pv_get(vector, i), &VALUES[i]);
+	}
+	verbose("OK");
+}
+
+static void test_pv_transient(void) {
+	static int value = -1;
+	notice("test pv_transient -- a batch of changes published at once");
+	verbose("transient = pv_transient(vector)");
+	PVTransient *const transient = pv_transient(vector);
+	CUTE_assertNotEquals(transient, NULL);
+	for(size_t i = 0; i < VECTOR_SIZE; i += 2) {
+		CUTE_assertEquals(pv_transient_set(transient, i, &value), true);
+	}
+	for(size_t i = VECTOR_SIZE - 1; i >= VECTOR_SIZE - 100; --i) {
+		CUTE_assertEquals(pv_transient_pop(transient),
+		                  i % 2 ? &VALUES[i] : &value);
+	}
+	CUTE_assertEquals(pv_transient_push(transient, &value), true);
+	CUTE_assertEquals(pv_transient_size(transient), VECTOR_SIZE - 99);
+	CUTE_assertEquals(pv_transient_get(transient, VECTOR_SIZE - 100), &value);
+	verbose("next = pv_persistent(transient)");
+	PersistentVector *const next = pv_persistent(transient);
+	CUTE_assertEquals(pv_size(next), VECTOR_SIZE - 99);
+	for(size_t i = 0; i < VECTOR_SIZE - 100; ++i) {
+		CUTE_assertEquals(pv_get(next, i), i % 2 ? &VALUES[i] : &value);
+	}
+	CUTE_assertEquals(pv_size(vector), VECTOR_SIZE);
+	for(size_t i = 0; i < VECTOR_SIZE; ++i) {
+		CUTE_assertEquals(pv_get(vector, i), &VALUES[i]);
+	}
+	pv_free(next);
+	verbose("OK");
+}
+
+static void test_pv_from_array(void) {
+	notice("test pv_from_array -- the elements of the array, in order");
+	Array *const array = a_new(VECTOR_SIZE);
+	CUTE_assertNotEquals(array, NULL);
+	for(size_t i = 0; i < VECTOR_SIZE; ++i) {
+		a_append(array, &VALUES[i]);
+	}
+	verbose("pv_from_array(array)");
+	PersistentVector *const copy = pv_from_array(array);
+	CUTE_assertNotEquals(copy, NULL);
+	CUTE_assertNoError();
+	CUTE_assertEquals(pv_size(copy), VECTOR_SIZE);
+	for(size_t i = 0; i < VECTOR_SIZE; ++i) {
+		CUTE_assertEquals(pv_get(copy, i), &VALUES[i]);
+	}
+	pv_free(copy);
+	a_free(array);
+	verbose("OK");
+}
+
+
+void build_case_persistentvector(void) {
+	case_persistentvector = CUTE_newTestCase("Tests for PersistentVector", 5);
+	CUTE_setCaseBefore(case_persistentvector, init);
+	CUTE_setCaseAfter(case_persistentvector, cleanup);
+	CUTE_addCaseTest(case_persistentvector,
+	                 CUTE_makeTest(test_pv_get__out_of_range));
+	CUTE_addCaseTest(case_persistentvector,
+	                 CUTE_makeTest(test_pv_set__versions));
+	CUTE_addCaseTest(case_persistentvector, CUTE_makeTest(test_pv_pop));
+	CUTE_addCaseTest(case_persistentvector, CUTE_makeTest(test_pv_transient));
+	CUTE_addCaseTest(case_persistentvector,
+	                 CUTE_makeTest(test_pv_from_array));
+}
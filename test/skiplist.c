@@ -0,0 +1,204 @@
+#include "skiplist.h"
+
+
+#include <CUTE/cute.h>
+#include <clog.h> /* for logging macros */
+#include <stddef.h> /* for size_t */
+#include <stdlib.h> /* for NULL */
+
+
+
+/* The instance of test case */
+CUTE_TestCase *case_skiplist;
+
+
+
+static SkipList *skiplist;
+
+extern int cmp_as_ints(const data_t*, const data_t*);
+extern const char cmp_as_ints_repr[];
+
+static const size_t INT_SKIP_LIST_SIZE = 10;
+static int VALUES[] = {9 ,7, 1, 5, 40, 95, 65, 13, 27, 82};
+static int VALUES_SORTED[] = {1, 5, 7, 9, 13, 27, 40, 65, 82, 95};
+
+
+static void init(void) {
+	verbose("skiplist = sl_new(%zu, %s)", INT_SKIP_LIST_SIZE,
+	        cmp_as_ints_repr);
+	skiplist = sl_new(INT_SKIP_LIST_SIZE, cmp_as_ints);
+	CUTE_assertNotEquals(skiplist, NULL);
+	for(size_t i = 0; i < INT_SKIP_LIST_SIZE; ++i) {
+		const ssize_t r = sl_add(skiplist, &VALUES[i]);
+		CUTE_runTimeAssert(r >= 0);
+	}
+}
+
+static void cleanup(void) {
+	verbose("sl_free(skiplist)");
+	sl_free(skiplist);
+}
+
+
+static void test_sl_new__0_null(void) {
+	SkipList *got;
+	notice("test sl_new -- size 0 => NULL skiplist");
+	verbose("sl_new(0, NULL)");
+	info("expected: (nil)");
+	got = sl_new(0, cmp_as_ints);
+	info("got     : %p", (void*)got); /* necessary cast because of GCC warning */
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertErrnoEquals(EINVAL);
+	verbose("OK");
+}
+
+static void test_sl_size__empty(void) {
+	SkipList *empty_slist;
+	size_t got;
+	notice("test sl_size -- empty SkipList == 0");
+	info("empty_slist = sl_new(%zu, %s)", INT_SKIP_LIST_SIZE,
+	     cmp_as_ints_repr);
+	empty_slist = sl_new(INT_SKIP_LIST_SIZE, cmp_as_ints);
+	verbose("sl_size(empty_slist)");
+	info("expected: 0");
+	got = sl_size(empty_slist);
+	info("got     : %zu", got);
+	CUTE_assertEquals(got, 0);
+	sl_free(empty_slist);
+	verbose("OK");
+}
+
+static void test_sl_size(void) {
+	size_t got;
+	notice("test sl_size(skiplist) == %zu", INT_SKIP_LIST_SIZE);
+	verbose("sl_size(skiplist)");
+	info("expected: %zu", INT_SKIP_LIST_SIZE);
+	got = sl_size(skiplist);
+	info("got     : %zu", got);
+	CUTE_assertEquals(got, INT_SKIP_LIST_SIZE);
+	verbose("OK");
+}
+
+static void test_is_sorted__sl_get(void) {
+	const size_t s = sl_size(skiplist);
+	int *expected, *got;
+	notice("test skiplist is actually sorted");
+	for(size_t i = 0; i < s; ++i) {
+		verbose("sl_get(skiplist, %zu)", i);
+		expected = &VALUES_SORTED[i];
+		info("expected: %d", *expected);
+		got = sl_get(skiplist, i);
+		info("got     : %d", *got);
+		CUTE_assertEqualsUsing(got, expected, cmp_as_ints, 0);
+	}
+	verbose("OK");
+}
+
+static void test_sl_indexof(void) {
+	ssize_t expected, got;
+	notice("test sl_indexof");
+	for(size_t i = 0; i < INT_SKIP_LIST_SIZE; ++i) {
+		verbose("sl_indexof(skiplist, %zu)", i);
+		expected = (ssize_t)i;
+		info("expected: %zd", expected);
+		got = sl_indexof(skiplist, &VALUES_SORTED[i]);
+		info("got     : %zd", got);
+		CUTE_assertEquals(got, expected);
+	}
+	verbose("OK");
+}
+
+static void test_sl_add__last(void) {
+	static int value = 1024;
+	ssize_t expected, got;
+	notice("test sl_add() -- add item last in array");
+	verbose("sl_add(skiplist, &(%d))", value);
+	expected = INT_SKIP_LIST_SIZE;
+	info("expected: %zu", expected);
+	got = sl_add(skiplist, &value);
+	info("got     : %zu", got);
+	CUTE_assertEquals(got, expected);
+	verbose("OK");
+	// a-posteriori check of the value actually set
+	info("A posteriori validity check: sl_get(skiplist, %zu) == %d",
+	     INT_SKIP_LIST_SIZE, value);
+	CUTE_assertEquals(sl_get(skiplist, INT_SKIP_LIST_SIZE), &value);
+}
+
+static void test_sl_add_dup(void) {
+	static int value = 13;
+	ssize_t expected, got;
+	notice("test sl_add() -- duplicate item is not added");
+	verbose("sl_add(skiplist, &(%d))", value);
+	expected = -1;
+	info("expected: %zu", expected);
+	got = sl_add(skiplist, &value);
+	info("got     : %zu", got);
+	CUTE_assertEquals(got, expected);
+	verbose("OK");
+}
+
+static void test_sl_get__invalid(void) {
+	data_t *got;
+	notice("test sl_get -- invalid index");
+	verbose("sl_get(skiplist, %zu)", INT_SKIP_LIST_SIZE);
+	info("expected: (nil)");
+	got = sl_get(skiplist, INT_SKIP_LIST_SIZE);
+	info("got     : %p", got);
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertErrnoEquals(ERANGE);
+	verbose("OK");
+}
+
+static void test_sl_drop(void) {
+	const size_t index = 4;
+	int *expected, *got;
+	notice("test sl_drop -- the following elements move down");
+	verbose("sl_drop(skiplist, %zu)", index);
+	expected = &VALUES_SORTED[index];
+	info("expected: %d", *expected);
+	got = sl_drop(skiplist, index);
+	info("got     : %d", *got);
+	CUTE_assertEqualsUsing(got, expected, cmp_as_ints, 0);
+	CUTE_assertEquals(sl_size(skiplist), INT_SKIP_LIST_SIZE - 1);
+	for(size_t i = index; i < INT_SKIP_LIST_SIZE - 1; ++i) {
+		got = sl_get(skiplist, i);
+		CUTE_assertEqualsUsing(got, &VALUES_SORTED[i + 1], cmp_as_ints, 0);
+	}
+	verbose("OK");
+}
+
+static void test_sl_remove(void) {
+	static int value = 65;
+	int *got;
+	notice("test sl_remove -- remove an equivalent element");
+	verbose("sl_remove(skiplist, &(%d))", value);
+	info("expected: %d", value);
+	got = sl_remove(skiplist, &value);
+	info("got     : %d", *got);
+	CUTE_assertEqualsUsing(got, &value, cmp_as_ints, 0);
+	CUTE_assertEquals(sl_indexof(skiplist, &value), -1);
+	verbose("sl_remove(skiplist, &(%d))", value);
+	info("expected: (nil)");
+	got = sl_remove(skiplist, &value);
+	info("got     : %p", (void*)got);
+	CUTE_assertEquals(got, NULL);
+	verbose("OK");
+}
+
+
+void build_case_skiplist(void) {
+	case_skiplist = CUTE_newTestCase("Tests for SkipList", 10);
+	CUTE_setCaseBefore(case_skiplist, init);
+	CUTE_setCaseAfter(case_skiplist, cleanup);
+	CUTE_addCaseTest(case_skiplist, CUTE_makeTest(test_sl_new__0_null));
+	CUTE_addCaseTest(case_skiplist, CUTE_makeTest(test_sl_size__empty));
+	CUTE_addCaseTest(case_skiplist, CUTE_makeTest(test_sl_size));
+	CUTE_addCaseTest(case_skiplist, CUTE_makeTest(test_is_sorted__sl_get));
+	CUTE_addCaseTest(case_skiplist, CUTE_makeTest(test_sl_indexof));
+	CUTE_addCaseTest(case_skiplist, CUTE_makeTest(test_sl_add__last));
+	CUTE_addCaseTest(case_skiplist, CUTE_makeTest(test_sl_add_dup));
+	CUTE_addCaseTest(case_skiplist, CUTE_makeTest(test_sl_get__invalid));
+	CUTE_addCaseTest(case_skiplist, CUTE_makeTest(test_sl_drop));
+	CUTE_addCaseTest(case_skiplist, CUTE_makeTest(test_sl_remove));
+}
@@ -107,6 +107,35 @@ static void test_sa_indexof(void) {
 	verbose("OK");
 }
 
+static void test_sa_indexof_many(void) {
+	static int missing[] = {0, 6, 100};
+	data_t *values[INT_SORTED_ARRAY_SIZE + 3];
+	ssize_t indices[INT_SORTED_ARRAY_SIZE + 3];
+	size_t got;
+	notice("test sa_indexof_many -- unsorted, then sorted values");
+	for(size_t i = 0; i < INT_SORTED_ARRAY_SIZE; ++i) {
+		values[i] = &VALUES[i];
+	}
+	for(size_t i = 0; i < 3; ++i) {
+		values[INT_SORTED_ARRAY_SIZE + i] = &missing[i];
+	}
+	got = sa_indexof_many(sortedarray, values, INT_SORTED_ARRAY_SIZE + 3,
+	                      indices);
+	CUTE_assertEquals(got, INT_SORTED_ARRAY_SIZE);
+	for(size_t i = 0; i < INT_SORTED_ARRAY_SIZE + 3; ++i) {
+		CUTE_assertEquals(indices[i], sa_indexof(sortedarray, values[i]));
+	}
+	for(size_t i = 0; i < INT_SORTED_ARRAY_SIZE; ++i) {
+		values[i] = &VALUES_SORTED[i];
+	}
+	got = sa_indexof_many(sortedarray, values, INT_SORTED_ARRAY_SIZE, indices);
+	CUTE_assertEquals(got, INT_SORTED_ARRAY_SIZE);
+	for(size_t i = 0; i < INT_SORTED_ARRAY_SIZE; ++i) {
+		CUTE_assertEquals(indices[i], (ssize_t)i);
+	}
+	verbose("OK");
+}
+
 static void test_sa_add__last(void) {
 	static int value = 1024;
 	ssize_t expected, got;
@@ -137,10 +166,457 @@ static void test_sa_add_dup(void) {
 	verbose("OK");
 }
 
+static void test_sa_add_many(void) {
+	static int values[] = {100, 3, 13, 50, 3};
+	static int expected_sorted[] = {1, 3, 5, 7, 9, 13, 27, 40, 50, 65, 82, 95,
+	                                100};
+	data_t *const items[] = {&values[0], &values[1], &values[2], &values[3],
+	                         &values[4]};
+	data_t *rejected[5];
+	ssize_t got;
+	notice("test sa_add_many -- duplicates are rejected, the rest merged");
+	verbose("sa_add_many(sortedarray, {100, 3, 13, 50, 3}, 5, rejected)");
+	info("expected: 3");
+	got = sa_add_many(sortedarray, items, 5, rejected);
+	info("got     : %zd", got);
+	CUTE_assertEquals(got, 3);
+	CUTE_assertNoError();
+	/* the first 3 is kept, the second one is rejected */
+	CUTE_assertEquals(rejected[0], &values[4]);
+	CUTE_assertEquals(rejected[1], &values[2]);
+	CUTE_assertEquals(sa_size(sortedarray), INT_SORTED_ARRAY_SIZE + 3);
+	for(size_t i = 0; i < INT_SORTED_ARRAY_SIZE + 3; ++i) {
+		CUTE_assertEqualsUsing(sa_get(sortedarray, i), &expected_sorted[i],
+		                       cmp_as_ints, 0);
+	}
+	CUTE_assertEquals(sa_get(sortedarray, 1), &values[1]);
+	verbose("OK");
+}
+
+static void test_sa_from_unsorted(void) {
+	data_t *items[INT_SORTED_ARRAY_SIZE + 1];
+	SortedArray *built;
+	notice("test sa_from_unsorted");
+	for(size_t i = 0; i < INT_SORTED_ARRAY_SIZE; ++i) {
+		items[i] = &VALUES[i];
+	}
+	items[INT_SORTED_ARRAY_SIZE] = &VALUES[0];
+	verbose("sa_from_unsorted(items, %zu, %s)", INT_SORTED_ARRAY_SIZE + 1,
+	        cmp_as_ints_repr);
+	built = sa_from_unsorted(items, INT_SORTED_ARRAY_SIZE + 1, cmp_as_ints);
+	CUTE_assertNotEquals(built, NULL);
+	CUTE_assertEquals(sa_size(built), INT_SORTED_ARRAY_SIZE);
+	for(size_t i = 0; i < INT_SORTED_ARRAY_SIZE; ++i) {
+		CUTE_assertEqualsUsing(sa_get(built, i), &VALUES_SORTED[i],
+		                       cmp_as_ints, 0);
+	}
+	sa_free(built);
+	verbose("OK");
+}
+
+static void test_sa_bounds(void) {
+	int below = 0, between = 6, present = 7, above = 100;
+	size_t first, last;
+	notice("test sa_lower_bound/sa_upper_bound/sa_equal_range");
+	CUTE_assertEquals(sa_lower_bound(sortedarray, &below), 0);
+	CUTE_assertEquals(sa_upper_bound(sortedarray, &below), 0);
+	CUTE_assertEquals(sa_lower_bound(sortedarray, &between), 2);
+	CUTE_assertEquals(sa_upper_bound(sortedarray, &between), 2);
+	CUTE_assertEquals(sa_lower_bound(sortedarray, &present), 2);
+	CUTE_assertEquals(sa_upper_bound(sortedarray, &present), 3);
+	CUTE_assertEquals(sa_lower_bound(sortedarray, &above),
+	                  INT_SORTED_ARRAY_SIZE);
+	sa_equal_range(sortedarray, &present, &first, &last);
+	CUTE_assertEquals(first, 2);
+	CUTE_assertEquals(last, 3);
+	sa_equal_range(sortedarray, &between, &first, &last);
+	CUTE_assertEquals(first, 2);
+	CUTE_assertEquals(last, 2);
+	verbose("OK");
+}
+
+static void sum_ints(data_t *const item, void *const ctx) {
+	*(int*)ctx += *(int*)item;
+}
+
+static void test_sa_foreach_range(void) {
+	static int pending[] = {6, 30, 45};
+	int lo = 5, hi = 40, sum = 0;
+	notice("test sa_foreach_range -- sum of the elements in [5, 40)");
+	verbose("sa_foreach_range(sortedarray, %d, %d, sum_ints, &sum)", lo, hi);
+	info("expected: %d", 5 + 7 + 9 + 13 + 27);
+	sa_foreach_range(sortedarray, &lo, &hi, sum_ints, &sum);
+	info("got     : %d", sum);
+	CUTE_assertEquals(sum, 5 + 7 + 9 + 13 + 27);
+	sum = 0;
+	sa_foreach_range(sortedarray, &hi, &lo, sum_ints, &sum);
+	CUTE_assertEquals(sum, 0);
+	verbose("with {6, 30, 45} pending, 7 and 27 removed");
+	CUTE_assertEquals(sa_set_buffer(sortedarray, 10), true);
+	for(size_t i = 0; i < 3; ++i) {
+		CUTE_runTimeAssert(sa_add(sortedarray, &pending[i]) >= 0);
+	}
+	CUTE_runTimeAssert(sa_remove(sortedarray, &VALUES[1]) != NULL);
+	CUTE_runTimeAssert(sa_remove(sortedarray, &VALUES[8]) != NULL);
+	sum = 0;
+	sa_foreach_range(sortedarray, &lo, &hi, sum_ints, &sum);
+	CUTE_assertEquals(sum, 5 + 6 + 9 + 13 + 30);
+	verbose("OK");
+}
+
+static void test_sa_setops(void) {
+	static int values[] = {50, 13, 5};
+	static int union_sorted[] = {1, 5, 7, 9, 13, 27, 40, 50, 65, 82, 95};
+	SortedArray *other, *got;
+	notice("test sa_union/sa_intersection/sa_difference/sa_symdiff");
+	other = sa_new(3, cmp_as_ints);
+	for(size_t i = 0; i < 3; ++i) {
+		sa_add(other, &values[i]);
+	}
+	verbose("sa_union(sortedarray, {5, 13, 50})");
+	got = sa_union(sortedarray, other);
+	CUTE_assertNotEquals(got, NULL);
+	CUTE_assertEquals(sa_size(got), 11);
+	for(size_t i = 0; i < 11; ++i) {
+		CUTE_assertEqualsUsing(sa_get(got, i), &union_sorted[i], cmp_as_ints,
+		                       0);
+	}
+	/* equivalent elements are taken from the first array */
+	CUTE_assertEquals(sa_get(got, 1), &VALUES[3]);
+	sa_free(got);
+	verbose("sa_intersection(sortedarray, {5, 13, 50})");
+	got = sa_intersection(sortedarray, other);
+	CUTE_assertEquals(sa_size(got), 2);
+	CUTE_assertEquals(sa_get(got, 0), &VALUES[3]);
+	CUTE_assertEquals(sa_get(got, 1), &VALUES[7]);
+	sa_free(got);
+	verbose("sa_difference(sortedarray, {5, 13, 50})");
+	got = sa_difference(sortedarray, other);
+	CUTE_assertEquals(sa_size(got), INT_SORTED_ARRAY_SIZE - 2);
+	CUTE_assertEquals(sa_indexof(got, &values[1]), -1);
+	sa_free(got);
+	verbose("sa_symdiff(sortedarray, {5, 13, 50})");
+	got = sa_symdiff(sortedarray, other);
+	CUTE_assertEquals(sa_size(got), INT_SORTED_ARRAY_SIZE - 1);
+	CUTE_assertEquals(sa_get(got, 5), &values[0]);
+	sa_free(got);
+	CUTE_assertEquals(sa_union_count(sortedarray, other), 11);
+	CUTE_assertEquals(sa_intersection_count(sortedarray, other), 2);
+	CUTE_assertEquals(sa_difference_count(sortedarray, other),
+	                  INT_SORTED_ARRAY_SIZE - 2);
+	CUTE_assertEquals(sa_symdiff_count(sortedarray, other),
+	                  INT_SORTED_ARRAY_SIZE - 1);
+	sa_free(other);
+	verbose("OK");
+}
+
+static void test_sa_setops__gallop(void) {
+	static int values[200];
+	int value = 124;
+	SortedArray *large, *small;
+	notice("test sa_*_count -- small set galloped in a large one");
+	large = sa_new(200, cmp_as_ints);
+	small = sa_new(1, cmp_as_ints);
+	for(size_t i = 0; i < 200; ++i) {
+		values[i] = 2 * (int)i;
+		sa_add(large, &values[i]);
+	}
+	sa_add(small, &value);
+	CUTE_assertEquals(sa_intersection_count(large, small), 1);
+	CUTE_assertEquals(sa_difference_count(large, small), 199);
+	CUTE_assertEquals(sa_difference_count(small, large), 0);
+	value = 125;
+	CUTE_assertEquals(sa_union_count(small, large), 201);
+	CUTE_assertEquals(sa_symdiff_count(large, small), 201);
+	CUTE_assertEquals(sa_intersection_count(small, large), 0);
+	sa_free(small);
+	sa_free(large);
+	verbose("OK");
+}
+
+static void test_sa_setops__buffer(void) {
+	static int values[] = {50, 0, 5, 13, 96, 3, 124, 125};
+	static int union_sorted[] = {0, 1, 5, 9, 13, 27, 40, 50, 82, 95, 96};
+	static int large_values[200];
+	SortedArray *other, *got;
+	notice("test sa_*_count -- pending insertions and removals are read");
+	verbose("sa_set_buffer(sortedarray, 100)");
+	CUTE_assertEquals(sa_set_buffer(sortedarray, 100), true);
+	sa_add(sortedarray, &values[0]);
+	sa_add(sortedarray, &values[1]);
+	sa_remove(sortedarray, &VALUES_SORTED[2]);
+	sa_remove(sortedarray, &VALUES_SORTED[7]);
+	other = sa_new(4, cmp_as_ints);
+	sa_add(other, &values[2]);
+	CUTE_assertEquals(sa_set_buffer(other, 100), true);
+	for(size_t i = 3; i < 5; ++i) {
+		sa_add(other, &values[i]);
+	}
+	sa_add(other, &values[0]);
+	CUTE_assertEquals(sa_union_count(sortedarray, other), 11);
+	CUTE_assertEquals(sa_intersection_count(sortedarray, other), 3);
+	CUTE_assertEquals(sa_difference_count(sortedarray, other), 7);
+	CUTE_assertEquals(sa_symdiff_count(other, sortedarray), 8);
+	got = sa_union(sortedarray, other);
+	CUTE_assertNotEquals(got, NULL);
+	CUTE_assertEquals(sa_size(got), 11);
+	for(size_t i = 0; i < 11; ++i) {
+		CUTE_assertEqualsUsing(sa_get(got, i), &union_sorted[i], cmp_as_ints,
+		                       0);
+	}
+	sa_free(got);
+	/* the operands are left as they were */
+	CUTE_assertEquals(sa_size(sortedarray), INT_SORTED_ARRAY_SIZE);
+	CUTE_assertEquals(sa_get(sortedarray, 0), &values[1]);
+	CUTE_assertEquals(sa_indexof(sortedarray, &VALUES_SORTED[7]), -1);
+	sa_free(other);
+
+	verbose("galloping, with pending elements in the smaller set");
+	other = sa_new(200, cmp_as_ints);
+	for(size_t i = 0; i < 200; ++i) {
+		large_values[i] = 2 * (int)i;
+		sa_add(other, &large_values[i]);
+	}
+	SortedArray *const small = sa_new(2, cmp_as_ints);
+	sa_add(small, &values[5]);
+	sa_add(small, &values[6]);
+	CUTE_assertEquals(sa_set_buffer(small, 10), true);
+	sa_add(small, &values[7]);
+	sa_remove(small, &values[5]);
+	CUTE_assertEquals(sa_intersection_count(other, small), 1);
+	CUTE_assertEquals(sa_union_count(small, other), 201);
+	CUTE_assertEquals(sa_symdiff_count(other, small), 200);
+	CUTE_assertEquals(sa_difference_count(small, other), 1);
+	verbose("the larger set with a removed element is merged linearly");
+	CUTE_assertEquals(sa_set_buffer(other, 10), true);
+	sa_remove(other, &values[6]);
+	CUTE_assertEquals(sa_intersection_count(small, other), 0);
+	CUTE_assertEquals(sa_union_count(other, small), 201);
+	sa_free(small);
+	sa_free(other);
+	verbose("OK");
+}
+
+static uint64_t prefix_as_ints(const data_t *const item) {
+	/* a coarse prefix, so that several elements share it */
+	return (uint64_t)(*(const int*)item / 10);
+}
+
+static void test_sa_new_prefixed(void) {
+	SortedArray *prefixed;
+	int missing = 8;
+	notice("test sa_new_prefixed -- searches through the key prefixes");
+	prefixed = sa_new_prefixed(1, cmp_as_ints, prefix_as_ints);
+	CUTE_assertNotEquals(prefixed, NULL);
+	for(size_t i = 0; i < INT_SORTED_ARRAY_SIZE; ++i) {
+		CUTE_assertNotEquals(sa_add(prefixed, &VALUES[i]), -1);
+	}
+	CUTE_assertEquals(sa_add(prefixed, &VALUES[0]), -1);
+	for(size_t i = 0; i < INT_SORTED_ARRAY_SIZE; ++i) {
+		CUTE_assertEqualsUsing(sa_get(prefixed, i), &VALUES_SORTED[i],
+		                       cmp_as_ints, 0);
+		CUTE_assertEquals(sa_indexof(prefixed, &VALUES_SORTED[i]), (ssize_t)i);
+	}
+	CUTE_assertEquals(sa_indexof(prefixed, &missing), -1);
+	CUTE_assertEquals(sa_lower_bound(prefixed, &missing), 3);
+	verbose("sa_remove(prefixed, %d)", VALUES_SORTED[1]);
+	CUTE_assertEquals(sa_remove(prefixed, &VALUES_SORTED[1]), &VALUES[3]);
+	CUTE_assertEquals(sa_indexof(prefixed, &VALUES_SORTED[2]), 1);
+	sa_free(prefixed);
+	verbose("OK");
+}
+
+static void test_sa_set_buffer(void) {
+	static int values[] = {50, 0, 96};
+	static int expected_sorted[] = {0, 1, 5, 9, 13, 27, 40, 50, 82, 95, 96};
+	notice("test sa_set_buffer -- pending insertions and removals");
+	verbose("sa_set_buffer(sortedarray, 4)");
+	CUTE_assertEquals(sa_set_buffer(sortedarray, 4), true);
+	for(size_t i = 0; i < 3; ++i) {
+		CUTE_assertNotEquals(sa_add(sortedarray, &values[i]), -1);
+	}
+	CUTE_assertEquals(sa_add(sortedarray, &values[0]), -1);
+	CUTE_assertEquals(sa_add(sortedarray, &VALUES[0]), -1);
+	CUTE_assertEquals(sa_remove(sortedarray, &VALUES_SORTED[2]), &VALUES[1]);
+	CUTE_assertEquals(sa_remove(sortedarray, &VALUES_SORTED[2]), NULL);
+	/* reaches the threshold: merges the buffer */
+	CUTE_assertEquals(sa_remove(sortedarray, &VALUES_SORTED[7]), &VALUES[6]);
+	CUTE_assertEquals(sa_size(sortedarray), 11);
+	for(size_t i = 0; i < 11; ++i) {
+		CUTE_assertEqualsUsing(sa_get(sortedarray, i), &expected_sorted[i],
+		                       cmp_as_ints, 0);
+		CUTE_assertEquals(sa_indexof(sortedarray, &expected_sorted[i]),
+		                  (ssize_t)i);
+	}
+	CUTE_assertEquals(sa_drop(sortedarray, 0), &values[1]);
+	CUTE_assertEquals(sa_flush(sortedarray), true);
+	CUTE_assertEquals(sa_size(sortedarray), 10);
+	CUTE_assertEquals(sa_get(sortedarray, 9), &values[2]);
+	CUTE_assertEquals(sa_set_buffer(sortedarray, 0), true);
+	verbose("OK");
+}
+
+static void test_sa_set_buffer__free(void) {
+	int *values[200];
+	SortedArray *big_sarray;
+	const size_t n = sizeof(values) / sizeof(*values);
+	notice("test sa_set_buffer -- the searches never read the elements removed");
+	verbose("big_sarray = sa_new(%zu, %s)", n, cmp_as_ints_repr);
+	big_sarray = sa_new(n, cmp_as_ints);
+	for(size_t i = 0; i < n; ++i) {
+		values[i] = malloc(sizeof(int));
+		CUTE_runTimeAssert(values[i] != NULL);
+		*values[i] = (int)i;
+		CUTE_runTimeAssert(sa_add(big_sarray, values[i]) >= 0);
+	}
+	verbose("sa_set_buffer(big_sarray, %zu)", n);
+	CUTE_assertEquals(sa_set_buffer(big_sarray, n), true);
+	verbose("removing and freeing every third element");
+	for(size_t i = 0; i < n; i += 3) {
+		free(sa_remove(big_sarray, values[i]));
+		values[i] = NULL;
+	}
+	for(size_t i = 0, live = 0; i < n; ++i) {
+		const int value = (int)i;
+		CUTE_assertEquals(sa_indexof(big_sarray, &value) >= 0, i % 3 != 0);
+		CUTE_assertEquals(sa_lower_bound(big_sarray, &value), live);
+		live += values[i] != NULL;
+	}
+	for(size_t i = 0; i < n; ++i) {
+		if(!values[i]) {
+			values[i] = malloc(sizeof(int));
+			CUTE_runTimeAssert(values[i] != NULL);
+			*values[i] = (int)i;
+			CUTE_assertEquals(sa_add(big_sarray, values[i]), (ssize_t)i);
+		}
+	}
+	verbose("sa_flush(big_sarray)");
+	CUTE_assertEquals(sa_flush(big_sarray), true);
+	CUTE_assertEquals(sa_size(big_sarray), n);
+	for(size_t i = 0; i < n; ++i) {
+		CUTE_assertEquals(sa_get(big_sarray, i), values[i]);
+		free(values[i]);
+	}
+	sa_free(big_sarray);
+	verbose("OK");
+}
+
+static void test_sa_set_lazy_drop(void) {
+	static int removed[] = {7, 27, 82}, compacted[] = {1, 5, 9, 13};
+	static int six = 6, value = 27;
+	static int expected_sorted[] = {1, 5, 6, 9, 13, 27, 40, 65, 95};
+	static int expected_compact[] = {6, 27, 65, 95};
+	notice("test sa_set_lazy_drop -- marked removals, compaction");
+	verbose("sa_set_lazy_drop(sortedarray, 101)");
+	CUTE_assertEquals(sa_set_lazy_drop(sortedarray, 101), false);
+	CUTE_assertErrnoEquals(EINVAL);
+	verbose("sa_set_lazy_drop(sortedarray, 50)");
+	CUTE_assertEquals(sa_set_lazy_drop(sortedarray, 50), true);
+	for(size_t i = 0; i < 3; ++i) {
+		CUTE_assertEqualsUsing(sa_remove(sortedarray, &removed[i]),
+		                       &removed[i], cmp_as_ints, 0);
+		CUTE_assertEquals(sa_remove(sortedarray, &removed[i]), NULL);
+	}
+	CUTE_assertEquals(sa_size(sortedarray), 7);
+	/* both take the slot of a removed element */
+	CUTE_assertEquals(sa_add(sortedarray, &six), 2);
+	CUTE_assertEquals(sa_add(sortedarray, &value), 5);
+	CUTE_assertEquals(sa_size(sortedarray), 9);
+	for(size_t i = 0; i < 9; ++i) {
+		CUTE_assertEqualsUsing(sa_get(sortedarray, i), &expected_sorted[i],
+		                       cmp_as_ints, 0);
+		CUTE_assertEquals(sa_indexof(sortedarray, &expected_sorted[i]),
+		                  (ssize_t)i);
+	}
+	/* the fifth removed slot out of ten triggers the compaction */
+	for(size_t i = 0; i < 4; ++i) {
+		CUTE_assertEqualsUsing(sa_remove(sortedarray, &compacted[i]),
+		                       &compacted[i], cmp_as_ints, 0);
+	}
+	CUTE_assertEquals(sa_size(sortedarray), 5);
+	CUTE_assertEqualsUsing(sa_drop(sortedarray, 2), &VALUES[4], cmp_as_ints,
+	                       0);
+	verbose("sa_compact(sortedarray)");
+	sa_compact(sortedarray);
+	CUTE_assertEquals(sa_size(sortedarray), 4);
+	for(size_t i = 0; i < 4; ++i) {
+		CUTE_assertEqualsUsing(sa_get(sortedarray, i), &expected_compact[i],
+		                       cmp_as_ints, 0);
+	}
+	CUTE_assertEquals(sa_set_lazy_drop(sortedarray, 0), true);
+	verbose("OK");
+}
+
+static void test_sa_set_lazy_drop__free(void) {
+	int *values[200];
+	SortedArray *big_sarray;
+	const size_t n = sizeof(values) / sizeof(*values);
+	notice("test sa_set_lazy_drop -- the searches never read the elements "
+	       "removed");
+	verbose("big_sarray = sa_new(%zu, %s)", n, cmp_as_ints_repr);
+	big_sarray = sa_new(n, cmp_as_ints);
+	CUTE_assertEquals(sa_set_lazy_drop(big_sarray, 50), true);
+	for(size_t i = 0; i < n; ++i) {
+		values[i] = malloc(sizeof(int));
+		CUTE_runTimeAssert(values[i] != NULL);
+		*values[i] = (int)i;
+		CUTE_runTimeAssert(sa_add(big_sarray, values[i]) >= 0);
+	}
+	verbose("removing and freeing every third element");
+	for(size_t i = 0; i < n; i += 3) {
+		free(sa_remove(big_sarray, values[i]));
+		values[i] = NULL;
+	}
+	for(size_t i = 0, live = 0; i < n; ++i) {
+		const int value = (int)i;
+		CUTE_assertEquals(sa_indexof(big_sarray, &value) >= 0, i % 3 != 0);
+		CUTE_assertEquals(sa_lower_bound(big_sarray, &value), live);
+		live += values[i] != NULL;
+	}
+	for(size_t i = 0; i < n; ++i) {
+		if(!values[i]) {
+			values[i] = malloc(sizeof(int));
+			CUTE_runTimeAssert(values[i] != NULL);
+			*values[i] = (int)i;
+			CUTE_assertEquals(sa_add(big_sarray, values[i]), (ssize_t)i);
+		}
+	}
+	CUTE_assertEquals(sa_size(big_sarray), n);
+	for(size_t i = 0; i < n; ++i) {
+		CUTE_assertEquals(sa_get(big_sarray, i), values[i]);
+		free(values[i]);
+	}
+	sa_free(big_sarray);
+	verbose("OK");
+}
+
+static void test_sa_freeze(void) {
+	static int missing[] = {0, 6, 100};
+	int value = 50;
+	notice("test sa_freeze -- searches are unchanged by the layout");
+	verbose("sa_freeze(sortedarray)");
+	CUTE_assertEquals(sa_freeze(sortedarray), true);
+	CUTE_assertNoError();
+	for(size_t i = 0; i < INT_SORTED_ARRAY_SIZE; ++i) {
+		info("expected: %zu", i);
+		info("got     : %zd", sa_indexof(sortedarray, &VALUES_SORTED[i]));
+		CUTE_assertEquals(sa_indexof(sortedarray, &VALUES_SORTED[i]),
+		                  (ssize_t)i);
+	}
+	for(size_t i = 0; i < sizeof(missing) / sizeof(*missing); ++i) {
+		CUTE_assertEquals(sa_indexof(sortedarray, &missing[i]), -1);
+	}
+	verbose("sa_add(sortedarray, %d) -- discards the layout", value);
+	CUTE_assertEquals(sa_add(sortedarray, &value), 7);
+	CUTE_assertEquals(sa_indexof(sortedarray, &VALUES_SORTED[7]), 8);
+	CUTE_assertEquals(sa_indexof(sortedarray, &value), 7);
+	verbose("OK");
+}
+
 // TODO sa_drop, sa_remove
 
 void build_case_sortedarray(void) {
-	case_sortedarray = CUTE_newTestCase("Tests for SortedArray", 7);
+	case_sortedarray = CUTE_newTestCase("Tests for SortedArray", 21);
 	CUTE_setCaseBefore(case_sortedarray, init);
 	CUTE_setCaseAfter(case_sortedarray, cleanup);
 	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_new__0_null));
@@ -148,6 +624,22 @@ void build_case_sortedarray(void) {
 	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_size));
 	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_is_sorted__sa_get));
 	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_indexof));
+	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_indexof_many));
 	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_add__last));
 	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_add_dup));
+	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_add_many));
+	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_from_unsorted));
+	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_bounds));
+	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_foreach_range));
+	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_setops));
+	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_setops__gallop));
+	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_setops__buffer));
+	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_new_prefixed));
+	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_set_buffer));
+	CUTE_addCaseTest(case_sortedarray,
+	                 CUTE_makeTest(test_sa_set_buffer__free));
+	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_set_lazy_drop));
+	CUTE_addCaseTest(case_sortedarray,
+	                 CUTE_makeTest(test_sa_set_lazy_drop__free));
+	CUTE_addCaseTest(case_sortedarray, CUTE_makeTest(test_sa_freeze));
 }
@@ -0,0 +1,140 @@
+#include "spscqueue.h"
+
+#include <CUTE/cute.h>
+#include <clog.h> /* for logging macros */
+#include <stddef.h> /* for size_t */
+#include <stdlib.h> /* for NULL */
+
+
+
+/* The instance of test case */
+CUTE_TestCase *case_spscqueue;
+
+
+
+static SPSCQueue *queue;
+
+static const size_t SPSC_QUEUE_CAPACITY = 6;
+static const size_t SPSC_QUEUE_ACTUAL_CAPACITY = 8;
+static int VALUES[] = {4, 8, 15, 16, 23, 42, 7, 99, 12};
+
+
+static void init(void) {
+	verbose("queue = spsc_new(%zu)", SPSC_QUEUE_CAPACITY);
+	queue = spsc_new(SPSC_QUEUE_CAPACITY);
+	CUTE_assertNotEquals(queue, NULL);
+}
+
+static void cleanup(void) {
+	verbose("spsc_free(queue)");
+	spsc_free(queue);
+}
+
+
+static void test_spsc_new__0_null(void) {
+	SPSCQueue *got;
+	notice("test spsc_new -- capacity 0 => NULL queue");
+	verbose("spsc_new(0)");
+	info("expected: (nil)");
+	got = spsc_new(0);
+	info("got     : %p", (void*)got); /* necessary cast because of GCC warning */
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertErrnoEquals(EINVAL);
+	verbose("OK");
+}
+
+static void test_spsc_capacity(void) {
+	size_t got;
+	notice("test spsc_capacity -- rounded to a power of two");
+	verbose("spsc_capacity(queue)");
+	info("expected: %zu", SPSC_QUEUE_ACTUAL_CAPACITY);
+	got = spsc_capacity(queue);
+	info("got     : %zu", got);
+	CUTE_assertEquals(got, SPSC_QUEUE_ACTUAL_CAPACITY);
+	verbose("OK");
+}
+
+static void test_spsc_push__full(void) {
+	bool got;
+	notice("test spsc_push -- fill the queue, then fail");
+	for(size_t i = 0; i < SPSC_QUEUE_ACTUAL_CAPACITY; ++i) {
+		verbose("spsc_push(queue, &(%d))", VALUES[i]);
+		info("expected: true");
+		got = spsc_push(queue, &VALUES[i]);
+		info("got     : %s", got ? "true" : "false");
+		CUTE_assertEquals(got, true);
+		CUTE_assertNoError();
+	}
+	verbose("spsc_push(queue, &(%d))", VALUES[SPSC_QUEUE_ACTUAL_CAPACITY]);
+	info("expected: false");
+	got = spsc_push(queue, &VALUES[SPSC_QUEUE_ACTUAL_CAPACITY]);
+	info("got     : %s", got ? "true" : "false");
+	CUTE_assertEquals(got, false);
+	CUTE_assertErrnoEquals(EAGAIN);
+	CUTE_assertEquals(spsc_size(queue), SPSC_QUEUE_ACTUAL_CAPACITY);
+	verbose("OK");
+}
+
+static void test_spsc_pop__fifo(void) {
+	data_t *expected, *got;
+	notice("test spsc_pop -- elements come out in order, then fail");
+	for(size_t i = 0; i < 3; ++i) {
+		spsc_push(queue, &VALUES[i]);
+	}
+	for(size_t i = 0; i < 3; ++i) {
+		verbose("spsc_pop(queue)");
+		expected = &VALUES[i];
+		info("expected: %p", expected);
+		got = spsc_pop(queue);
+		info("got     : %p", got);
+		CUTE_assertEquals(got, expected);
+		CUTE_assertNoError();
+	}
+	verbose("spsc_pop(queue)");
+	info("expected: (nil)");
+	got = spsc_pop(queue);
+	info("got     : %p", got);
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertErrnoEquals(EAGAIN);
+	verbose("OK");
+}
+
+static void test_spsc_push_n_pop_n__wrap(void) {
+	data_t *in[9], *out[9];
+	size_t got;
+	notice("test spsc_push_n/spsc_pop_n -- batches wrapping around the ring");
+	for(size_t i = 0; i < 9; ++i) {
+		in[i] = &VALUES[i];
+	}
+	/* move the indices to the middle of the storage */
+	spsc_push_n(queue, in, 5);
+	spsc_pop_n(queue, out, 5);
+	verbose("spsc_push_n(queue, in, 9)");
+	info("expected: %zu", SPSC_QUEUE_ACTUAL_CAPACITY);
+	got = spsc_push_n(queue, in, 9);
+	info("got     : %zu", got);
+	CUTE_assertEquals(got, SPSC_QUEUE_ACTUAL_CAPACITY);
+	verbose("spsc_pop_n(queue, out, 9)");
+	info("expected: %zu", SPSC_QUEUE_ACTUAL_CAPACITY);
+	got = spsc_pop_n(queue, out, 9);
+	info("got     : %zu", got);
+	CUTE_assertEquals(got, SPSC_QUEUE_ACTUAL_CAPACITY);
+	for(size_t i = 0; i < SPSC_QUEUE_ACTUAL_CAPACITY; ++i) {
+		CUTE_assertEquals(out[i], in[i]);
+	}
+	CUTE_assertEquals(spsc_size(queue), 0);
+	verbose("OK");
+}
+
+
+void build_case_spscqueue(void) {
+	case_spscqueue = CUTE_newTestCase("Tests for SPSCQueue", 5);
+	CUTE_setCaseBefore(case_spscqueue, init);
+	CUTE_setCaseAfter(case_spscqueue, cleanup);
+	CUTE_addCaseTest(case_spscqueue, CUTE_makeTest(test_spsc_new__0_null));
+	CUTE_addCaseTest(case_spscqueue, CUTE_makeTest(test_spsc_capacity));
+	CUTE_addCaseTest(case_spscqueue, CUTE_makeTest(test_spsc_push__full));
+	CUTE_addCaseTest(case_spscqueue, CUTE_makeTest(test_spsc_pop__fifo));
+	CUTE_addCaseTest(case_spscqueue,
+	                 CUTE_makeTest(test_spsc_push_n_pop_n__wrap));
+}
@@ -0,0 +1,113 @@
+#include "stringmap.h"
+
+#include <CUTE/cute.h>
+#include <clog.h> /* for logging macros */
+#include <stdio.h> /* for snprintf() */
+
+
+
+/* The instance of test case */
+CUTE_TestCase *case_stringmap;
+
+
+
+static StringPool *pool;
+static StringMap *map;
+
+static const size_t MAP_SIZE = 4;
+static const char *const KEYS[] = {"alpha", "beta", "gamma", "delta", "epsilon"};
+static int VALUES[] = {0, 1, 2, 3, 4};
+
+
+static void init(void) {
+	verbose("pool = sp_new(%zu)", MAP_SIZE);
+	pool = sp_new(MAP_SIZE);
+	CUTE_assertNotEquals(pool, NULL);
+	verbose("map = sm_new(%zu, pool)", MAP_SIZE);
+	map = sm_new(MAP_SIZE, pool);
+	CUTE_assertNotEquals(map, NULL);
+	for(size_t i = 0; i < MAP_SIZE; ++i) {
+		CUTE_runTimeAssert(sm_put(map, KEYS[i], &VALUES[i]));
+	}
+}
+
+static void cleanup(void) {
+	verbose("sm_free(map)");
+	sm_free(map);
+	verbose("sp_free(pool)");
+	sp_free(pool);
+}
+
+
+static void test_sm_new__0_null(void) {
+	StringMap *got;
+	notice("test sm_new -- size 0 => NULL map");
+	verbose("sm_new(0, pool)");
+	info("expected: (nil)");
+	got = sm_new(0, pool);
+	info("got     : %p", (void*)got); /* necessary cast because of GCC warning */
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertErrnoEquals(EINVAL);
+	verbose("OK");
+}
+
+static void test_sm_get(void) {
+	char buffer[] = "gamma";
+	notice("test sm_get -- a key is found from any copy of it");
+	CUTE_assertEquals(sm_size(map), MAP_SIZE);
+	CUTE_assertEquals(sp_size(sm_pool(map)), MAP_SIZE);
+	verbose("sm_get(map, \"%s\")", buffer);
+	CUTE_assertEquals(sm_get(map, buffer), &VALUES[2]);
+	CUTE_assertEquals(sm_get_interned(map, sp_find(pool, buffer)), &VALUES[2]);
+	buffer[0] = 'G';
+	CUTE_assertEquals(sm_get(map, buffer), NULL);
+	CUTE_assertEquals(sm_contains(map, KEYS[4]), false);
+	CUTE_assertEquals(sm_getd(map, KEYS[4], &VALUES[0]), &VALUES[0]);
+	/* interned, but not a key of the map */
+	CUTE_assertEquals(sm_get_interned(map, sp_intern(pool, KEYS[4])), NULL);
+	verbose("OK");
+}
+
+static void test_sm_put__override(void) {
+	notice("test sm_put -- a present key has its value replaced");
+	verbose("sm_put(map, \"%s\", &(%d))", KEYS[1], VALUES[4]);
+	CUTE_assertEquals(sm_put(map, KEYS[1], &VALUES[4]), true);
+	CUTE_assertNoError();
+	CUTE_assertEquals(sm_size(map), MAP_SIZE);
+	CUTE_assertEquals(sm_get(map, KEYS[1]), &VALUES[4]);
+	verbose("OK");
+}
+
+static void test_sm_remove(void) {
+	char buffer[16];
+	notice("test sm_remove -- the other keys are still found after removals");
+	for(int i = 0; i < 100; ++i) {
+		snprintf(buffer, sizeof(buffer), "key %d", i);
+		CUTE_runTimeAssert(sm_put(map, buffer, &VALUES[i % 5]));
+	}
+	for(int i = 0; i < 100; i += 2) {
+		snprintf(buffer, sizeof(buffer), "key %d", i);
+		CUTE_assertEquals(sm_remove(map, buffer), &VALUES[i % 5]);
+	}
+	verbose("sm_remove(map, \"%s\")", KEYS[0]);
+	CUTE_assertEquals(sm_remove(map, KEYS[0]), &VALUES[0]);
+	CUTE_assertEquals(sm_remove(map, KEYS[0]), NULL);
+	CUTE_assertEquals(sm_size(map), MAP_SIZE - 1 + 50);
+	for(int i = 0; i < 100; ++i) {
+		snprintf(buffer, sizeof(buffer), "key %d", i);
+		CUTE_assertEquals(sm_get(map, buffer), i % 2 ? &VALUES[i % 5] : NULL);
+	}
+	CUTE_assertEquals(sm_get(map, KEYS[3]), &VALUES[3]);
+	verbose("OK");
+}
+
+
+void build_case_stringmap(void) {
+	case_stringmap = CUTE_newTestCase("Tests for StringMap", 4);
+	CUTE_setCaseBefore(case_stringmap, init);
+	CUTE_setCaseAfter(case_stringmap, cleanup);
+	CUTE_addCaseTest(case_stringmap, CUTE_makeTest(test_sm_new__0_null));
+	CUTE_addCaseTest(case_stringmap, CUTE_makeTest(test_sm_get));
+	CUTE_addCaseTest(case_stringmap, CUTE_makeTest(test_sm_put__override));
+	CUTE_addCaseTest(case_stringmap, CUTE_makeTest(test_sm_remove));
+}
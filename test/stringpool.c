@@ -0,0 +1,98 @@
+#include "stringpool.h"
+
+#include <CUTE/cute.h>
+#include <clog.h> /* for logging macros */
+#include <stdio.h> /* for snprintf() */
+#include <string.h> /* for strcmp() */
+
+
+
+/* The instance of test case */
+CUTE_TestCase *case_stringpool;
+
+
+
+static StringPool *pool;
+
+static const size_t POOL_SIZE = 4;
+
+
+static void init(void) {
+	verbose("pool = sp_new(%zu)", POOL_SIZE);
+	pool = sp_new(POOL_SIZE);
+	CUTE_assertNotEquals(pool, NULL);
+}
+
+static void cleanup(void) {
+	verbose("sp_free(pool)");
+	sp_free(pool);
+}
+
+
+static void test_sp_new__0_null(void) {
+	StringPool *got;
+	notice("test sp_new -- size 0 => NULL pool");
+	verbose("sp_new(0)");
+	info("expected: (nil)");
+	got = sp_new(0);
+	info("got     : %p", (void*)got); /* necessary cast because of GCC warning */
+	CUTE_assertEquals(got, NULL);
+	CUTE_assertErrnoEquals(EINVAL);
+	verbose("OK");
+}
+
+static void test_sp_intern(void) {
+	char buffer[] = "interned";
+	const char *first, *second;
+	notice("test sp_intern -- equal strings are interned at the same address");
+	verbose("sp_intern(pool, \"%s\")", buffer);
+	first = sp_intern(pool, buffer);
+	CUTE_assertNotEquals(first, NULL);
+	CUTE_assertNotEquals(first, buffer);
+	CUTE_runTimeAssert(strcmp(first, buffer) == 0);
+	/* the pool holds a copy of the string */
+	buffer[0] = 'I';
+	second = sp_intern(pool, buffer);
+	CUTE_assertNotEquals(second, first);
+	buffer[0] = 'i';
+	CUTE_assertEquals(sp_intern(pool, buffer), first);
+	CUTE_assertEquals(sp_intern_n(pool, "interned and more", 8), first);
+	CUTE_assertEquals(sp_size(pool), 2);
+	CUTE_assertEquals(sp_length(first), 8);
+	CUTE_assertEquals(sp_hash(first), sp_hash_bytes(buffer, 8));
+	verbose("sp_find(pool, \"intern\")");
+	CUTE_assertEquals(sp_find(pool, "intern"), NULL);
+	CUTE_assertEquals(sp_find(pool, "Interned"), second);
+	verbose("OK");
+}
+
+static void test_sp_intern__grow(void) {
+	static const size_t COUNT = 1000;
+	const char *interned[1000];
+	char buffer[16];
+	notice("test sp_intern -- the interned strings stay in place as the pool "
+	       "grows");
+	for(size_t i = 0; i < COUNT; ++i) {
+		snprintf(buffer, sizeof(buffer), "key %zu", i);
+		interned[i] = sp_intern(pool, buffer);
+		CUTE_assertNotEquals(interned[i], NULL);
+	}
+	verbose("sp_intern(pool, \"key i\") for i < %zu", COUNT);
+	CUTE_assertEquals(sp_size(pool), COUNT);
+	for(size_t i = 0; i < COUNT; ++i) {
+		snprintf(buffer, sizeof(buffer), "key %zu", i);
+		CUTE_assertEquals(sp_find(pool, buffer), interned[i]);
+		CUTE_runTimeAssert(strcmp(interned[i], buffer) == 0);
+	}
+	verbose("OK");
+}
+
+
+void build_case_stringpool(void) {
+	case_stringpool = CUTE_newTestCase("Tests for StringPool", 3);
+	CUTE_setCaseBefore(case_stringpool, init);
+	CUTE_setCaseAfter(case_stringpool, cleanup);
+	CUTE_addCaseTest(case_stringpool, CUTE_makeTest(test_sp_new__0_null));
+	CUTE_addCaseTest(case_stringpool, CUTE_makeTest(test_sp_intern));
+	CUTE_addCaseTest(case_stringpool, CUTE_makeTest(test_sp_intern__grow));
+}